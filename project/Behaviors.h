@@ -15,10 +15,18 @@
 #include "EliteBehaviorTree/EBehaviorTree.h"
 #include "Steeringbehaviors/SteeringBehaviors.h"
 #include "EliteData/EBlackboard.h"
+#include "BlackboardKeys.h"
+#include "EliteLogging/ELogger.h"
 
 #include "Grid.h"
 #include "HouseManager.h"
 #include "InventoryManager.h"
+#include "NavMeshQueryCache.h"
+
+namespace BT_Conditions
+{
+    bool HasReachedTarget(Elite::Blackboard* pBlackboard);
+}
 
 
 
@@ -26,27 +34,15 @@
 // Helper Functions
 // ----------------------------------------------------------------
 
-template<typename T>
-bool GetDataFromBlackboard(Elite::Blackboard* pBlackboard, const std::string& dataName, T*& outputData)
-{
-    if (!pBlackboard->GetData(dataName, outputData))
-    {
-        std::cerr << dataName << " isn't stored correctly in Blackboard\n";
-        return false;
-    }
-    return true;
-}
-bool SetCurrentSteeringBehavior(Elite::Blackboard* pBlackboard, ISteeringBehavior* pNewBehavior, const std::string& behaviorName)
+bool SetCurrentSteeringBehavior(Elite::Blackboard* pBlackboard, ISteeringBehavior* pNewBehavior, const char* behaviorName)
 {
-    ISteeringBehavior* pCurrentSteeringBehavior{};
-    if (!GetDataFromBlackboard(pBlackboard, "CurrentSteeringBehavior", pCurrentSteeringBehavior))
-        return false;
+    ISteeringBehavior* pCurrentSteeringBehavior = pBlackboard->GetData(BB::CurrentSteeringBehavior);
 
     if (pCurrentSteeringBehavior != pNewBehavior)
     {
-        std::cout << "SteeringBehavior changed to " << behaviorName << ". \n";
+        ELITE_LOG_DEBUG("SteeringBehavior changed to %s.", behaviorName);
         pCurrentSteeringBehavior = pNewBehavior;
-        pBlackboard->ChangeData("CurrentSteeringBehavior", pCurrentSteeringBehavior);
+        pBlackboard->ChangeData(BB::CurrentSteeringBehavior, pCurrentSteeringBehavior);
     }
     return true;
 }
@@ -60,30 +56,21 @@ namespace BT_Actions
     // Steering Actions
     Elite::BehaviorState SetRunning(Elite::Blackboard* pBlackboard)
     {
-        bool* pShouldRun{};
-        if (!GetDataFromBlackboard(pBlackboard, "ShouldRun", pShouldRun))
-            return Elite::BehaviorState::Failure;
+        bool* pShouldRun = pBlackboard->GetData(BB::ShouldRun);
 
         *pShouldRun = true;
+        pBlackboard->NotifyChanged(BB::ShouldRun);
         return Elite::BehaviorState::Success;
     }
 
     Elite::BehaviorState SeekTarget(Elite::Blackboard* pBlackboard)
     {
-        IExamInterface* pInterface{};
-        if (!GetDataFromBlackboard(pBlackboard, "Interface", pInterface))
-            return Elite::BehaviorState::Failure;
-
-        Elite::Vector2* pTarget{};
-        if (!GetDataFromBlackboard(pBlackboard, "Target", pTarget))
-            return Elite::BehaviorState::Failure;
-
-        Seek* pSeek{};
-        if (!GetDataFromBlackboard(pBlackboard, "Seek", pSeek))
-            return Elite::BehaviorState::Failure;
+        ZombieGame::NavMeshQueryCache* pNavMeshCache = pBlackboard->GetData(BB::NavMeshCache);
+        Elite::Vector2* pTarget = pBlackboard->GetData(BB::Target);
+        Seek* pSeek = pBlackboard->GetData(BB::Seek);
 
         // set target to closest point in navmesh
-        pSeek->SetTarget(pInterface->NavMesh_GetClosestPathPoint(*pTarget));
+        pSeek->SetTarget(pNavMeshCache->GetClosestPathPoint(*pTarget));
 
         //change behavior if necessary
         if (!SetCurrentSteeringBehavior(pBlackboard, pSeek, "Seek"))
@@ -91,31 +78,29 @@ namespace BT_Actions
 
         return Elite::BehaviorState::Success;
     }   
-    Elite::BehaviorState SeekAndFaceTarget(Elite::Blackboard* pBlackboard)
+    // Keeps seeking the target and stays Running until it is reached, so memory composites resume here
+    Elite::BehaviorState MoveToTarget(Elite::Blackboard* pBlackboard)
     {
-        IExamInterface* pInterface{};
-        if (!GetDataFromBlackboard(pBlackboard, "Interface", pInterface))
+        if (SeekTarget(pBlackboard) == Elite::BehaviorState::Failure)
             return Elite::BehaviorState::Failure;
 
-        Elite::Vector2* pTarget{};
-        if (!GetDataFromBlackboard(pBlackboard, "Target", pTarget))
-            return Elite::BehaviorState::Failure;
-
-        Seek* pSeek{};
-        if (!GetDataFromBlackboard(pBlackboard, "Seek", pSeek))
-            return Elite::BehaviorState::Failure;
+        if (!BT_Conditions::HasReachedTarget(pBlackboard))
+            return Elite::BehaviorState::Running;
 
-        Face* pFace{};
-        if (!GetDataFromBlackboard(pBlackboard, "Face", pFace))
-            return Elite::BehaviorState::Failure;
-
-        BlendedSteering* pSeekAndFace{};
-        if (!GetDataFromBlackboard(pBlackboard, "SeekAndFace", pSeekAndFace))
-            return Elite::BehaviorState::Failure;
+        return Elite::BehaviorState::Success;
+    }
+    Elite::BehaviorState SeekAndFaceTarget(Elite::Blackboard* pBlackboard)
+    {
+        ZombieGame::NavMeshQueryCache* pNavMeshCache = pBlackboard->GetData(BB::NavMeshCache);
+        Elite::Vector2* pTarget = pBlackboard->GetData(BB::Target);
+        Seek* pSeek = pBlackboard->GetData(BB::Seek);
+        Face* pFace = pBlackboard->GetData(BB::Face);
+        BlendedSteering* pSeekAndFace = pBlackboard->GetData(BB::SeekAndFace);
 
         // set target to closest point in navmesh
-        pSeek->SetTarget(pInterface->NavMesh_GetClosestPathPoint(*pTarget));
-        pFace->SetTarget(pInterface->NavMesh_GetClosestPathPoint(*pTarget));
+        const Elite::Vector2 pathPoint = pNavMeshCache->GetClosestPathPoint(*pTarget);
+        pSeek->SetTarget(pathPoint);
+        pFace->SetTarget(pathPoint);
 
         //change behavior if necessary
         if (!SetCurrentSteeringBehavior(pBlackboard, pSeekAndFace, "SeekAndFace"))
@@ -125,29 +110,16 @@ namespace BT_Actions
     }
     Elite::BehaviorState FleeAndFaceTarget(Elite::Blackboard* pBlackboard)
     {
-        IExamInterface* pInterface{};
-        if (!GetDataFromBlackboard(pBlackboard, "Interface", pInterface))
-            return Elite::BehaviorState::Failure;
-
-        Flee* pFlee{};
-        if (!GetDataFromBlackboard(pBlackboard, "Flee", pFlee))
-            return Elite::BehaviorState::Failure;
-
-        Face* pFace{};
-        if (!GetDataFromBlackboard(pBlackboard, "Face", pFace))
-            return Elite::BehaviorState::Failure;
-
-        BlendedSteering* pFleeAndFace{};
-        if (!GetDataFromBlackboard(pBlackboard, "FleeAndFace", pFleeAndFace))
-            return Elite::BehaviorState::Failure;
-
-        Elite::Vector2* pTarget{};
-        if (!GetDataFromBlackboard(pBlackboard, "Target", pTarget))
-            return Elite::BehaviorState::Failure;
+        ZombieGame::NavMeshQueryCache* pNavMeshCache = pBlackboard->GetData(BB::NavMeshCache);
+        Flee* pFlee = pBlackboard->GetData(BB::Flee);
+        Face* pFace = pBlackboard->GetData(BB::Face);
+        BlendedSteering* pFleeAndFace = pBlackboard->GetData(BB::FleeAndFace);
+        Elite::Vector2* pTarget = pBlackboard->GetData(BB::Target);
 
         // set target to closest point in navmesh
-        pFace->SetTarget(pInterface->NavMesh_GetClosestPathPoint(*pTarget));
-        pFlee->SetTarget(pInterface->NavMesh_GetClosestPathPoint(*pTarget));
+        const Elite::Vector2 pathPoint = pNavMeshCache->GetClosestPathPoint(*pTarget);
+        pFace->SetTarget(pathPoint);
+        pFlee->SetTarget(pathPoint);
 
         //change behavior if necessary
         if (!SetCurrentSteeringBehavior(pBlackboard, pFleeAndFace, "FleeAndFace"))
@@ -157,20 +129,12 @@ namespace BT_Actions
     }
     Elite::BehaviorState FaceTarget(Elite::Blackboard* pBlackboard)
     {
-        IExamInterface* pInterface{};
-        if (!GetDataFromBlackboard(pBlackboard, "Interface", pInterface))
-            return Elite::BehaviorState::Failure;
-
-        Face* pFace{};
-        if (!GetDataFromBlackboard(pBlackboard, "Face", pFace))
-            return Elite::BehaviorState::Failure;
-
-        Elite::Vector2* pTarget{};
-        if (!GetDataFromBlackboard(pBlackboard, "Target", pTarget))
-            return Elite::BehaviorState::Failure;
+        ZombieGame::NavMeshQueryCache* pNavMeshCache = pBlackboard->GetData(BB::NavMeshCache);
+        Face* pFace = pBlackboard->GetData(BB::Face);
+        Elite::Vector2* pTarget = pBlackboard->GetData(BB::Target);
 
         // set target to closest point in navmesh
-        pFace->SetTarget(pInterface->NavMesh_GetClosestPathPoint(*pTarget));
+        pFace->SetTarget(pNavMeshCache->GetClosestPathPoint(*pTarget));
 
         //change behavior if necessary
         if (!SetCurrentSteeringBehavior(pBlackboard, pFace, "Face"))
@@ -183,30 +147,20 @@ namespace BT_Actions
 
     Elite::BehaviorState Explore(Elite::Blackboard* pBlackboard)
     {
-        ZombieGame::Grid* pGrid{};
-        if (!GetDataFromBlackboard(pBlackboard, "Grid", pGrid))
-            return Elite::BehaviorState::Failure;
-
-        AgentInfo* pAgentInfo{};
-        if (!GetDataFromBlackboard(pBlackboard, "AgentInfo", pAgentInfo))
-            return Elite::BehaviorState::Failure;
+        ZombieGame::Grid* pGrid = pBlackboard->GetData(BB::Grid);
+        AgentInfo* pAgentInfo = pBlackboard->GetData(BB::AgentInfo);
 
-        // Get next cell of current Direction Leg
-        Cell* bestTargetCell = pGrid->GetExpandSquareSearchCell(pAgentInfo);
-        if (bestTargetCell == nullptr)
+        // Get the unvisited cell to explore, it can be several cells away
+        const Cell bestTargetCell = pGrid->GetExplorationCell(pAgentInfo);
+        if (!bestTargetCell.IsValid())
             return Elite::BehaviorState::Failure;
 
-        Elite::Vector2* pTarget{};
-        if (!GetDataFromBlackboard(pBlackboard, "Target", pTarget))
-            return Elite::BehaviorState::Failure;
-
-        SteeringPlugin_Output_Extended* pSteering;
-        if (!GetDataFromBlackboard(pBlackboard, "CurrentSteering", pSteering))
-            return Elite::BehaviorState::Failure;
+        Elite::Vector2* pTarget = pBlackboard->GetData(BB::Target);
 
-        // set center next cell as target
-        *pTarget = bestTargetCell->Position;
-        pBlackboard->ChangeData("TargetHouse", static_cast<House*>(nullptr));
+        // set center of the next cell on the path there as target, the path goes around danger
+        *pTarget = pGrid->GetNextPathCell(bestTargetCell.Index).Position;
+        pBlackboard->NotifyChanged(BB::Target);
+        pBlackboard->ChangeData(BB::TargetHouse, nullptr);
 
         return Elite::BehaviorState::Success;
     }
@@ -214,157 +168,115 @@ namespace BT_Actions
     // House Actions
     Elite::BehaviorState TargetHouseInFOV(Elite::Blackboard* pBlackboard)
     {
-        IExamInterface* pInterface{};
-        if (!GetDataFromBlackboard(pBlackboard, "Interface", pInterface))
-            return Elite::BehaviorState::Failure;
-
-        ZombieGame::HouseManager* pHouseManager{};
-        if (!GetDataFromBlackboard(pBlackboard, "HouseManager", pHouseManager))
-            return Elite::BehaviorState::Failure;
+        const ZombieGame::PerceptionFrame* pPerception = pBlackboard->GetData(BB::Perception);
+        ZombieGame::HouseManager* pHouseManager = pBlackboard->GetData(BB::HouseManager);
+        Elite::Vector2* pTarget = pBlackboard->GetData(BB::Target);
 
-        Elite::Vector2* pTarget{};
-        if (!GetDataFromBlackboard(pBlackboard, "Target", pTarget))
-            return Elite::BehaviorState::Failure;
-
-        House* pTargetHouse{};
-        if (!GetDataFromBlackboard(pBlackboard, "TargetHouse", pTargetHouse) || pTargetHouse == nullptr)
+        House* pTargetHouse = pBlackboard->GetData(BB::TargetHouse);
+        if (pTargetHouse == nullptr)
         {
             // check houses in FOV
-            for (const auto& houseFOV : pInterface->GetHousesInFOV())
+            for (const auto& houseFOV : pPerception->GetHouses())
             {
                 if (!pHouseManager->GetHouse(houseFOV)->IsVisited)
                 {
                     // set house as target
-                    std::cout << "New House as target \n";
+                    ELITE_LOG_INFO("New House as target");
                     pTargetHouse = pHouseManager->GetHouse(houseFOV);
-                    pBlackboard->ChangeData("TargetHouse", pTargetHouse);
+                    pBlackboard->ChangeData(BB::TargetHouse, pTargetHouse);
 
                     // set house as next position target 
                     *pTarget = pTargetHouse->Center;
+                    pBlackboard->NotifyChanged(BB::Target);
                     return Elite::BehaviorState::Success;
                 }
             }
         }
 
-        std::cout << "There is already a target house, TargetHouseInFOV returned failure! \n";
+        ELITE_LOG_DEBUG("There is already a target house, TargetHouseInFOV returned failure!");
         return Elite::BehaviorState::Failure;
     }
     Elite::BehaviorState TargetClosestUnvisitedHouse(Elite::Blackboard* pBlackboard)
     {
-        std::cout << "TargetClosestUnvisitedHouse called \n";
+        ELITE_LOG_DEBUG("TargetClosestUnvisitedHouse called");
 
-        ZombieGame::Grid* pGrid{};
-        if (!GetDataFromBlackboard(pBlackboard, "Grid", pGrid))
-            return Elite::BehaviorState::Failure;
+        ZombieGame::Grid* pGrid = pBlackboard->GetData(BB::Grid);
 
         pGrid->StoreLastVisitedCell();
+        pBlackboard->NotifyChanged(BB::Grid);
 
-        AgentInfo* pAgentInfo{};
-        if (!GetDataFromBlackboard(pBlackboard, "AgentInfo", pAgentInfo))
-            return Elite::BehaviorState::Failure;
-
-        ZombieGame::HouseManager* pHouseManager{};
-        if (!GetDataFromBlackboard(pBlackboard, "HouseManager", pHouseManager))
-            return Elite::BehaviorState::Failure;
+        AgentInfo* pAgentInfo = pBlackboard->GetData(BB::AgentInfo);
+        ZombieGame::HouseManager* pHouseManager = pBlackboard->GetData(BB::HouseManager);
 
         // Get closest unvited house
         House* pClosestHouse = pHouseManager->GetClosestUnvisitedHouse(pAgentInfo->Position);
         if (pClosestHouse == nullptr)
             return Elite::BehaviorState::Failure;
 
-        Elite::Vector2* pTarget{};
-        if (!GetDataFromBlackboard(pBlackboard, "Target", pTarget))
-            return Elite::BehaviorState::Failure;
+        Elite::Vector2* pTarget = pBlackboard->GetData(BB::Target);
 
-        House* pTargetHouse{};
+        House* pTargetHouse = pBlackboard->GetData(BB::TargetHouse);
 
         //only when there isn't already a target house
-        if (GetDataFromBlackboard(pBlackboard, "TargetHouse", pTargetHouse) && pTargetHouse == nullptr)
+        if (pTargetHouse == nullptr)
         {
             *pTarget = pClosestHouse->Center;
-            pBlackboard->ChangeData("TargetHouse", pClosestHouse);
+            pBlackboard->NotifyChanged(BB::Target);
+            pBlackboard->ChangeData(BB::TargetHouse, pClosestHouse);
             return Elite::BehaviorState::Success;
         }
 
-        std::cout << "There is already a target house, TargetClosestUnvisitedHouse returned failure! \n";
+        ELITE_LOG_DEBUG("There is already a target house, TargetClosestUnvisitedHouse returned failure!");
         return Elite::BehaviorState::Failure;
     }
     Elite::BehaviorState MarkHouseAsVisited(Elite::Blackboard* pBlackboard)
     {
-        ZombieGame::HouseManager* pHouseManager{};
-        if (!GetDataFromBlackboard(pBlackboard, "HouseManager", pHouseManager))
-            return Elite::BehaviorState::Failure;
-
-        ZombieGame::Grid* pGrid{};
-        if (!GetDataFromBlackboard(pBlackboard, "Grid", pGrid))
-            return Elite::BehaviorState::Failure;
-
-        House* pHouse{};
-        if (!GetDataFromBlackboard(pBlackboard, "TargetHouse", pHouse))
-            return Elite::BehaviorState::Failure;
+        ZombieGame::HouseManager* pHouseManager = pBlackboard->GetData(BB::HouseManager);
+        ZombieGame::Grid* pGrid = pBlackboard->GetData(BB::Grid);
+        House* pHouse = pBlackboard->GetData(BB::TargetHouse);
 
         // Mark house as visited
-        std::cout << "House marked as visited... \n";
+        ELITE_LOG_INFO("House marked as visited...");
         pHouseManager->MarkHouseAsVisited(pHouse);
         // Mark cell of the house as visited
         pGrid->MarkCellVisited(pHouse->Center);
+        pBlackboard->NotifyChanged(BB::HouseManager);
+        pBlackboard->NotifyChanged(BB::Grid);
         // Remove house as target
-        pBlackboard->ChangeData("TargetHouse", static_cast<House*>(nullptr));
+        pBlackboard->ChangeData(BB::TargetHouse, nullptr);
 
         return Elite::BehaviorState::Success;
     }
     Elite::BehaviorState TargetClosestCheckpoint(Elite::Blackboard* pBlackboard)
     {
-        IExamInterface* pInterface{};
-        if (!GetDataFromBlackboard(pBlackboard, "Interface", pInterface))
-            return Elite::BehaviorState::Failure;
-
-        AgentInfo* pAgentInfo{};
-        if (!GetDataFromBlackboard(pBlackboard, "AgentInfo", pAgentInfo))
-            return Elite::BehaviorState::Failure;
-
-        ZombieGame::HouseManager* pHouseManager{};
-        if (!GetDataFromBlackboard(pBlackboard, "HouseManager", pHouseManager))
-            return Elite::BehaviorState::Failure;
-
-        House* pHouse{};
-        if (!GetDataFromBlackboard(pBlackboard, "TargetHouse", pHouse))
-            return Elite::BehaviorState::Failure;
-
-        Elite::Vector2* pTarget{};
-        if (!GetDataFromBlackboard(pBlackboard, "Target", pTarget))
-            return Elite::BehaviorState::Failure;
-
-        CheckPoint* pCheckpoint{};
-        if (!GetDataFromBlackboard(pBlackboard, "TargetCheckpoint", pCheckpoint))
-            return Elite::BehaviorState::Failure;
+        AgentInfo* pAgentInfo = pBlackboard->GetData(BB::AgentInfo);
+        ZombieGame::HouseManager* pHouseManager = pBlackboard->GetData(BB::HouseManager);
+        House* pHouse = pBlackboard->GetData(BB::TargetHouse);
+        Elite::Vector2* pTarget = pBlackboard->GetData(BB::Target);
+        CheckPoint* pCheckpoint = pBlackboard->GetData(BB::TargetCheckpoint);
 
         // Only target next checkpoint if there isn't alreadya checkpoint
         if (pCheckpoint == nullptr)
         {
-            std::cout << "New checkpoint as target\n";
+            ELITE_LOG_DEBUG("New checkpoint as target");
 
             // Get next checkpoint
             pCheckpoint = pHouseManager->GetNextCheckpoint(pAgentInfo->Position, pHouse);
 
             // set next checkpoint as target
-            pBlackboard->ChangeData("TargetCheckpoint", pCheckpoint);
+            pBlackboard->ChangeData(BB::TargetCheckpoint, pCheckpoint);
             *pTarget = pCheckpoint->Position;
+            pBlackboard->NotifyChanged(BB::Target);
         }
 
-        std::cout << "There was already a checkpoint as target\n";
+        ELITE_LOG_DEBUG("There was already a checkpoint as target");
 
         return Elite::BehaviorState::Success;
     }
     Elite::BehaviorState MarkCheckPointVisited(Elite::Blackboard* pBlackboard)
     {
-        CheckPoint* pCheckpoint{};
-        if (!GetDataFromBlackboard(pBlackboard, "TargetCheckpoint", pCheckpoint))
-            return Elite::BehaviorState::Failure;
-
-        House* pHouse{};
-        if (!GetDataFromBlackboard(pBlackboard, "TargetHouse", pHouse))
-            return Elite::BehaviorState::Failure;
+        CheckPoint* pCheckpoint = pBlackboard->GetData(BB::TargetCheckpoint);
+        House* pHouse = pBlackboard->GetData(BB::TargetHouse);
 
         auto finder = [&](CheckPoint* pCheckPoint) { return pCheckPoint == pCheckpoint; };
         auto iterator = std::find_if(pHouse->pCheckPoints.begin(), pHouse->pCheckPoints.end(), finder);
@@ -373,7 +285,8 @@ namespace BT_Actions
             return Elite::BehaviorState::Failure;
 
         (*iterator)->IsVisited = true;
-        pBlackboard->ChangeData("TargetCheckpoint", static_cast<CheckPoint*>(nullptr));
+        pBlackboard->NotifyChanged(BB::TargetHouse);
+        pBlackboard->ChangeData(BB::TargetCheckpoint, nullptr);
 
         return Elite::BehaviorState::Success;
     }
@@ -382,45 +295,38 @@ namespace BT_Actions
 
     Elite::BehaviorState TargetItemInFOV(Elite::Blackboard* pBlackboard)
     {
-        IExamInterface* pInterface{};
-        if (!GetDataFromBlackboard(pBlackboard, "Interface", pInterface))
-            return Elite::BehaviorState::Failure;
-
-        ZombieGame::InventoryManager* pInventoryManager{};
-        if (!GetDataFromBlackboard(pBlackboard, "InventoryManager", pInventoryManager))
-            return Elite::BehaviorState::Failure;
-
-        Elite::Vector2* pTarget{};
-        if (!GetDataFromBlackboard(pBlackboard, "Target", pTarget))
-            return Elite::BehaviorState::Failure;
-
-        bool* pCanScan{};
-        if (!GetDataFromBlackboard(pBlackboard, "CanScan", pCanScan))
-            return Elite::BehaviorState::Failure;
+        const ZombieGame::PerceptionFrame* pPerception = pBlackboard->GetData(BB::Perception);
+        ZombieGame::InventoryManager* pInventoryManager = pBlackboard->GetData(BB::InventoryManager);
+        Elite::Vector2* pTarget = pBlackboard->GetData(BB::Target);
+        bool* pCanScan = pBlackboard->GetData(BB::CanScan);
 
-        Item* pTargetItem{};
-        if (!GetDataFromBlackboard(pBlackboard, "TargetItem", pTargetItem) || pTargetItem != nullptr)
-            std::cout << "There is already a target item.\n";
+        Item* pTargetItem = pBlackboard->GetData(BB::TargetItem);
+        if (pTargetItem != nullptr)
+        {
+            ELITE_LOG_DEBUG("There is already a target item.");
             return Elite::BehaviorState::Failure;
+        }
 
-        for (const auto& itemFOV : pInterface->GetItemsInFOV())
+        for (const auto& itemFOV : pPerception->GetItems())
         {
             // return first item in FOV
             if (!pInventoryManager->GetStoredItem(itemFOV)->IsVisited)
             {
                 // Set item as Target
-                std::cout << "New item set as target\n";
+                ELITE_LOG_INFO("New item set as target");
                 pTargetItem = pInventoryManager->GetStoredItem(itemFOV);
-                pBlackboard->ChangeData("TargetItem", pTargetItem);
+                pBlackboard->ChangeData(BB::TargetItem, pTargetItem);
 
                 // disable scanning so the itemisin fov
                 *pCanScan = false;
+                pBlackboard->NotifyChanged(BB::CanScan);
 
                 // Removes checkpoint as target
-                pBlackboard->ChangeData("TargetCheckpoint", static_cast<CheckPoint*>(nullptr));
+                pBlackboard->ChangeData(BB::TargetCheckpoint, nullptr);
 
                 //Set items location as target goal
                 *pTarget = pTargetItem->itemInfo.Location;
+                pBlackboard->NotifyChanged(BB::Target);
                 return Elite::BehaviorState::Success;
             }
         }
@@ -429,58 +335,41 @@ namespace BT_Actions
     }
     Elite::BehaviorState SetClosestItemAsTarget(Elite::Blackboard* pBlackboard)
     {
-        ZombieGame::Grid* pGrid{};
-        if (!GetDataFromBlackboard(pBlackboard, "Grid", pGrid))
-            return Elite::BehaviorState::Failure;
+        ZombieGame::Grid* pGrid = pBlackboard->GetData(BB::Grid);
 
         // store last visited cell so it can continue exploring from that position
         pGrid->StoreLastVisitedCell();
+        pBlackboard->NotifyChanged(BB::Grid);
 
-        AgentInfo* pAgentInfo{};
-        if (!GetDataFromBlackboard(pBlackboard, "AgentInfo", pAgentInfo))
-            return Elite::BehaviorState::Failure;
-
-        ZombieGame::InventoryManager* pInventoryManager{};
-        if (!GetDataFromBlackboard(pBlackboard, "InventoryManager", pInventoryManager))
-            return Elite::BehaviorState::Failure;
+        AgentInfo* pAgentInfo = pBlackboard->GetData(BB::AgentInfo);
+        ZombieGame::InventoryManager* pInventoryManager = pBlackboard->GetData(BB::InventoryManager);
 
         Item* pClosestItem = pInventoryManager->GetClosestUnvisitedItem(pAgentInfo->Position);
         if (pClosestItem == nullptr)
             return Elite::BehaviorState::Failure;
 
-        Elite::Vector2* pTarget{};
-        if (!GetDataFromBlackboard(pBlackboard, "Target", pTarget))
-            return Elite::BehaviorState::Failure;
-
-        bool* pCanScan{};
-        if (!GetDataFromBlackboard(pBlackboard, "CanScan", pCanScan))
-            return Elite::BehaviorState::Failure;
+        Elite::Vector2* pTarget = pBlackboard->GetData(BB::Target);
+        bool* pCanScan = pBlackboard->GetData(BB::CanScan);
 
         // Set closest item as new item target
-        std::cout << "New closest item set as target\n";
-        pBlackboard->ChangeData("TargetItem", pClosestItem);
+        ELITE_LOG_INFO("New closest item set as target");
+        pBlackboard->ChangeData(BB::TargetItem, pClosestItem);
 
         // Disable scanning so the item is in fov
         *pCanScan = false;
+        pBlackboard->NotifyChanged(BB::CanScan);
 
         // Set new item position as target goal
         *pTarget = pClosestItem->itemInfo.Location;
+        pBlackboard->NotifyChanged(BB::Target);
 
         return Elite::BehaviorState::Success;
     }
     Elite::BehaviorState AddItemToInventory(Elite::Blackboard* pBlackboard)
     {
-        IExamInterface* pInterface{};
-        if (!GetDataFromBlackboard(pBlackboard, "Interface", pInterface))
-            return Elite::BehaviorState::Failure;
-
-        ZombieGame::InventoryManager* pInventoryManager{};
-        if (!GetDataFromBlackboard(pBlackboard, "InventoryManager", pInventoryManager))
-            return Elite::BehaviorState::Failure;
-
-        Item* pTargetItem{};
-        if (!GetDataFromBlackboard(pBlackboard, "TargetItem", pTargetItem))
-            return Elite::BehaviorState::Failure;
+        IExamInterface* pInterface = pBlackboard->GetData(BB::Interface);
+        ZombieGame::InventoryManager* pInventoryManager = pBlackboard->GetData(BB::InventoryManager);
+        Item* pTargetItem = pBlackboard->GetData(BB::TargetItem);
 
         // Determine slot index for item
         int slotIndex;
@@ -497,16 +386,19 @@ namespace BT_Actions
             slotIndex = pInventoryManager->FindFirstEmptySlotExcludingReserved();
             if (slotIndex == -1)
             {
-                std::cout << "No empty slot available for item\n";
+                ELITE_LOG_WARNING("No empty slot available for item");
                 return Elite::BehaviorState::Failure;
             }
         }
 
         if (pInterface->GrabItem(pTargetItem->itemInfo))
         {
+            // The item left the world, the conditions that look at the FOV or the inventory have to run again
+            pBlackboard->NotifyChanged(BB::Interface);
             if (pInterface->Inventory_AddItem(slotIndex, pTargetItem->itemInfo))
             {
                 pInventoryManager->UpdateInventorySlot(slotIndex, pTargetItem->itemInfo);
+                pBlackboard->NotifyChanged(BB::InventoryManager);
                 return Elite::BehaviorState::Success;
             }
             else
@@ -523,17 +415,9 @@ namespace BT_Actions
     }
     Elite::BehaviorState ReplaceItem(Elite::Blackboard* pBlackboard)
     {
-        IExamInterface* pInterface{};
-        if (!GetDataFromBlackboard(pBlackboard, "Interface", pInterface))
-            return Elite::BehaviorState::Failure;
-
-        ZombieGame::InventoryManager* pInventoryManager{};
-        if (!GetDataFromBlackboard(pBlackboard, "InventoryManager", pInventoryManager))
-            return Elite::BehaviorState::Failure;
-
-        Item* pTargetItem{};
-        if (!GetDataFromBlackboard(pBlackboard, "TargetItem", pTargetItem))
-            return Elite::BehaviorState::Failure;
+        IExamInterface* pInterface = pBlackboard->GetData(BB::Interface);
+        ZombieGame::InventoryManager* pInventoryManager = pBlackboard->GetData(BB::InventoryManager);
+        Item* pTargetItem = pBlackboard->GetData(BB::TargetItem);
 
         int slotToReplace = pInventoryManager->GetSlotForItemToReplace(pTargetItem->itemInfo);
         if (slotToReplace == -1)
@@ -546,6 +430,8 @@ namespace BT_Actions
         {
             // recalibrate the Inventory data with interface inventory data
             pInventoryManager->UpdateInventorySlot(slotToReplace, pTargetItem->itemInfo);
+            pBlackboard->NotifyChanged(BB::Interface);
+            pBlackboard->NotifyChanged(BB::InventoryManager);
             return Elite::BehaviorState::Success;
         }
 
@@ -553,32 +439,22 @@ namespace BT_Actions
     }
     Elite::BehaviorState DestroyItem(Elite::Blackboard* pBlackboard)
     {
-        IExamInterface* pInterface{};
-        if (!GetDataFromBlackboard(pBlackboard, "Interface", pInterface))
-            return Elite::BehaviorState::Failure;
-
-        Item* pTargetItem{};
-        if (!GetDataFromBlackboard(pBlackboard, "TargetItem", pTargetItem))
-            return Elite::BehaviorState::Failure;
+        IExamInterface* pInterface = pBlackboard->GetData(BB::Interface);
+        Item* pTargetItem = pBlackboard->GetData(BB::TargetItem);
 
         if (pInterface->DestroyItem(pTargetItem->itemInfo))
+        {
+            pBlackboard->NotifyChanged(BB::Interface);
             return Elite::BehaviorState::Success;
+        }
 
         return Elite::BehaviorState::Failure;
     }
     Elite::BehaviorState MarkItemAsVisited(Elite::Blackboard* pBlackboard)
     {
-        Item* pTargetItem{};
-        if (!GetDataFromBlackboard(pBlackboard, "TargetItem", pTargetItem))
-            return Elite::BehaviorState::Failure;
-
-        ZombieGame::InventoryManager* pInventoryManager{};
-        if (!GetDataFromBlackboard(pBlackboard, "InventoryManager", pInventoryManager))
-            return Elite::BehaviorState::Failure;
-
-        bool* pCanScan{};
-        if (!GetDataFromBlackboard(pBlackboard, "CanScan", pCanScan))
-            return Elite::BehaviorState::Failure;
+        Item* pTargetItem = pBlackboard->GetData(BB::TargetItem);
+        ZombieGame::InventoryManager* pInventoryManager = pBlackboard->GetData(BB::InventoryManager);
+        bool* pCanScan = pBlackboard->GetData(BB::CanScan);
 
         // Check if target item exists in stored items
         auto finder = [&](const std::unique_ptr<Item>& pItem) { return pItem.get() == pTargetItem; };
@@ -591,45 +467,43 @@ namespace BT_Actions
 
         // Set item as visited
         (*iterator)->IsVisited = true;
+        pBlackboard->NotifyChanged(BB::InventoryManager);
 
         // Remove the taken item from Item target
-        pBlackboard->ChangeData("TargetItem", static_cast<Item*>(nullptr));
+        pBlackboard->ChangeData(BB::TargetItem, nullptr);
 
         // Reset scanningto default
         *pCanScan = true;
+        pBlackboard->NotifyChanged(BB::CanScan);
 
         return Elite::BehaviorState::Success;
     }
     Elite::BehaviorState UseMedkit(Elite::Blackboard* pBlackboard)
     {
-        ZombieGame::InventoryManager* pInventoryManager{};
-        if (!GetDataFromBlackboard(pBlackboard, "InventoryManager", pInventoryManager))
-            return Elite::BehaviorState::Failure;
-
-        AgentInfo* pAgentInfo{};
-        if (!GetDataFromBlackboard(pBlackboard, "AgentInfo", pAgentInfo))
-            return Elite::BehaviorState::Failure;
+        ZombieGame::InventoryManager* pInventoryManager = pBlackboard->GetData(BB::InventoryManager);
+        AgentInfo* pAgentInfo = pBlackboard->GetData(BB::AgentInfo);
 
         const float healthThreshold = 5.0f;
 
         if (pInventoryManager->UseMedkit(healthThreshold, pAgentInfo->Health))
+        {
+            pBlackboard->NotifyChanged(BB::InventoryManager);
             return Elite::BehaviorState::Success;
+        }
 
         return Elite::BehaviorState::Failure;
     }
     Elite::BehaviorState UseFood(Elite::Blackboard* pBlackboard)
     {
-        ZombieGame::InventoryManager* pInventoryManager{};
-        if (!GetDataFromBlackboard(pBlackboard, "InventoryManager", pInventoryManager))
-            return Elite::BehaviorState::Failure;
-
-        AgentInfo* pAgentInfo{};
-        if (!GetDataFromBlackboard(pBlackboard, "AgentInfo", pAgentInfo))
-            return Elite::BehaviorState::Failure;
+        ZombieGame::InventoryManager* pInventoryManager = pBlackboard->GetData(BB::InventoryManager);
+        AgentInfo* pAgentInfo = pBlackboard->GetData(BB::AgentInfo);
 
         const float energyThreshold = 6.0f;
         if (pInventoryManager->UseFood(energyThreshold, pAgentInfo->Energy))
+        {
+            pBlackboard->NotifyChanged(BB::InventoryManager);
             return Elite::BehaviorState::Success;
+        }
 
         return Elite::BehaviorState::Failure;
     }
@@ -638,62 +512,40 @@ namespace BT_Actions
 
     Elite::BehaviorState targetClosestEnemyInFOV(Elite::Blackboard* pBlackboard)
     {
-        std::cout << "TargetEnemyInFOV called\n";
+        ELITE_LOG_DEBUG("TargetEnemyInFOV called");
 
-        float* pAlertedTime{};
-        if (!GetDataFromBlackboard(pBlackboard, "AlertedTime", pAlertedTime))
-            return Elite::BehaviorState::Failure;
+        float* pAlertedTime = pBlackboard->GetData(BB::AlertedTime);
 
         // Reset time of alert
         *pAlertedTime = 0.f;
+        pBlackboard->NotifyChanged(BB::AlertedTime);
 
-        IExamInterface* pInterface{};
-        if (!GetDataFromBlackboard(pBlackboard, "Interface", pInterface))
-            return Elite::BehaviorState::Failure;
-
-        ZombieGame::EntityManager* EntityManager{};
-        if (!GetDataFromBlackboard(pBlackboard, "EntityManager", EntityManager))
-            return Elite::BehaviorState::Failure;
-
-        AgentInfo* pAgentInfo{};
-        if (!GetDataFromBlackboard(pBlackboard, "AgentInfo", pAgentInfo))
-            return Elite::BehaviorState::Failure;
-
-        Elite::Vector2* pTarget{};
-        if (!GetDataFromBlackboard(pBlackboard, "Target", pTarget))
-            return Elite::BehaviorState::Failure;
+        ZombieGame::EntityManager* EntityManager = pBlackboard->GetData(BB::EntityManager);
+        AgentInfo* pAgentInfo = pBlackboard->GetData(BB::AgentInfo);
+        Elite::Vector2* pTarget = pBlackboard->GetData(BB::Target);
 
         EnemyInfo* pTargetEnemy = EntityManager->SetClosestEnemyAsTarget(pAgentInfo->Position);
+        pBlackboard->NotifyChanged(BB::EntityManager);
         if (!pTargetEnemy)
             return Elite::BehaviorState::Failure;
 
         // Reset other targets to avoid problems by reassigning targets
-        pBlackboard->ChangeData("TargetEnemy", pTargetEnemy);
-        pBlackboard->ChangeData("TargetHouse", static_cast<House*>(nullptr));
-        pBlackboard->ChangeData("TargetItem", static_cast<Item*>(nullptr));
+        pBlackboard->ChangeData(BB::TargetEnemy, pTargetEnemy);
+        pBlackboard->ChangeData(BB::TargetHouse, nullptr);
+        pBlackboard->ChangeData(BB::TargetItem, nullptr);
 
         // Set agent target location to enemies location
         *pTarget = pTargetEnemy->Location;
+        pBlackboard->NotifyChanged(BB::Target);
 
         return Elite::BehaviorState::Success;
     }
     Elite::BehaviorState Shoot(Elite::Blackboard* pBlackboard)
     {
-        IExamInterface* pInterface{};
-        if (!GetDataFromBlackboard(pBlackboard, "Interface", pInterface))
-            return Elite::BehaviorState::Failure;
-
-        Elite::Vector2* pTarget{};
-        if (!GetDataFromBlackboard(pBlackboard, "Target", pTarget))
-            return Elite::BehaviorState::Failure;
-
-        AgentInfo* pAgent{};
-        if (!GetDataFromBlackboard(pBlackboard, "AgentInfo", pAgent))
-            return Elite::BehaviorState::Failure;
-
-        ZombieGame::InventoryManager* pInventoryManager{};
-        if (!GetDataFromBlackboard(pBlackboard, "InventoryManager", pInventoryManager))
-            return Elite::BehaviorState::Failure;
+        IExamInterface* pInterface = pBlackboard->GetData(BB::Interface);
+        Elite::Vector2* pTarget = pBlackboard->GetData(BB::Target);
+        AgentInfo* pAgent = pBlackboard->GetData(BB::AgentInfo);
+        ZombieGame::InventoryManager* pInventoryManager = pBlackboard->GetData(BB::InventoryManager);
 
         // Get slot of the weapon with most ammo
         int weaponSlotIndex = pInventoryManager->GetBestWeaponSlotIndex(*pAgent, *pTarget);
@@ -702,49 +554,44 @@ namespace BT_Actions
 
         if (!pInterface->Inventory_UseItem(weaponSlotIndex))
             pInventoryManager->EmptyInventorySlot(weaponSlotIndex); // is use item = false : there is no ammo so BYEBYE :)
+        pBlackboard->NotifyChanged(BB::InventoryManager);
 
         return Elite::BehaviorState::Success;
     }
     Elite::BehaviorState HandleAttackFromBehind(Elite::Blackboard* pBlackboard)
     {
-        float* pDeltaTime{};
-        if (!GetDataFromBlackboard(pBlackboard, "DeltaTime", pDeltaTime))
-            return Elite::BehaviorState::Failure;
-
-        float* pAlertedTime{};
-        if (!GetDataFromBlackboard(pBlackboard, "AlertedTime", pAlertedTime))
-            return Elite::BehaviorState::Failure;
+        float* pDeltaTime = pBlackboard->GetData(BB::DeltaTime);
+        float* pAlertedTime = pBlackboard->GetData(BB::AlertedTime);
 
         const float maxAlertTime = 4.f;
 
-        AgentInfo* pAgentInfo{};
-        if (!GetDataFromBlackboard(pBlackboard, "AgentInfo", pAgentInfo))
-            return Elite::BehaviorState::Failure;
-
-        Elite::Vector2* pTarget{};
-        if (!GetDataFromBlackboard(pBlackboard, "Target", pTarget))
-            return Elite::BehaviorState::Failure;
+        AgentInfo* pAgentInfo = pBlackboard->GetData(BB::AgentInfo);
+        Elite::Vector2* pTarget = pBlackboard->GetData(BB::Target);
 
         const float safeDistance = 100.f;
 
         if (pAgentInfo->Bitten)
         {
             *pAlertedTime += *pDeltaTime;
-            std::cout << "Attack from behind\n";
+            pBlackboard->NotifyChanged(BB::AlertedTime);
+            ELITE_LOG_INFO("Attack from behind");
 
             // Move to a safe distance from the enemy + far enough so it has the enemy in fov to shoot
             *pTarget = pAgentInfo->Position - Elite::OrientationToVector(pAgentInfo->Orientation) * safeDistance;
+            pBlackboard->NotifyChanged(BB::Target);
             return Elite::BehaviorState::Success;
         }
         else if (*pAlertedTime > 0.f && *pAlertedTime < maxAlertTime)
         {
             *pAlertedTime += *pDeltaTime;
+            pBlackboard->NotifyChanged(BB::AlertedTime);
             // continue if agent got attacked within max alert time
             return Elite::BehaviorState::Success;
         }
 
         // Agent didn't get attacked within max alert time
         *pAlertedTime = 0.f;
+        pBlackboard->NotifyChanged(BB::AlertedTime);
         return Elite::BehaviorState::Failure;
     }
 
@@ -752,13 +599,8 @@ namespace BT_Actions
 
     Elite::BehaviorState TargetClosestOutPurgeZonePosition(Elite::Blackboard* pBlackboard)
 {
-    ZombieGame::EntityManager* pEntityManager{};
-    if (!GetDataFromBlackboard(pBlackboard, "EntityManager", pEntityManager))
-        return Elite::BehaviorState::Failure;
-
-    AgentInfo* pAgentInfo{};
-    if (!GetDataFromBlackboard(pBlackboard, "AgentInfo", pAgentInfo))
-        return Elite::BehaviorState::Failure;
+    ZombieGame::EntityManager* pEntityManager = pBlackboard->GetData(BB::EntityManager);
+    AgentInfo* pAgentInfo = pBlackboard->GetData(BB::AgentInfo);
 
     PurgeZone* pClosestPurgeZone = pEntityManager->GetClosestPurgeZone(pAgentInfo->Position);
     if (!pClosestPurgeZone)
@@ -768,17 +610,16 @@ namespace BT_Actions
     Elite::Vector2 direction = pAgentInfo->Position - pClosestPurgeZone->Center;
     direction.Normalize();
 
-    Elite::Vector2* pTarget{};
-    if (!GetDataFromBlackboard(pBlackboard, "Target", pTarget))
-        return Elite::BehaviorState::Failure;
+    Elite::Vector2* pTarget = pBlackboard->GetData(BB::Target);
 
     // reset all targets, because purge zone is more urgent
-    pBlackboard->ChangeData("TargetHouse", static_cast<House*>(nullptr));
-    pBlackboard->ChangeData("TargetCheckpoint", static_cast<CheckPoint*>(nullptr));
-    pBlackboard->ChangeData("TargetItem", static_cast<Item*>(nullptr));
+    pBlackboard->ChangeData(BB::TargetHouse, nullptr);
+    pBlackboard->ChangeData(BB::TargetCheckpoint, nullptr);
+    pBlackboard->ChangeData(BB::TargetItem, nullptr);
 
     // Set closest point outside the purgezone as target
     *pTarget = pClosestPurgeZone->Center + direction * pClosestPurgeZone->Radius;
+    pBlackboard->NotifyChanged(BB::Target);
 
     return Elite::BehaviorState::Success;
 }
@@ -793,27 +634,22 @@ namespace BT_Conditions
 
     bool HasNoHouseTarget(Elite::Blackboard* pBlackboard)
     {
-        House* pHouse{};
-        return !GetDataFromBlackboard(pBlackboard, "TargetHouse", pHouse) || pHouse == nullptr;
+        return pBlackboard->GetData(BB::TargetHouse) == nullptr;
     }
     bool IsHouseInFOV(Elite::Blackboard* pBlackboard)
     {
-        IExamInterface* pInterface{};
-        if (!GetDataFromBlackboard(pBlackboard, "Interface", pInterface))
-            return false;
+        const ZombieGame::PerceptionFrame* pPerception = pBlackboard->GetData(BB::Perception);
 
-        return pInterface->FOV_GetStats().NumHouses > 0;
+        return !pPerception->GetHouses().empty();
     }
     bool CanVisitHouseInFOV(Elite::Blackboard* pBlackboard)
     {
-        ZombieGame::HouseManager* pHouseManager{};
-        return GetDataFromBlackboard(pBlackboard, "HouseManager", pHouseManager) && pHouseManager && pHouseManager->CanVisitHouseInFOV();
+        ZombieGame::HouseManager* pHouseManager = pBlackboard->GetData(BB::HouseManager);
+        return pHouseManager && pHouseManager->CanVisitHouseInFOV();
     }
     bool CanVisitKnownHouse(Elite::Blackboard* pBlackboard)
     {
-        ZombieGame::HouseManager* pHouseManager{};
-        if (!GetDataFromBlackboard(pBlackboard, "HouseManager", pHouseManager))
-            return false;
+        ZombieGame::HouseManager* pHouseManager = pBlackboard->GetData(BB::HouseManager);
 
         // check if there is a stored house that isn't visited yet
         auto& houses = pHouseManager->GetStoredHouses();
@@ -824,13 +660,11 @@ namespace BT_Conditions
     }
     bool IsAgentOutsideTargetHouse(Elite::Blackboard* pBlackboard)
     {
-        House* pHouse{};
-        if (!GetDataFromBlackboard(pBlackboard, "TargetHouse", pHouse) || pHouse == nullptr)
+        House* pHouse = pBlackboard->GetData(BB::TargetHouse);
+        if (pHouse == nullptr)
             return false;
 
-        AgentInfo* pAgentInfo{};
-        if (!GetDataFromBlackboard(pBlackboard, "AgentInfo", pAgentInfo))
-            return false;
+        AgentInfo* pAgentInfo = pBlackboard->GetData(BB::AgentInfo);
 
         Elite::Vector2 halfSize = pHouse->Size * 0.5f;
         Elite::Vector2 distance = pAgentInfo->Position - pHouse->Center;
@@ -839,8 +673,8 @@ namespace BT_Conditions
     }
     bool CanSearchHouse(Elite::Blackboard* pBlackboard)
     {
-        House* pHouse{};
-        if (!GetDataFromBlackboard(pBlackboard, "TargetHouse", pHouse) || pHouse == nullptr)
+        House* pHouse = pBlackboard->GetData(BB::TargetHouse);
+        if (pHouse == nullptr)
             return false;
 
         // check if thereis atleast 1 checkpoint not visited in the target house
@@ -851,8 +685,7 @@ namespace BT_Conditions
     }
     bool HasCheckpointTarget(Elite::Blackboard* pBlackboard)
     {
-        CheckPoint* pCheckpoint{};
-        return GetDataFromBlackboard(pBlackboard, "TargetCheckpoint", pCheckpoint) && pCheckpoint != nullptr;
+        return pBlackboard->GetData(BB::TargetCheckpoint) != nullptr;
     }
     bool HasNoCheckpointTarget(Elite::Blackboard* pBlackboard)
     {
@@ -867,13 +700,8 @@ namespace BT_Conditions
 
     bool HasReachedTarget(Elite::Blackboard* pBlackboard)
     {
-        Elite::Vector2* pTarget{};
-        if (!GetDataFromBlackboard(pBlackboard, "Target", pTarget))
-            return false;
-
-        AgentInfo* pAgentInfo{};
-        if (!GetDataFromBlackboard(pBlackboard, "AgentInfo", pAgentInfo))
-            return false;
+        Elite::Vector2* pTarget = pBlackboard->GetData(BB::Target);
+        AgentInfo* pAgentInfo = pBlackboard->GetData(BB::AgentInfo);
 
         // so the target stays in fov distance
         float threshold = 3.f;
@@ -888,27 +716,19 @@ namespace BT_Conditions
 
     bool IsItemInFOV(Elite::Blackboard* pBlackboard)
     {
-        IExamInterface* pInterface{};
-        if (!GetDataFromBlackboard(pBlackboard, "Interface", pInterface))
-            return false;
+        const ZombieGame::PerceptionFrame* pPerception = pBlackboard->GetData(BB::Perception);
 
-        return pInterface->FOV_GetStats().NumItems > 0;
+        return !pPerception->GetItems().empty();
     }
     bool CanVisitItemInFOV(Elite::Blackboard* pBlackboard)
     {
-        ZombieGame::InventoryManager* pInventoryManager{};
-        return GetDataFromBlackboard(pBlackboard, "InventoryManager", pInventoryManager) &&
-            pInventoryManager && pInventoryManager->CanVisitItemInFOV();
+        ZombieGame::InventoryManager* pInventoryManager = pBlackboard->GetData(BB::InventoryManager);
+        return pInventoryManager && pInventoryManager->CanVisitItemInFOV();
     }
     bool CanVisitKnownItems(Elite::Blackboard* pBlackboard)
     {
-        ZombieGame::InventoryManager* pInventoryManager{};
-        if (!GetDataFromBlackboard(pBlackboard, "InventoryManager", pInventoryManager))
-            return false;
-
-        House* pTargetHouse{};
-        if (!GetDataFromBlackboard(pBlackboard, "TargetHouse", pTargetHouse))
-            return false;
+        ZombieGame::InventoryManager* pInventoryManager = pBlackboard->GetData(BB::InventoryManager);
+        House* pTargetHouse = pBlackboard->GetData(BB::TargetHouse);
 
         // check in stored items if there isan item not visited yet
         auto& pStoredItems = pInventoryManager->GetStoredItems();
@@ -921,20 +741,12 @@ namespace BT_Conditions
     }
     bool IsItemInGrabRange(Elite::Blackboard* pBlackboard)
     {
-        Item* pTargetItem{};
-        if (!GetDataFromBlackboard(pBlackboard, "TargetItem", pTargetItem))
-            return false;
-
-        AgentInfo* pAgentInfo{};
-        if (!GetDataFromBlackboard(pBlackboard, "AgentInfo", pAgentInfo))
-            return false;
-
-        IExamInterface* pInterface{};
-        if (!GetDataFromBlackboard(pBlackboard, "Interface", pInterface))
-            return false;
+        Item* pTargetItem = pBlackboard->GetData(BB::TargetItem);
+        AgentInfo* pAgentInfo = pBlackboard->GetData(BB::AgentInfo);
+        const ZombieGame::PerceptionFrame* pPerception = pBlackboard->GetData(BB::Perception);
 
         // check if item in grab range is also in FOV
-        auto itemsInFOV = pInterface->GetItemsInFOV();
+        const auto& itemsInFOV = pPerception->GetItems();
         bool isInFov = std::any_of(itemsInFOV.begin(), itemsInFOV.end(), [&](const ItemInfo& itemInfo)
             {
                 return itemInfo.ItemHash == pTargetItem->itemInfo.ItemHash;
@@ -944,8 +756,7 @@ namespace BT_Conditions
     }
     bool HasItemTarget(Elite::Blackboard* pBlackboard)
     {
-        Item* pTargetItem{};
-        return GetDataFromBlackboard(pBlackboard, "TargetItem", pTargetItem) && pTargetItem != nullptr;
+        return pBlackboard->GetData(BB::TargetItem) != nullptr;
     }
     bool HasNoItemTarget(Elite::Blackboard* pBlackboard)
     {
@@ -953,9 +764,7 @@ namespace BT_Conditions
     }
     bool IsGarbage(Elite::Blackboard* pBlackboard)
     {
-        Item* pTargetItem{};
-        if (!GetDataFromBlackboard(pBlackboard, "TargetItem", pTargetItem))
-            return false;
+        Item* pTargetItem = pBlackboard->GetData(BB::TargetItem);
 
         return pTargetItem->itemInfo.Type == eItemType::GARBAGE;
     }
@@ -965,33 +774,28 @@ namespace BT_Conditions
     }
     bool HasEmptySlot(Elite::Blackboard* pBlackboard)
     {
-        ZombieGame::InventoryManager* pInventoryManager{};
-        if (!GetDataFromBlackboard(pBlackboard, "InventoryManager", pInventoryManager))
-            return false;
-
-        Item* pTargetItem{};
-        if (!GetDataFromBlackboard(pBlackboard, "TargetItem", pTargetItem))
-            return false;
+        ZombieGame::InventoryManager* pInventoryManager = pBlackboard->GetData(BB::InventoryManager);
+        Item* pTargetItem = pBlackboard->GetData(BB::TargetItem);
 
         // Specific checks for pistol and shotgun slots
         if (pTargetItem->itemInfo.Type == eItemType::PISTOL)
         {
             if (pInventoryManager->IsPistolSlotEmpty())
             {
-                std::cout << "Pistol slot is empty\n";
+                ELITE_LOG_DEBUG("Pistol slot is empty");
                 return true;
             }
-            std::cout << "Pistol slot is not empty\n";
+            ELITE_LOG_DEBUG("Pistol slot is not empty");
             return false;
         }
         else if (pTargetItem->itemInfo.Type == eItemType::SHOTGUN)
         {
             if (pInventoryManager->IsShotgunSlotEmpty())
             {
-                std::cout << "Shotgun slot is empty\n";
+                ELITE_LOG_DEBUG("Shotgun slot is empty");
                 return true;
             }
-            std::cout << "Shotgun slot is not empty\n";
+            ELITE_LOG_DEBUG("Shotgun slot is not empty");
             return false;
         }
 
@@ -999,35 +803,23 @@ namespace BT_Conditions
         int emptySlotIndex = pInventoryManager->FindFirstEmptySlotExcludingReserved();
         if (emptySlotIndex != -1)
         {
-            std::cout << "Found an empty slot for items\n";
+            ELITE_LOG_DEBUG("Found an empty slot for items");
             return true;
         }
 
-        std::cout << "No empty slots available\n";
+        ELITE_LOG_DEBUG("No empty slots available");
         return false;
     }
     bool IsMedkitNeeded(Elite::Blackboard* pBlackboard)
     {
-        ZombieGame::InventoryManager* pInventoryManager{};
-        if (!GetDataFromBlackboard(pBlackboard, "InventoryManager", pInventoryManager))
-            return false;
-
-        AgentInfo* pAgentInfo{};
-        if (!GetDataFromBlackboard(pBlackboard, "AgentInfo", pAgentInfo))
-            return false;
+        AgentInfo* pAgentInfo = pBlackboard->GetData(BB::AgentInfo);
 
         const float healthThreshold = 8.0f;
         return pAgentInfo->Health < healthThreshold;
     }
     bool IsFoodNeeded(Elite::Blackboard* pBlackboard)
     {
-        ZombieGame::InventoryManager* pInventoryManager{};
-        if (!GetDataFromBlackboard(pBlackboard, "InventoryManager", pInventoryManager))
-            return false;
-
-        AgentInfo* pAgentInfo{};
-        if (!GetDataFromBlackboard(pBlackboard, "AgentInfo", pAgentInfo))
-            return false;
+        AgentInfo* pAgentInfo = pBlackboard->GetData(BB::AgentInfo);
 
         const float staminaThreshold = 7.0f;
         return pAgentInfo->Energy < staminaThreshold;
@@ -1035,27 +827,23 @@ namespace BT_Conditions
 
     bool HasMedkit(Elite::Blackboard* pBlackboard)
     {
-        ZombieGame::InventoryManager* pInventoryManager{};
-        return GetDataFromBlackboard(pBlackboard, "InventoryManager", pInventoryManager) &&
-            pInventoryManager->HasMedkitInInventory();
+        ZombieGame::InventoryManager* pInventoryManager = pBlackboard->GetData(BB::InventoryManager);
+        return pInventoryManager->HasMedkitInInventory();
     }
     bool HasFood(Elite::Blackboard* pBlackboard)
     {
-        ZombieGame::InventoryManager* pInventoryManager{};
-        return GetDataFromBlackboard(pBlackboard, "InventoryManager", pInventoryManager) &&
-            pInventoryManager->HasFoodInInventory();
+        ZombieGame::InventoryManager* pInventoryManager = pBlackboard->GetData(BB::InventoryManager);
+        return pInventoryManager->HasFoodInInventory();
     }
     bool HasPistol(Elite::Blackboard* pBlackboard)
     {
-        ZombieGame::InventoryManager* pInventoryManager{};
-        return GetDataFromBlackboard(pBlackboard, "InventoryManager", pInventoryManager) &&
-            pInventoryManager->HasPistol();
+        ZombieGame::InventoryManager* pInventoryManager = pBlackboard->GetData(BB::InventoryManager);
+        return pInventoryManager->HasPistol();
     }
     bool HasShotgun(Elite::Blackboard* pBlackboard)
     {
-        ZombieGame::InventoryManager* pInventoryManager{};
-        return GetDataFromBlackboard(pBlackboard, "InventoryManager", pInventoryManager) &&
-            pInventoryManager->HasShotgun();
+        ZombieGame::InventoryManager* pInventoryManager = pBlackboard->GetData(BB::InventoryManager);
+        return pInventoryManager->HasShotgun();
     }
     bool HasNoWeapon(Elite::Blackboard* pBlackboard)
     {
@@ -1063,30 +851,22 @@ namespace BT_Conditions
     }
     bool ShouldItemBeReplaced(Elite::Blackboard* pBlackboard)
     {
-        ZombieGame::InventoryManager* pInventoryManager{};
-        Item* pTargetItem{};
-        return GetDataFromBlackboard(pBlackboard, "InventoryManager", pInventoryManager) &&
-            GetDataFromBlackboard(pBlackboard, "TargetItem", pTargetItem) &&
-            pInventoryManager->ShouldItemBeReplaced(pTargetItem->itemInfo);
+        ZombieGame::InventoryManager* pInventoryManager = pBlackboard->GetData(BB::InventoryManager);
+        Item* pTargetItem = pBlackboard->GetData(BB::TargetItem);
+        return pInventoryManager->ShouldItemBeReplaced(pTargetItem->itemInfo);
     }
 
     // Enemy Conditions
 
     bool IsEnemyInFOV(Elite::Blackboard* pBlackboard)
     {
-        IExamInterface* pInterface{};
-        return GetDataFromBlackboard(pBlackboard, "Interface", pInterface) &&
-            pInterface->FOV_GetStats().NumEnemies > 0;
+        const ZombieGame::PerceptionFrame* pPerception = pBlackboard->GetData(BB::Perception);
+        return !pPerception->GetEnemies().empty();
     }
     bool IsAimingFinished(Elite::Blackboard* pBlackboard)
     {
-        Elite::Vector2* pTarget{};
-        if (!GetDataFromBlackboard(pBlackboard, "Target", pTarget))
-            return false;
-
-        AgentInfo* pAgentInfo{};
-        if ( !GetDataFromBlackboard(pBlackboard, "AgentInfo", pAgentInfo))
-            return false;
+        Elite::Vector2* pTarget = pBlackboard->GetData(BB::Target);
+        AgentInfo* pAgentInfo = pBlackboard->GetData(BB::AgentInfo);
 
         // check if if agent faces the enemy , treshholdfor floating point errors
         const float currentOrientation = pAgentInfo->Orientation;
@@ -1095,17 +875,50 @@ namespace BT_Conditions
 
         return std::abs(currentOrientation - desiredOrientation) < aimThreshold;
     }
+    bool IsUnderAttack(Elite::Blackboard* pBlackboard)
+    {
+        AgentInfo* pAgentInfo = pBlackboard->GetData(BB::AgentInfo);
+        float* pAlertedTime = pBlackboard->GetData(BB::AlertedTime);
+
+        // HandleAttackFromBehind stays active while the alerted timer runs
+        return pAgentInfo->Bitten || *pAlertedTime > 0.f;
+    }
 
     // Purge zone
 
     bool IsInPurgeZone(Elite::Blackboard* pBlackboard)
     {
-        ZombieGame::EntityManager* pEntityManager{};
-        AgentInfo* pAgentInfo{};
+        ZombieGame::EntityManager* pEntityManager = pBlackboard->GetData(BB::EntityManager);
+        AgentInfo* pAgentInfo = pBlackboard->GetData(BB::AgentInfo);
+
+        return pEntityManager->IsAgentInPurgeZone(pAgentInfo->Position);
+    }
+}
+
+//-----------------------------------------------------------------
+// Scores (UtilitySelector)
+//-----------------------------------------------------------------
+
+namespace BT_Scores
+{
+    // 0 when the consumable can not be used, otherwise how much of the stat is missing (0..1)
+    float MedkitUrgency(Elite::Blackboard* pBlackboard)
+    {
+        if (!BT_Conditions::IsMedkitNeeded(pBlackboard) || !BT_Conditions::HasMedkit(pBlackboard))
+            return 0.f;
+
+        AgentInfo* pAgentInfo = pBlackboard->GetData(BB::AgentInfo);
+        const float maxHealth = 10.f;
+        return (maxHealth - pAgentInfo->Health) / maxHealth;
+    }
+    float FoodUrgency(Elite::Blackboard* pBlackboard)
+    {
+        if (!BT_Conditions::IsFoodNeeded(pBlackboard) || !BT_Conditions::HasFood(pBlackboard))
+            return 0.f;
 
-        return GetDataFromBlackboard(pBlackboard, "EntityManager", pEntityManager) &&
-            GetDataFromBlackboard(pBlackboard, "AgentInfo", pAgentInfo) &&
-            pEntityManager->IsAgentInPurgeZone(pAgentInfo->Position);
+        AgentInfo* pAgentInfo = pBlackboard->GetData(BB::AgentInfo);
+        const float maxEnergy = 10.f;
+        return (maxEnergy - pAgentInfo->Energy) / maxEnergy;
     }
 }
 #endif
\ No newline at end of file
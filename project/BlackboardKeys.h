@@ -0,0 +1,91 @@
+#pragma once
+#include "EliteData/EBlackboard.h"
+
+#include <memory>
+#include <vector>
+
+// Forward declarations of everything stored in the blackboard
+class IExamInterface;
+class ISteeringBehavior;
+class Seek;
+class Face;
+class Flee;
+class Arrive;
+class BlendedSteering;
+struct SteeringPlugin_Output_Extended;
+struct AgentInfo;
+struct House;
+struct CheckPoint;
+struct Item;
+struct EnemyInfo;
+struct PurgeZone;
+
+namespace Elite
+{
+    struct Vector2;
+}
+
+namespace ZombieGame
+{
+    class Grid;
+    class HouseManager;
+    class InventoryManager;
+    class EntityManager;
+    class PerceptionFrame;
+    class NavMeshQueryCache;
+}
+
+// Blackboard layout of the survival agent.
+// Every key owns a fixed slot index, keep the indices dense and unique.
+// Registered in SurvivalAgentPlugin::InitializeBlackboard, the string names stay valid for the slow-path API.
+namespace BB
+{
+    // Global Data
+    constexpr Elite::BlackboardKey<::IExamInterface*> Interface{ 0, "Interface" };
+    constexpr Elite::BlackboardKey<const ZombieGame::PerceptionFrame*> Perception{ 27, "Perception" }; // Captured once per frame, read it instead of the interface
+    constexpr Elite::BlackboardKey<ZombieGame::NavMeshQueryCache*> NavMeshCache{ 28, "NavMeshCache" }; // Use it instead of NavMesh_GetClosestPathPoint
+
+    // Grid Data
+    constexpr Elite::BlackboardKey<ZombieGame::Grid*> Grid{ 1, "Grid" };
+
+    // Steering Data
+    constexpr Elite::BlackboardKey<::SteeringPlugin_Output_Extended*> CurrentSteering{ 2, "CurrentSteering" };
+    constexpr Elite::BlackboardKey<::ISteeringBehavior*> CurrentSteeringBehavior{ 3, "CurrentSteeringBehavior" };
+    constexpr Elite::BlackboardKey<::Seek*> Seek{ 4, "Seek" };
+    constexpr Elite::BlackboardKey<::Face*> Face{ 5, "Face" };
+    constexpr Elite::BlackboardKey<::Flee*> Flee{ 6, "Flee" };
+    constexpr Elite::BlackboardKey<::Arrive*> Arrive{ 7, "Arrive" };
+    constexpr Elite::BlackboardKey<::BlendedSteering*> SeekAndFace{ 8, "SeekAndFace" };
+    constexpr Elite::BlackboardKey<::BlendedSteering*> FleeAndFace{ 9, "FleeAndFace" };
+
+    // Agent Data
+    constexpr Elite::BlackboardKey<::AgentInfo*> AgentInfo{ 10, "AgentInfo" };
+    constexpr Elite::BlackboardKey<float> RunTreshold{ 11, "RunTreshold" };
+    constexpr Elite::BlackboardKey<bool*> ShouldRun{ 12, "ShouldRun" };
+    constexpr Elite::BlackboardKey<bool*> CanScan{ 13, "CanScan" };
+    constexpr Elite::BlackboardKey<float*> AlertedTime{ 14, "AlertedTime" };
+
+    // Target Data
+    constexpr Elite::BlackboardKey<Elite::Vector2*> Target{ 15, "Target" };
+    constexpr Elite::BlackboardKey<::House*> TargetHouse{ 16, "TargetHouse" };
+    constexpr Elite::BlackboardKey<::CheckPoint*> TargetCheckpoint{ 17, "TargetCheckpoint" };
+    constexpr Elite::BlackboardKey<::Item*> TargetItem{ 18, "TargetItem" };
+    constexpr Elite::BlackboardKey<::EnemyInfo*> TargetEnemy{ 19, "TargetEnemy" };
+    constexpr Elite::BlackboardKey<::PurgeZone*> TargetPurgeZone{ 20, "TargetPurgeZone" };
+
+    // House Data
+    constexpr Elite::BlackboardKey<std::vector<std::unique_ptr<::House>>*> StoredHouses{ 21, "StoredHouses" };
+    constexpr Elite::BlackboardKey<ZombieGame::HouseManager*> HouseManager{ 22, "HouseManager" };
+
+    // Inventory Data
+    constexpr Elite::BlackboardKey<ZombieGame::InventoryManager*> InventoryManager{ 23, "InventoryManager" };
+
+    // Enemy Data
+    constexpr Elite::BlackboardKey<ZombieGame::EntityManager*> EntityManager{ 24, "EntityManager" };
+
+    // Timers
+    constexpr Elite::BlackboardKey<float*> DeltaTime{ 25, "DeltaTime" };
+    constexpr Elite::BlackboardKey<float*> ExploreTime{ 26, "ExploreTime" };
+
+    constexpr unsigned int KeyCount{ 29 };
+}
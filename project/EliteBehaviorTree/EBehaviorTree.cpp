@@ -1,14 +1,22 @@
 //=== General Includes ===
 #include "stdafx.h"
 #include "EBehaviorTree.h"
+#include "EFlatBehaviorTree.h"
+#include "EBehaviorTreeBuilder.h"
+#include "EBehaviorTreeMemo.h"
+#include "EBehaviorTreeTrace.h"
 using namespace Elite;
 
+thread_local BehaviorTreeContext* BehaviorTreeContext::s_pCurrent = nullptr;
+constexpr float BehaviorUtilitySelector::DefaultHysteresis;
+constexpr unsigned int BehaviorConditional::NoMemoSlot;
+
 //-----------------------------------------------------------------
 // BEHAVIOR TREE COMPOSITES (IBehavior)
 //-----------------------------------------------------------------
 #pragma region COMPOSITES
 //SELECTOR
-BehaviorState BehaviorSelector::Execute(Blackboard* pBlackBoard)
+BehaviorState BehaviorSelector::OnExecute(Blackboard* pBlackBoard)
 {
 	// BT TODO:
 	// Loop over all children in m_ChildBehaviors
@@ -36,7 +44,7 @@ BehaviorState BehaviorSelector::Execute(Blackboard* pBlackBoard)
 	return m_CurrentState;
 }
 //SEQUENCE
-BehaviorState BehaviorSequence::Execute(Blackboard* pBlackBoard)
+BehaviorState BehaviorSequence::OnExecute(Blackboard* pBlackBoard)
 {
 	// BT TODO:
 	//Loop over all children in m_ChildBehaviors
@@ -66,7 +74,7 @@ BehaviorState BehaviorSequence::Execute(Blackboard* pBlackBoard)
 	return m_CurrentState;
 }
 //PARTIAL SEQUENCE
-BehaviorState BehaviorPartialSequence::Execute(Blackboard* pBlackBoard)
+BehaviorState BehaviorPartialSequence::OnExecute(Blackboard* pBlackBoard)
 {
 	while (m_CurrentBehaviorIndex < m_ChildBehaviors.size())
 	{
@@ -89,15 +97,224 @@ BehaviorState BehaviorPartialSequence::Execute(Blackboard* pBlackBoard)
 	m_CurrentState = BehaviorState::Success;
 	return m_CurrentState;
 }
+//MEMORY COMPOSITE
+unsigned int BehaviorMemoryComposite::ResumeIndex(Blackboard* pBlackBoard)
+{
+	if (m_RunningChildIndex < 0)
+		return 0;
+
+	const unsigned int runningChildIndex = static_cast<unsigned int>(m_RunningChildIndex);
+	m_RunningChildIndex = -1;
+
+	// A guard that succeeds means a higher priority behavior wants to take over
+	for (IBehavior* pGuard : m_InterruptGuards)
+	{
+		if (pGuard->Execute(pBlackBoard) == BehaviorState::Success)
+		{
+			m_ChildBehaviors[runningChildIndex]->Reset();
+			return 0;
+		}
+	}
+	return runningChildIndex;
+}
+//MEMORY SELECTOR
+BehaviorState BehaviorMemorySelector::OnExecute(Blackboard* pBlackBoard)
+{
+	for (unsigned int i = ResumeIndex(pBlackBoard); i < m_ChildBehaviors.size(); ++i)
+	{
+		m_CurrentState = m_ChildBehaviors[i]->Execute(pBlackBoard);
+		switch (m_CurrentState)
+		{
+		case BehaviorState::Running:
+			m_RunningChildIndex = static_cast<int>(i);
+			return m_CurrentState;
+		case BehaviorState::Success:
+			return m_CurrentState;
+		default:
+			break;
+		}
+	}
+
+	m_CurrentState = BehaviorState::Failure;
+	return m_CurrentState;
+}
+//MEMORY SEQUENCE
+BehaviorState BehaviorMemorySequence::OnExecute(Blackboard* pBlackBoard)
+{
+	for (unsigned int i = ResumeIndex(pBlackBoard); i < m_ChildBehaviors.size(); ++i)
+	{
+		m_CurrentState = m_ChildBehaviors[i]->Execute(pBlackBoard);
+		switch (m_CurrentState)
+		{
+		case BehaviorState::Running:
+			m_RunningChildIndex = static_cast<int>(i);
+			return m_CurrentState;
+		case BehaviorState::Failure:
+			return m_CurrentState;
+		default:
+			break;
+		}
+	}
+
+	m_CurrentState = BehaviorState::Success;
+	return m_CurrentState;
+}
+//PARALLEL
+BehaviorState BehaviorParallel::OnExecute(Blackboard* pBlackBoard)
+{
+	// The read recorder and the profilers are not synchronized
+	bool canDispatch = m_pJobSystem != nullptr && pBlackBoard->GetReadRecorder() == nullptr && pBlackBoard->GetProfiler() == nullptr;
+#if ELITE_BT_PROFILING
+	canDispatch = false;
+#endif
+
+	const BehaviorTreeContext* pContext = BehaviorTreeContext::GetCurrent();
+	bool hasDispatched = false;
+	if (canDispatch)
+	{
+		for (size_t i = 0; i < m_ChildBehaviors.size(); ++i)
+		{
+			if (!m_ChildBehaviors[i]->IsSideEffectFree())
+				continue;
+
+			ChildJob& job = m_ChildJobs[i];
+			job.pBehavior = m_ChildBehaviors[i];
+			job.pBlackBoard = pBlackBoard;
+			job.HasContext = pContext != nullptr;
+			if (pContext)
+			{
+				// The memo and the recorder are shared by the whole tree, the workers evaluate their conditions themselves
+				job.Context = *pContext;
+				job.Context.pConditionMemo = nullptr;
+				job.Context.pTraceRecorder = nullptr;
+			}
+			m_pJobSystem->Run(&BehaviorParallel::ExecuteChildJob, &job, m_JobCounter);
+			hasDispatched = true;
+		}
+	}
+
+	// The other children write the blackboard, they only run once no worker reads it anymore
+	if (hasDispatched)
+		m_pJobSystem->Wait(m_JobCounter);
+
+	for (size_t i = 0; i < m_ChildBehaviors.size(); ++i)
+	{
+		if (!canDispatch || !m_ChildBehaviors[i]->IsSideEffectFree())
+			m_ChildJobs[i].State = m_ChildBehaviors[i]->Execute(pBlackBoard);
+	}
+
+	size_t successCount = 0;
+	size_t failureCount = 0;
+	for (const ChildJob& job : m_ChildJobs)
+	{
+		if (job.State == BehaviorState::Success)
+			++successCount;
+		else if (job.State == BehaviorState::Failure)
+			++failureCount;
+	}
+
+	const size_t childCount = m_ChildBehaviors.size();
+	if (failureCount > 0 && (m_FailurePolicy == BehaviorParallelPolicy::RequireOne || failureCount == childCount))
+		m_CurrentState = BehaviorState::Failure;
+	else if (successCount > 0 && (m_SuccessPolicy == BehaviorParallelPolicy::RequireOne || successCount == childCount))
+		m_CurrentState = BehaviorState::Success;
+	else
+		m_CurrentState = childCount > 0 ? BehaviorState::Running : BehaviorState::Success;
+
+	if (m_CurrentState != BehaviorState::Running)
+	{
+		for (size_t i = 0; i < childCount; ++i)
+		{
+			if (m_ChildJobs[i].State == BehaviorState::Running)
+				m_ChildBehaviors[i]->Reset();
+		}
+	}
+	return m_CurrentState;
+}
+
+void BehaviorParallel::ExecuteChildJob(void* pData)
+{
+	ChildJob& job = *static_cast<ChildJob*>(pData);
+	BehaviorTreeContext::Scope contextScope{ job.HasContext ? &job.Context : nullptr };
+	job.State = job.pBehavior->Execute(job.pBlackBoard);
+}
+//UTILITY SELECTOR
+BehaviorState BehaviorUtilitySelector::OnExecute(Blackboard* pBlackBoard)
+{
+	const unsigned int childCount = static_cast<unsigned int>(m_ChildBehaviors.size());
+	for (unsigned int i = 0; i < childCount; ++i)
+		m_Scores[i] = i < m_ScoreFunctions.size() && m_ScoreFunctions[i] ? m_ScoreFunctions[i](pBlackBoard) : 0.f;
+
+	// Highest score first, insertion sort keeps equal scores in child order and there are only a few children
+	for (unsigned int i = 0; i < childCount; ++i)
+	{
+		unsigned int j = i;
+		for (; j > 0 && m_Scores[m_Order[j - 1]] < m_Scores[i]; --j)
+			m_Order[j] = m_Order[j - 1];
+		m_Order[j] = i;
+	}
+
+	// The previous choice stays first unless it is clearly beaten
+	const int previousIndex = m_SelectedIndex;
+	if (previousIndex >= 0 && childCount > 0 && m_Scores[previousIndex] > 0.f
+		&& m_Scores[m_Order[0]] <= m_Scores[previousIndex] + m_Hysteresis)
+	{
+		unsigned int j = 0;
+		while (m_Order[j] != static_cast<unsigned int>(previousIndex))
+			++j;
+		for (; j > 0; --j)
+			m_Order[j] = m_Order[j - 1];
+		m_Order[0] = static_cast<unsigned int>(previousIndex);
+	}
+
+	m_SelectedIndex = -1;
+	m_CurrentState = BehaviorState::Failure;
+	for (unsigned int i = 0; i < childCount && m_Scores[m_Order[i]] > 0.f; ++i)
+	{
+		const BehaviorState state = m_ChildBehaviors[m_Order[i]]->Execute(pBlackBoard);
+		if (state != BehaviorState::Failure)
+		{
+			m_SelectedIndex = static_cast<int>(m_Order[i]);
+			m_CurrentState = state;
+			break;
+		}
+	}
+
+	// A child that was running but lost the selection does not get ticked anymore
+	if (previousIndex >= 0 && previousIndex != m_SelectedIndex)
+		m_ChildBehaviors[previousIndex]->Reset();
+	return m_CurrentState;
+}
 #pragma endregion
 //-----------------------------------------------------------------
 // BEHAVIOR TREE CONDITIONAL (IBehavior)
 //-----------------------------------------------------------------
-BehaviorState BehaviorConditional::Execute(Blackboard* pBlackBoard)
+BehaviorState BehaviorConditional::OnExecute(Blackboard* pBlackBoard)
 {
 	if (m_fpConditional == nullptr)
 		return BehaviorState::Failure;
 
+	// Nothing the condition depends on changed, so neither did its result
+	if (!m_Dependencies.IsEmpty() && !m_Dependencies.PollChanges(pBlackBoard))
+		return m_CurrentState;
+
+	// Plain functions are shared through the memo of the tree, lambdas have no identity to share
+	const BehaviorTreeContext* pContext = BehaviorTreeContext::GetCurrent();
+	if (m_Dependencies.IsEmpty() && pContext && pContext->pConditionMemo)
+	{
+		if (m_pMemo != pContext->pConditionMemo)
+		{
+			const BehaviorConditionMemo::ConditionFunction* pFunction = m_fpConditional.target<BehaviorConditionMemo::ConditionFunction>();
+			m_pMemo = pContext->pConditionMemo;
+			m_MemoSlot = pFunction && *pFunction ? pContext->pConditionMemo->GetSlot(*pFunction) : NoMemoSlot;
+		}
+		if (m_MemoSlot != NoMemoSlot)
+		{
+			m_CurrentState = pContext->pConditionMemo->Evaluate(m_MemoSlot, pBlackBoard) ? BehaviorState::Success : BehaviorState::Failure;
+			return m_CurrentState;
+		}
+	}
+
 	// This used to be a switch case for some reason, now it's not, be happy :)
 	if (m_fpConditional(pBlackBoard))
 	{
@@ -112,11 +329,244 @@ BehaviorState BehaviorConditional::Execute(Blackboard* pBlackBoard)
 //-----------------------------------------------------------------
 // BEHAVIOR TREE ACTION (IBehavior)
 //-----------------------------------------------------------------
-BehaviorState BehaviorAction::Execute(Blackboard* pBlackBoard)
+BehaviorState BehaviorAction::OnExecute(Blackboard* pBlackBoard)
 {
 	if (m_fpAction == nullptr)
 		return BehaviorState::Failure;
 
 	m_CurrentState = m_fpAction(pBlackBoard);
 	return m_CurrentState;
-}
\ No newline at end of file
+}
+//-----------------------------------------------------------------
+// BEHAVIOR TREE DECORATORS (IBehavior)
+//-----------------------------------------------------------------
+#pragma region DECORATORS
+//TICK RATE
+BehaviorState BehaviorTickRate::OnExecute(Blackboard* pBlackBoard)
+{
+	if (m_pChildBehavior == nullptr)
+		return BehaviorState::Failure;
+
+	const BehaviorTreeContext* pContext = BehaviorTreeContext::GetCurrent();
+	if (pContext)
+	{
+		const bool isContinuing = m_HasState && pContext->Tick == m_LastTick + 1;
+		m_LastTick = pContext->Tick;
+
+		const bool hasKeyChanged = !m_Keys.IsEmpty() && m_Keys.PollChanges(pBlackBoard);
+		if (isContinuing && !hasKeyChanged && pContext->Time < m_NextEvaluationTime)
+		{
+			++m_Stats.Skips;
+			return m_CurrentState;
+		}
+	}
+
+	const auto start = std::chrono::high_resolution_clock::now();
+	m_CurrentState = m_pChildBehavior->Execute(pBlackBoard);
+	const double cost = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+	// Take the writes of the child to the keys as seen
+	if (!m_Keys.IsEmpty())
+		m_Keys.PollChanges(pBlackBoard);
+
+	++m_Stats.Evaluations;
+	m_Stats.TotalSeconds += cost;
+	m_Stats.MaxSeconds = cost > m_Stats.MaxSeconds ? cost : m_Stats.MaxSeconds;
+
+	if (pContext)
+	{
+		float interval = m_Interval;
+		if (m_Budget > 0.f && static_cast<float>(cost) / m_Budget > interval)
+			interval = static_cast<float>(cost) / m_Budget;
+		m_NextEvaluationTime = pContext->Time + interval;
+	}
+	m_HasState = true;
+	return m_CurrentState;
+}
+
+void BehaviorTickRate::PrintReport() const
+{
+	const unsigned int ticks = m_Stats.Evaluations + m_Stats.Skips;
+	printf("%-24s %8u evaluated, %8u skipped (%.1f%%), %10.2f us avg, %10.2f us max\n", GetName(),
+		m_Stats.Evaluations, m_Stats.Skips, ticks > 0 ? 100.0 * m_Stats.Skips / ticks : 0.0,
+		m_Stats.Evaluations > 0 ? m_Stats.TotalSeconds * 1000000.0 / m_Stats.Evaluations : 0.0,
+		m_Stats.MaxSeconds * 1000000.0);
+}
+//COOLDOWN
+BehaviorState BehaviorCooldown::OnExecute(Blackboard* pBlackBoard)
+{
+	const BehaviorTreeContext* pContext = BehaviorTreeContext::GetCurrent();
+	if (m_pChildBehavior == nullptr || (pContext && pContext->Time < m_ReadyTime))
+	{
+		m_CurrentState = BehaviorState::Failure;
+		return m_CurrentState;
+	}
+
+	m_CurrentState = m_pChildBehavior->Execute(pBlackBoard);
+	if (m_CurrentState == BehaviorState::Success && pContext)
+		m_ReadyTime = pContext->Time + m_Duration;
+	return m_CurrentState;
+}
+//TIMEOUT
+BehaviorState BehaviorTimeout::OnExecute(Blackboard* pBlackBoard)
+{
+	if (m_pChildBehavior == nullptr)
+		return BehaviorState::Failure;
+
+	const BehaviorTreeContext* pContext = BehaviorTreeContext::GetCurrent();
+	if (pContext)
+	{
+		const bool isContinuing = m_IsRunning && pContext->Tick == m_LastTick + 1;
+		if (!isContinuing)
+			m_StartTime = pContext->Time;
+		else if (pContext->Time - m_StartTime >= m_Duration)
+		{
+			m_pChildBehavior->Reset();
+			m_IsRunning = false;
+			m_CurrentState = BehaviorState::Failure;
+			return m_CurrentState;
+		}
+		m_LastTick = pContext->Tick;
+	}
+
+	m_CurrentState = m_pChildBehavior->Execute(pBlackBoard);
+	m_IsRunning = m_CurrentState == BehaviorState::Running;
+	return m_CurrentState;
+}
+//RATE LIMIT
+BehaviorState BehaviorRateLimit::OnExecute(Blackboard* pBlackBoard)
+{
+	if (m_pChildBehavior == nullptr)
+		return BehaviorState::Failure;
+
+	const BehaviorTreeContext* pContext = BehaviorTreeContext::GetCurrent();
+	if (pContext)
+	{
+		// Refill count tokens per period, never more than count
+		if (m_Period > 0.f)
+		{
+			m_Tokens += (pContext->Time - m_LastRefillTime) * m_Count / m_Period;
+			m_Tokens = m_Tokens > m_Count ? m_Count : m_Tokens;
+		}
+		m_LastRefillTime = pContext->Time;
+
+		// Other branches may have changed what the child decided on since it last ran, so it runs again
+		const bool isContinuing = m_WasTicked && pContext->Tick == m_LastTick + 1;
+		m_WasTicked = true;
+		m_LastTick = pContext->Tick;
+
+		if (isContinuing && m_Tokens < 1.f)
+		{
+			if (m_CurrentState != BehaviorState::Running)
+				m_CurrentState = BehaviorState::Failure;
+			return m_CurrentState;
+		}
+		m_Tokens = m_Tokens > 1.f ? m_Tokens - 1.f : 0.f;
+	}
+
+	m_CurrentState = m_pChildBehavior->Execute(pBlackBoard);
+	return m_CurrentState;
+}
+//RUN ONCE UNTIL KEY CHANGES
+BehaviorState BehaviorRunOnceUntilKeyChanges::OnExecute(Blackboard* pBlackBoard)
+{
+	if (m_pChildBehavior == nullptr)
+		return BehaviorState::Failure;
+
+	if (!m_IsRunning && !m_Keys.PollChanges(pBlackBoard))
+		return m_CurrentState;
+
+	m_CurrentState = m_pChildBehavior->Execute(pBlackBoard);
+	m_IsRunning = m_CurrentState == BehaviorState::Running;
+
+	// Take the writes of the child to the keys as seen
+	if (!m_IsRunning)
+		m_Keys.PollChanges(pBlackBoard);
+	return m_CurrentState;
+}
+#pragma endregion
+//-----------------------------------------------------------------
+// BEHAVIOR TREE (BASE)
+//-----------------------------------------------------------------
+BehaviorTree::BehaviorTree(Blackboard* pBlackBoard, IBehavior* pRootBehavior)
+	: m_pBlackBoard(pBlackBoard), m_pRootBehavior(pRootBehavior)
+{
+}
+
+BehaviorTree::BehaviorTree(Blackboard* pBlackBoard, IBehavior* pRootBehavior, std::unique_ptr<BehaviorArena> pArena)
+	: m_pBlackBoard(pBlackBoard), m_pRootBehavior(pRootBehavior), m_pArena(std::move(pArena))
+{
+}
+
+BehaviorTree::~BehaviorTree()
+{
+	m_pFlatTree.reset();
+	if (m_pArena)
+		m_pArena.reset();
+	else
+		SAFE_DELETE(m_pRootBehavior);
+}
+
+void BehaviorTree::Update(float deltaTime)
+{
+	if (m_pRootBehavior == nullptr)
+	{
+		m_CurrentState = BehaviorState::Failure;
+		return;
+	}
+
+	++m_Context.Tick;
+	m_Context.DeltaTime = deltaTime;
+	m_Context.Time += deltaTime;
+	if (m_pConditionMemo)
+		m_pConditionMemo->BeginTick();
+
+	BehaviorTreeContext::Scope contextScope{ &m_Context };
+	if (m_pFlatTree)
+	{
+		// Only the flat tree has the node indices a recording is made of
+		if (m_Context.pTraceRecorder)
+			m_Context.pTraceRecorder->BeginTick(m_Context, m_pBlackBoard, *m_pFlatTree);
+		m_CurrentState = m_pFlatTree->Execute(m_pBlackBoard);
+		if (m_Context.pTraceRecorder)
+			m_Context.pTraceRecorder->EndTick(m_CurrentState);
+	}
+	else
+	{
+		m_CurrentState = m_pRootBehavior->Execute(m_pBlackBoard);
+	}
+}
+
+void BehaviorTree::Compile()
+{
+	m_pFlatTree = std::make_unique<FlatBehaviorTree>(m_pRootBehavior);
+}
+
+void BehaviorTree::Decompile()
+{
+	m_pFlatTree.reset();
+}
+
+void BehaviorTree::EnableConditionMemo()
+{
+	if (!m_pConditionMemo)
+		m_pConditionMemo = std::make_unique<BehaviorConditionMemo>();
+	m_Context.pConditionMemo = m_pConditionMemo.get();
+}
+
+void BehaviorTree::Reset()
+{
+	if (m_pRootBehavior)
+		m_pRootBehavior->Reset();
+	if (m_pFlatTree)
+		m_pFlatTree->Reset();
+}
+
+void BehaviorTree::SetRootBehavior(IBehavior* pRootBehavior)
+{
+	assert(m_pArena && "The old root would leak, only the arena keeps it alive");
+	Reset();
+	m_pRootBehavior = pRootBehavior;
+	if (m_pFlatTree)
+		Compile();
+}
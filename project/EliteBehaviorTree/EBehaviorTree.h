@@ -10,6 +10,8 @@
 //--- Includes ---
 #include "../EliteData/EBlackboard.h"
 #include "EDecisionMaking.h"
+#include "EBehaviorTreeProfiler.h"
+#include "../EliteThreading/EJobSystem.h"
 
 namespace Elite
 {
@@ -23,6 +25,41 @@ namespace Elite
 		Running
 	};
 
+	class BehaviorConditionMemo;
+	class BehaviorTraceRecorder;
+
+	// State of the tree that is being ticked, reachable from the behaviors while BehaviorTree::Update runs
+	struct BehaviorTreeContext
+	{
+		uint32_t Tick = 0;
+		float Time = 0.f; // Sum of the delta times passed to Update
+		float DeltaTime = 0.f;
+		BehaviorConditionMemo* pConditionMemo = nullptr;
+		BehaviorTraceRecorder* pTraceRecorder = nullptr;
+
+		// nullptr when a behavior is executed outside of BehaviorTree::Update
+		static BehaviorTreeContext* GetCurrent() { return s_pCurrent; }
+
+		// Makes a context current on this thread until the scope ends
+		class Scope final
+		{
+		public:
+			explicit Scope(BehaviorTreeContext* pContext) : m_pPrevious(s_pCurrent) { s_pCurrent = pContext; }
+			~Scope() { s_pCurrent = m_pPrevious; }
+
+			Scope(const Scope& other) = delete;
+			Scope& operator=(const Scope& other) = delete;
+			Scope(Scope&& other) = delete;
+			Scope& operator=(Scope&& other) = delete;
+
+		private:
+			BehaviorTreeContext* m_pPrevious;
+		};
+
+	private:
+		static thread_local BehaviorTreeContext* s_pCurrent;
+	};
+
 	//-----------------------------------------------------------------
 	// BEHAVIOR INTERFACES (BASE)
 	//-----------------------------------------------------------------
@@ -31,35 +68,98 @@ namespace Elite
 	public:
 		IBehavior() = default;
 		virtual ~IBehavior() = default;
-		virtual BehaviorState Execute(Blackboard* pBlackBoard) = 0;
+
+		// Not virtual on purpose, every node runs through here so it can be instrumented.
+		// Behaviors implement OnExecute instead.
+		BehaviorState Execute(Blackboard* pBlackBoard);
+		// Drops any state kept between ticks, called when a running behavior gets interrupted
+		virtual void Reset() {}
+
+		// Shown by the profiler, defaults to the type of the behavior
+		const char* GetName() const { return m_pName ? m_pName : GetTypeName(); }
+		void SetName(const char* pName) { m_pName = pName; }
+
+		// Only reads the blackboard and keeps no state outside of its own subtree (pure conditions, scoring).
+		// A BehaviorParallel may then execute it on another thread.
+		bool IsSideEffectFree() const { return m_IsSideEffectFree; }
+		void SetSideEffectFree(bool isSideEffectFree) { m_IsSideEffectFree = isSideEffectFree; }
 
 	protected:
 		BehaviorState m_CurrentState = BehaviorState::Failure;
+
+		virtual BehaviorState OnExecute(Blackboard* pBlackBoard) = 0;
+		virtual const char* GetTypeName() const { return "Behavior"; }
+
+	private:
+		bool m_IsSideEffectFree = false;
+		const char* m_pName = nullptr;
+	};
+
+	// Non-owning view on the children of a composite, either an owned vector or an array in a BehaviorArena
+	class BehaviorSpan final
+	{
+	public:
+		BehaviorSpan() = default;
+		BehaviorSpan(IBehavior* const* pData, size_t size) : m_pData(pData), m_Size(size) {}
+
+		IBehavior* const* begin() const { return m_pData; }
+		IBehavior* const* end() const { return m_pData + m_Size; }
+		IBehavior* operator[](size_t index) const { return m_pData[index]; }
+		size_t size() const { return m_Size; }
+		bool empty() const { return m_Size == 0; }
+
+	private:
+		IBehavior* const* m_pData = nullptr;
+		size_t m_Size = 0;
 	};
 
+	inline BehaviorState IBehavior::Execute(Blackboard* pBlackBoard)
+	{
+#if ELITE_BT_PROFILING
+		BehaviorTreeProfiler::Scope scope{ this };
+		return scope.Exit(OnExecute(pBlackBoard));
+#else
+		return OnExecute(pBlackBoard);
+#endif
+	}
+
 	//-----------------------------------------------------------------
 	// BEHAVIOR TREE COMPOSITES (IBehavior)
 	//-----------------------------------------------------------------
 #pragma region COMPOSITES
 	//--- COMPOSITE BASE ---
+	// Composites built from a vector own their children, the ones built from a span (see BehaviorTreeBuilder)
+	// leave them to the arena they were allocated in.
 	class BehaviorComposite : public IBehavior
 	{
 	public:
 		explicit BehaviorComposite(std::vector<IBehavior*> childBehaviors)
-		{
-			m_ChildBehaviors = childBehaviors;
-		}
+			: m_OwnedBehaviors(std::move(childBehaviors)),
+			m_ChildBehaviors(m_OwnedBehaviors.data(), m_OwnedBehaviors.size()) {}
+		explicit BehaviorComposite(BehaviorSpan childBehaviors)
+			: m_ChildBehaviors(childBehaviors) {}
 		virtual ~BehaviorComposite()
 		{
-			for (auto pb : m_ChildBehaviors)
+			for (auto pb : m_OwnedBehaviors)
 				SAFE_DELETE(pb);
-			m_ChildBehaviors.clear();
+			m_OwnedBehaviors.clear();
+		}
+
+		virtual void Reset() override
+		{
+			for (IBehavior* pChild : m_ChildBehaviors)
+				pChild->Reset();
 		}
 
-		virtual BehaviorState Execute(Blackboard* pBlackBoard) override = 0;
+		BehaviorSpan GetChildBehaviors() const { return m_ChildBehaviors; }
+
+	private:
+		std::vector<IBehavior*> m_OwnedBehaviors = {};
 
 	protected:
-		std::vector<IBehavior*> m_ChildBehaviors = {};
+		BehaviorSpan m_ChildBehaviors = {};
+
+		virtual BehaviorState OnExecute(Blackboard* pBlackBoard) override = 0;
 	};
 
 	//--- SELECTOR ---
@@ -67,10 +167,14 @@ namespace Elite
 	{
 	public:
 		explicit BehaviorSelector(std::vector<IBehavior*> childBehaviors) :
+			BehaviorComposite(std::move(childBehaviors)) {}
+		explicit BehaviorSelector(BehaviorSpan childBehaviors) :
 			BehaviorComposite(childBehaviors) {}
 		virtual ~BehaviorSelector() = default;
 
-		virtual BehaviorState Execute(Blackboard* pBlackBoard) override;
+	protected:
+		virtual const char* GetTypeName() const override { return "Selector"; }
+		virtual BehaviorState OnExecute(Blackboard* pBlackBoard) override;
 	};
 
 	//--- SEQUENCE ---
@@ -78,10 +182,14 @@ namespace Elite
 	{
 	public:
 		explicit BehaviorSequence(std::vector<IBehavior*> childBehaviors) :
+			BehaviorComposite(std::move(childBehaviors)) {}
+		explicit BehaviorSequence(BehaviorSpan childBehaviors) :
 			BehaviorComposite(childBehaviors) {}
 		virtual ~BehaviorSequence() = default;
 
-		virtual BehaviorState Execute(Blackboard* pBlackBoard) override;
+	protected:
+		virtual const char* GetTypeName() const override { return "Sequence"; }
+		virtual BehaviorState OnExecute(Blackboard* pBlackBoard) override;
 	};
 
 	//--- PARTIAL SEQUENCE ---
@@ -89,14 +197,194 @@ namespace Elite
 	{
 	public:
 		explicit BehaviorPartialSequence(std::vector<IBehavior*> childBehaviors)
+			: BehaviorSequence(std::move(childBehaviors)) {}
+		explicit BehaviorPartialSequence(BehaviorSpan childBehaviors)
 			: BehaviorSequence(childBehaviors) {}
 		virtual ~BehaviorPartialSequence() = default;
 
-		virtual BehaviorState Execute(Blackboard* pBlackBoard) override;
+		virtual void Reset() override
+		{
+			m_CurrentBehaviorIndex = 0;
+			BehaviorSequence::Reset();
+		}
+
+	protected:
+		virtual const char* GetTypeName() const override { return "PartialSequence"; }
+		virtual BehaviorState OnExecute(Blackboard* pBlackBoard) override;
 
 	private:
 		unsigned int m_CurrentBehaviorIndex = 0;
 	};
+
+	//--- MEMORY COMPOSITE BASE ---
+	// Remembers the child that returned Running and resumes from it on the next tick instead of from child 0.
+	// While a child is running only the interrupt guards are re-checked: when one of them succeeds, the running
+	// child is reset and the composite is evaluated from its first child again.
+	class BehaviorMemoryComposite : public BehaviorComposite
+	{
+	public:
+		BehaviorMemoryComposite(std::vector<IBehavior*> childBehaviors, std::vector<IBehavior*> interruptGuards)
+			: BehaviorComposite(std::move(childBehaviors)), m_OwnedGuards(std::move(interruptGuards)),
+			m_InterruptGuards(m_OwnedGuards.data(), m_OwnedGuards.size()) {}
+		BehaviorMemoryComposite(BehaviorSpan childBehaviors, BehaviorSpan interruptGuards)
+			: BehaviorComposite(childBehaviors), m_InterruptGuards(interruptGuards) {}
+		virtual ~BehaviorMemoryComposite()
+		{
+			for (auto pb : m_OwnedGuards)
+				SAFE_DELETE(pb);
+			m_OwnedGuards.clear();
+		}
+
+		virtual void Reset() override
+		{
+			m_RunningChildIndex = -1;
+			BehaviorComposite::Reset();
+		}
+
+		BehaviorSpan GetInterruptGuards() const { return m_InterruptGuards; }
+
+	private:
+		std::vector<IBehavior*> m_OwnedGuards = {};
+
+	protected:
+		BehaviorSpan m_InterruptGuards = {};
+		int m_RunningChildIndex = -1;
+
+		virtual BehaviorState OnExecute(Blackboard* pBlackBoard) override = 0;
+
+		// Index of the child to start from this tick, consumes the memory
+		unsigned int ResumeIndex(Blackboard* pBlackBoard);
+	};
+
+	//--- MEMORY SELECTOR ---
+	class BehaviorMemorySelector : public BehaviorMemoryComposite
+	{
+	public:
+		explicit BehaviorMemorySelector(std::vector<IBehavior*> childBehaviors, std::vector<IBehavior*> interruptGuards = {})
+			: BehaviorMemoryComposite(std::move(childBehaviors), std::move(interruptGuards)) {}
+		BehaviorMemorySelector(BehaviorSpan childBehaviors, BehaviorSpan interruptGuards)
+			: BehaviorMemoryComposite(childBehaviors, interruptGuards) {}
+		virtual ~BehaviorMemorySelector() = default;
+
+	protected:
+		virtual const char* GetTypeName() const override { return "MemorySelector"; }
+		virtual BehaviorState OnExecute(Blackboard* pBlackBoard) override;
+	};
+
+	//--- MEMORY SEQUENCE ---
+	class BehaviorMemorySequence : public BehaviorMemoryComposite
+	{
+	public:
+		explicit BehaviorMemorySequence(std::vector<IBehavior*> childBehaviors, std::vector<IBehavior*> interruptGuards = {})
+			: BehaviorMemoryComposite(std::move(childBehaviors), std::move(interruptGuards)) {}
+		BehaviorMemorySequence(BehaviorSpan childBehaviors, BehaviorSpan interruptGuards)
+			: BehaviorMemoryComposite(childBehaviors, interruptGuards) {}
+		virtual ~BehaviorMemorySequence() = default;
+
+	protected:
+		virtual const char* GetTypeName() const override { return "MemorySequence"; }
+		virtual BehaviorState OnExecute(Blackboard* pBlackBoard) override;
+	};
+
+	//--- PARALLEL ---
+	// Ticks every child each tick. The failure policy is checked before the success policy,
+	// when neither is met the parallel is Running. Children that are still running when it finishes are reset.
+	enum class BehaviorParallelPolicy
+	{
+		RequireOne,
+		RequireAll
+	};
+
+	// With a JobSystem the side-effect-free children run on its workers and are joined within the tick,
+	// the others run on the calling thread after the join, so nothing writes the blackboard while the
+	// workers read it. The workers see a copy of the tree context without
+	// the condition memo. Everything runs on the calling thread while the blackboard records reads
+	// or is profiled, and in ELITE_BT_PROFILING builds.
+	class BehaviorParallel final : public BehaviorComposite
+	{
+	public:
+		explicit BehaviorParallel(std::vector<IBehavior*> childBehaviors,
+			BehaviorParallelPolicy successPolicy = BehaviorParallelPolicy::RequireAll,
+			BehaviorParallelPolicy failurePolicy = BehaviorParallelPolicy::RequireOne,
+			JobSystem* pJobSystem = nullptr)
+			: BehaviorComposite(std::move(childBehaviors)), m_SuccessPolicy(successPolicy), m_FailurePolicy(failurePolicy),
+			m_pJobSystem(pJobSystem), m_ChildJobs(m_ChildBehaviors.size()) {}
+		BehaviorParallel(BehaviorSpan childBehaviors, BehaviorParallelPolicy successPolicy, BehaviorParallelPolicy failurePolicy,
+			JobSystem* pJobSystem = nullptr)
+			: BehaviorComposite(childBehaviors), m_SuccessPolicy(successPolicy), m_FailurePolicy(failurePolicy),
+			m_pJobSystem(pJobSystem), m_ChildJobs(m_ChildBehaviors.size()) {}
+		virtual ~BehaviorParallel() = default;
+
+		void SetJobSystem(JobSystem* pJobSystem) { m_pJobSystem = pJobSystem; }
+
+	protected:
+		virtual const char* GetTypeName() const override { return "Parallel"; }
+		virtual BehaviorState OnExecute(Blackboard* pBlackBoard) override;
+
+	private:
+		struct ChildJob
+		{
+			IBehavior* pBehavior = nullptr;
+			Blackboard* pBlackBoard = nullptr;
+			BehaviorTreeContext Context = {};
+			bool HasContext = false;
+			BehaviorState State = BehaviorState::Failure;
+		};
+
+		BehaviorParallelPolicy m_SuccessPolicy = BehaviorParallelPolicy::RequireAll;
+		BehaviorParallelPolicy m_FailurePolicy = BehaviorParallelPolicy::RequireOne;
+		JobSystem* m_pJobSystem = nullptr;
+
+		std::vector<ChildJob> m_ChildJobs = {};
+		JobCounter m_JobCounter = {};
+
+		static void ExecuteChildJob(void* pData);
+	};
+
+	//--- UTILITY SELECTOR ---
+	// Calls the score function of every child one after the other (not vectorized, there are only a few children)
+	// and runs them from the highest score down like a selector, a child with a score of 0 or less is not considered.
+	// The child that ran last stays first until another one scores more than the hysteresis above it, so close scores
+	// do not flip-flop.
+	class BehaviorUtilitySelector final : public BehaviorComposite
+	{
+	public:
+		using ScoreFunction = std::function<float(Blackboard*)>;
+		static constexpr float DefaultHysteresis{ 0.1f };
+
+		BehaviorUtilitySelector(std::vector<IBehavior*> childBehaviors, std::vector<ScoreFunction> scoreFunctions,
+			float hysteresis = DefaultHysteresis)
+			: BehaviorComposite(std::move(childBehaviors)), m_ScoreFunctions(std::move(scoreFunctions)), m_Hysteresis(hysteresis),
+			m_Scores(m_ChildBehaviors.size(), 0.f), m_Order(m_ChildBehaviors.size(), 0) {}
+		BehaviorUtilitySelector(BehaviorSpan childBehaviors, std::vector<ScoreFunction> scoreFunctions,
+			float hysteresis = DefaultHysteresis)
+			: BehaviorComposite(childBehaviors), m_ScoreFunctions(std::move(scoreFunctions)), m_Hysteresis(hysteresis),
+			m_Scores(m_ChildBehaviors.size(), 0.f), m_Order(m_ChildBehaviors.size(), 0) {}
+		virtual ~BehaviorUtilitySelector() = default;
+
+		virtual void Reset() override
+		{
+			m_SelectedIndex = -1;
+			BehaviorComposite::Reset();
+		}
+
+		// Scores of the last tick in the order of the children, for debugging
+		const std::vector<float>& GetScores() const { return m_Scores; }
+		// Child that succeeded or is running, -1 when all of them failed
+		int GetSelectedIndex() const { return m_SelectedIndex; }
+
+	protected:
+		virtual const char* GetTypeName() const override { return "UtilitySelector"; }
+		virtual BehaviorState OnExecute(Blackboard* pBlackBoard) override;
+
+	private:
+		std::vector<ScoreFunction> m_ScoreFunctions = {};
+		float m_Hysteresis = DefaultHysteresis;
+
+		std::vector<float> m_Scores = {};
+		std::vector<unsigned int> m_Order = {};
+		int m_SelectedIndex = -1;
+	};
 #pragma endregion
 
 	//-----------------------------------------------------------------
@@ -106,10 +394,26 @@ namespace Elite
 	{
 	public:
 		explicit BehaviorConditional(std::function<bool(Blackboard*)> fp) : m_fpConditional(fp) {}
-		virtual BehaviorState Execute(Blackboard* pBlackBoard) override;
+		// Only for conditions that read nothing but the given keys: the result is cached
+		// and the condition is re-evaluated only when one of the keys changed
+		BehaviorConditional(std::function<bool(Blackboard*)> fp, std::initializer_list<BlackboardKeyBase> dependencies)
+			: m_fpConditional(fp), m_Dependencies(dependencies) {}
+
+		const std::function<bool(Blackboard*)>& GetConditional() const { return m_fpConditional; }
+		const BlackboardSubscription& GetDependencies() const { return m_Dependencies; }
+
+	protected:
+		virtual const char* GetTypeName() const override { return "Conditional"; }
+		virtual BehaviorState OnExecute(Blackboard* pBlackBoard) override;
 
 	private:
 		std::function<bool(Blackboard*)> m_fpConditional = nullptr;
+		BlackboardSubscription m_Dependencies = {};
+
+		// Slot of the condition in the memo of the tree it last ran in
+		static constexpr unsigned int NoMemoSlot{ ~0u };
+		const BehaviorConditionMemo* m_pMemo = nullptr;
+		unsigned int m_MemoSlot = NoMemoSlot;
 	};
 
 	//-----------------------------------------------------------------
@@ -119,44 +423,274 @@ namespace Elite
 	{
 	public:
 		explicit BehaviorAction(std::function<BehaviorState(Blackboard*)> fp) : m_fpAction(fp) {}
-		virtual BehaviorState Execute(Blackboard* pBlackBoard) override;
+
+		const std::function<BehaviorState(Blackboard*)>& GetAction() const { return m_fpAction; }
+
+	protected:
+		virtual const char* GetTypeName() const override { return "Action"; }
+		virtual BehaviorState OnExecute(Blackboard* pBlackBoard) override;
 
 	private:
 		std::function<BehaviorState(Blackboard*)> m_fpAction = nullptr;
 	};
 
 	//-----------------------------------------------------------------
-	// BEHAVIOR TREE (BASE)
+	// BEHAVIOR TREE DECORATORS (IBehavior)
 	//-----------------------------------------------------------------
-	class BehaviorTree final : public Elite::IDecisionMaking
+#pragma region DECORATORS
+	//--- DECORATOR BASE ---
+	// Same ownership as the composites: a decorator built from a pointer owns its child,
+	// one built from a span (see BehaviorTreeBuilder) leaves it to the arena.
+	class BehaviorDecorator : public IBehavior
 	{
 	public:
-		explicit BehaviorTree(Blackboard* pBlackBoard, IBehavior* pRootBehavior)
-			: m_pBlackBoard(pBlackBoard), m_pRootBehavior(pRootBehavior) {};
-		~BehaviorTree()
+		explicit BehaviorDecorator(IBehavior* pChildBehavior)
+			: m_pOwnedBehavior(pChildBehavior), m_pChildBehavior(pChildBehavior) {}
+		explicit BehaviorDecorator(BehaviorSpan childBehavior)
+			: m_pChildBehavior(childBehavior.empty() ? nullptr : childBehavior[0]) {}
+		virtual ~BehaviorDecorator()
 		{
-			SAFE_DELETE(m_pRootBehavior);
-		};
+			SAFE_DELETE(m_pOwnedBehavior);
+		}
 
-		virtual void Update(float deltaTime) override
+		virtual void Reset() override
 		{
-			if (m_pRootBehavior == nullptr)
-			{
-				m_CurrentState = BehaviorState::Failure;
-				return;
-			}
+			if (m_pChildBehavior)
+				m_pChildBehavior->Reset();
+		}
+
+		IBehavior* GetChildBehavior() const { return m_pChildBehavior; }
+
+	private:
+		IBehavior* m_pOwnedBehavior = nullptr;
+
+	protected:
+		IBehavior* m_pChildBehavior = nullptr;
+	};
+
+	//--- TICK RATE ---
+	// Runs the child at most frequency times per second of tree time and returns its last state in between.
+	// With a budget (seconds of real time per second of tree time) the interval also stretches to
+	// cost / budget after an expensive evaluation, which caps the average cost of the subtree.
+	// The last state only stands while the decorator is ticked every tick and none of the keys changed since the child
+	// ran (its own writes do not count): after a tick without it, or when another branch wrote one of the keys (e.g. the
+	// target the child picked), the child runs again.
+	// Outside of BehaviorTree::Update there is no tree time, the child then runs every tick.
+	struct BehaviorTickRateStats
+	{
+		unsigned int Evaluations = 0;
+		unsigned int Skips = 0;
+		double TotalSeconds = 0.0;
+		double MaxSeconds = 0.0;
+	};
+
+	class BehaviorTickRate final : public BehaviorDecorator
+	{
+	public:
+		BehaviorTickRate(IBehavior* pChildBehavior, float frequency, float budget = 0.f)
+			: BehaviorDecorator(pChildBehavior), m_Interval(frequency > 0.f ? 1.f / frequency : 0.f), m_Budget(budget) {}
+		BehaviorTickRate(IBehavior* pChildBehavior, float frequency, std::initializer_list<BlackboardKeyBase> keys, float budget = 0.f)
+			: BehaviorDecorator(pChildBehavior), m_Interval(frequency > 0.f ? 1.f / frequency : 0.f), m_Budget(budget), m_Keys(keys) {}
+		BehaviorTickRate(BehaviorSpan childBehavior, float frequency, float budget = 0.f)
+			: BehaviorDecorator(childBehavior), m_Interval(frequency > 0.f ? 1.f / frequency : 0.f), m_Budget(budget) {}
+		BehaviorTickRate(BehaviorSpan childBehavior, float frequency, std::initializer_list<BlackboardKeyBase> keys, float budget = 0.f)
+			: BehaviorDecorator(childBehavior), m_Interval(frequency > 0.f ? 1.f / frequency : 0.f), m_Budget(budget), m_Keys(keys) {}
+		virtual ~BehaviorTickRate() = default;
 
-			m_CurrentState = m_pRootBehavior->Execute(m_pBlackBoard);
+		// The next tick evaluates the child again
+		virtual void Reset() override
+		{
+			m_HasState = false;
+			BehaviorDecorator::Reset();
 		}
+
+		const BehaviorTickRateStats& GetStats() const { return m_Stats; }
+		void PrintReport() const;
+
+	protected:
+		virtual const char* GetTypeName() const override { return "TickRate"; }
+		virtual BehaviorState OnExecute(Blackboard* pBlackBoard) override;
+
+	private:
+		float m_Interval = 0.f;
+		float m_Budget = 0.f;
+		float m_NextEvaluationTime = 0.f;
+		BlackboardSubscription m_Keys = {};
+		uint32_t m_LastTick = 0;
+		bool m_HasState = false;
+		BehaviorTickRateStats m_Stats = {};
+	};
+
+	// The time based decorators below take their time from BehaviorTreeContext.
+	// Outside of BehaviorTree::Update they let every tick through to the child.
+
+	//--- COOLDOWN ---
+	// After the child succeeds it is blocked for duration seconds, the decorator fails in the meantime
+	class BehaviorCooldown final : public BehaviorDecorator
+	{
+	public:
+		BehaviorCooldown(IBehavior* pChildBehavior, float duration)
+			: BehaviorDecorator(pChildBehavior), m_Duration(duration) {}
+		BehaviorCooldown(BehaviorSpan childBehavior, float duration)
+			: BehaviorDecorator(childBehavior), m_Duration(duration) {}
+		virtual ~BehaviorCooldown() = default;
+
+	protected:
+		virtual const char* GetTypeName() const override { return "Cooldown"; }
+		virtual BehaviorState OnExecute(Blackboard* pBlackBoard) override;
+
+	private:
+		float m_Duration = 0.f;
+		float m_ReadyTime = 0.f;
+	};
+
+	//--- TIMEOUT ---
+	// Fails and resets the child once it has been running for longer than duration seconds.
+	// A child that was not ticked on the previous tick starts a new run.
+	class BehaviorTimeout final : public BehaviorDecorator
+	{
+	public:
+		BehaviorTimeout(IBehavior* pChildBehavior, float duration)
+			: BehaviorDecorator(pChildBehavior), m_Duration(duration) {}
+		BehaviorTimeout(BehaviorSpan childBehavior, float duration)
+			: BehaviorDecorator(childBehavior), m_Duration(duration) {}
+		virtual ~BehaviorTimeout() = default;
+
+		virtual void Reset() override
+		{
+			m_IsRunning = false;
+			BehaviorDecorator::Reset();
+		}
+
+	protected:
+		virtual const char* GetTypeName() const override { return "Timeout"; }
+		virtual BehaviorState OnExecute(Blackboard* pBlackBoard) override;
+
+	private:
+		float m_Duration = 0.f;
+		float m_StartTime = 0.f;
+		uint32_t m_LastTick = 0;
+		bool m_IsRunning = false;
+	};
+
+	//--- RATE LIMIT ---
+	// Lets the child run at most count times per period seconds, bursts included (token bucket), e.g.
+	// RateLimit(retarget, 1, 0.25f) re-targets at most every 250 ms. Over the limit the child does not run: a child
+	// that was running stays Running, otherwise the decorator fails, since a Success would claim effects (like a new
+	// target) that were not applied again. The limit only holds while the decorator is ticked every tick, after a
+	// tick without it the child always runs, whatever other branches did in between.
+	class BehaviorRateLimit final : public BehaviorDecorator
+	{
+	public:
+		BehaviorRateLimit(IBehavior* pChildBehavior, unsigned int count, float period)
+			: BehaviorDecorator(pChildBehavior), m_Count(static_cast<float>(count)), m_Period(period), m_Tokens(static_cast<float>(count)) {}
+		BehaviorRateLimit(BehaviorSpan childBehavior, unsigned int count, float period)
+			: BehaviorDecorator(childBehavior), m_Count(static_cast<float>(count)), m_Period(period), m_Tokens(static_cast<float>(count)) {}
+		virtual ~BehaviorRateLimit() = default;
+
+		// The next tick runs the child
+		virtual void Reset() override
+		{
+			m_WasTicked = false;
+			BehaviorDecorator::Reset();
+		}
+
+	protected:
+		virtual const char* GetTypeName() const override { return "RateLimit"; }
+		virtual BehaviorState OnExecute(Blackboard* pBlackBoard) override;
+
+	private:
+		float m_Count = 0.f;
+		float m_Period = 0.f;
+		float m_Tokens = 0.f;
+		float m_LastRefillTime = 0.f;
+		uint32_t m_LastTick = 0;
+		bool m_WasTicked = false;
+	};
+
+	//--- RUN ONCE UNTIL KEY CHANGES ---
+	// Runs the child to completion once and then returns that result until one of the keys changes.
+	// Changes the child makes to the keys itself do not count.
+	class BehaviorRunOnceUntilKeyChanges final : public BehaviorDecorator
+	{
+	public:
+		BehaviorRunOnceUntilKeyChanges(IBehavior* pChildBehavior, std::initializer_list<BlackboardKeyBase> keys)
+			: BehaviorDecorator(pChildBehavior), m_Keys(keys) {}
+		BehaviorRunOnceUntilKeyChanges(BehaviorSpan childBehavior, std::initializer_list<BlackboardKeyBase> keys)
+			: BehaviorDecorator(childBehavior), m_Keys(keys) {}
+		virtual ~BehaviorRunOnceUntilKeyChanges() = default;
+
+		virtual void Reset() override
+		{
+			m_Keys.Invalidate();
+			m_IsRunning = false;
+			BehaviorDecorator::Reset();
+		}
+
+	protected:
+		virtual const char* GetTypeName() const override { return "RunOnceUntilKeyChanges"; }
+		virtual BehaviorState OnExecute(Blackboard* pBlackBoard) override;
+
+	private:
+		BlackboardSubscription m_Keys = {};
+		bool m_IsRunning = false;
+	};
+#pragma endregion
+
+	//-----------------------------------------------------------------
+	// BEHAVIOR TREE (BASE)
+	//-----------------------------------------------------------------
+	class FlatBehaviorTree;
+	class BehaviorArena;
+
+	class BehaviorTree final : public Elite::IDecisionMaking
+	{
+	public:
+		// Takes ownership of the root behavior, which deletes its children
+		explicit BehaviorTree(Blackboard* pBlackBoard, IBehavior* pRootBehavior);
+		// The nodes live in the arena and are destroyed with it, see BehaviorTreeBuilder::Build
+		BehaviorTree(Blackboard* pBlackBoard, IBehavior* pRootBehavior, std::unique_ptr<BehaviorArena> pArena);
+		~BehaviorTree();
+
+		virtual void Update(float deltaTime) override;
 		Blackboard* GetBlackboard() const
 		{
 			return m_pBlackBoard;
 		}
 
+		// Lowers the tree to a FlatBehaviorTree, Update executes the flat version from then on.
+		// The IBehavior tree stays the owner of the nodes, so it must not be changed afterwards.
+		void Compile();
+		void Decompile();
+		bool IsCompiled() const { return m_pFlatTree != nullptr; }
+
+		// Drops the memory of every running behavior, the next Update evaluates the tree from the root
+		void Reset();
+
+		// Only for a tree built in an arena, which keeps the old root alive. Resets the tree and compiles the
+		// new root when the old one was compiled.
+		void SetRootBehavior(IBehavior* pRootBehavior);
+
+		// Conditions without dependencies are evaluated at most once per tick while none of the keys they
+		// read changes, see BehaviorConditionMemo
+		void EnableConditionMemo();
+		const BehaviorConditionMemo* GetConditionMemo() const { return m_pConditionMemo.get(); }
+
+		// Records every tick of the compiled tree, the tree does not own the recorder. Pass nullptr to stop recording.
+		void SetTraceRecorder(BehaviorTraceRecorder* pRecorder) { m_Context.pTraceRecorder = pRecorder; }
+		FlatBehaviorTree* GetFlatTree() const { return m_pFlatTree.get(); }
+
+		const BehaviorTreeContext& GetContext() const { return m_Context; }
+
 	private:
 		BehaviorState m_CurrentState = BehaviorState::Failure;
 		Blackboard* m_pBlackBoard = nullptr;
 		IBehavior* m_pRootBehavior = nullptr;
+		std::unique_ptr<FlatBehaviorTree> m_pFlatTree;
+		std::unique_ptr<BehaviorArena> m_pArena;
+
+		BehaviorTreeContext m_Context = {};
+		std::unique_ptr<BehaviorConditionMemo> m_pConditionMemo;
 	};
 }
 #endif
\ No newline at end of file
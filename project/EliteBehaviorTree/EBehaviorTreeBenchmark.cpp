@@ -0,0 +1,47 @@
+//=== General Includes ===
+#include "stdafx.h"
+#include "EBehaviorTreeBenchmark.h"
+using namespace Elite;
+
+void BehaviorTreeBenchmark::AddTree(const std::string& name, BehaviorTree* pTree)
+{
+	if (pTree)
+		m_Entries.push_back(Entry{ name, pTree, 0, 0.0 });
+}
+
+void BehaviorTreeBenchmark::Update(float deltaTime)
+{
+	if (m_Entries.empty())
+		return;
+
+	// Hand over to the next tree, which continues from a clean state
+	if (m_FrameInRun == m_FramesPerRun)
+	{
+		m_FrameInRun = 0;
+		m_ActiveEntry = (m_ActiveEntry + 1) % m_Entries.size();
+		m_Entries[m_ActiveEntry].pTree->Reset();
+	}
+
+	Entry& entry = m_Entries[m_ActiveEntry];
+	const auto start = std::chrono::high_resolution_clock::now();
+	entry.pTree->Update(deltaTime);
+	const auto end = std::chrono::high_resolution_clock::now();
+
+	entry.Seconds += std::chrono::duration<double>(end - start).count();
+	++entry.Ticks;
+	++m_FrameInRun;
+}
+
+void BehaviorTreeBenchmark::PrintReport() const
+{
+	printf("--- Behavior tree benchmark (%u frames per run) ---\n", m_FramesPerRun);
+	printf("%-20s %12s %14s %16s\n", "Tree", "Ticks", "Avg tick (us)", "Ticks / second");
+
+	for (const Entry& entry : m_Entries)
+	{
+		const double averageSeconds = entry.Ticks > 0 ? entry.Seconds / entry.Ticks : 0.0;
+		const double ticksPerSecond = entry.Seconds > 0.0 ? entry.Ticks / entry.Seconds : 0.0;
+		printf("%-20s %12llu %14.3f %16.0f\n", entry.Name.c_str(), static_cast<unsigned long long>(entry.Ticks),
+			averageSeconds * 1000000.0, ticksPerSecond);
+	}
+}
@@ -0,0 +1,52 @@
+/*=============================================================================*/
+// EBehaviorTreeBenchmark.h: Measures the tick cost of several implementations of the same behavior tree
+/*=============================================================================*/
+#ifndef ELITE_BEHAVIOR_TREE_BENCHMARK
+#define ELITE_BEHAVIOR_TREE_BENCHMARK
+
+//--- Includes ---
+#include "EBehaviorTree.h"
+
+#include <chrono>
+#include <cstdint>
+
+namespace Elite
+{
+	// The actions of a tree act on the game, so two trees can not be ticked on the same frame.
+	// Instead the trees take turns on the recorded (live) frames: each one runs framesPerRun frames in a row,
+	// starting from a reset state, and only the time spent in its Update is measured.
+	class BehaviorTreeBenchmark final
+	{
+	public:
+		explicit BehaviorTreeBenchmark(unsigned int framesPerRun = 120) : m_FramesPerRun(framesPerRun) {}
+		~BehaviorTreeBenchmark() = default;
+
+		BehaviorTreeBenchmark(const BehaviorTreeBenchmark& other) = delete;
+		BehaviorTreeBenchmark& operator=(const BehaviorTreeBenchmark& other) = delete;
+		BehaviorTreeBenchmark(BehaviorTreeBenchmark&& other) = delete;
+		BehaviorTreeBenchmark& operator=(BehaviorTreeBenchmark&& other) = delete;
+
+		// The trees are not owned by the benchmark
+		void AddTree(const std::string& name, BehaviorTree* pTree);
+
+		// Ticks the tree whose turn it is
+		void Update(float deltaTime);
+
+		void PrintReport() const;
+
+	private:
+		struct Entry
+		{
+			std::string Name;
+			BehaviorTree* pTree;
+			uint64_t Ticks;
+			double Seconds;
+		};
+
+		std::vector<Entry> m_Entries = {};
+		unsigned int m_FramesPerRun = 120;
+		unsigned int m_FrameInRun = 0;
+		size_t m_ActiveEntry = 0;
+	};
+}
+#endif
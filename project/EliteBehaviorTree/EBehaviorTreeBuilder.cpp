@@ -0,0 +1,160 @@
+//=== General Includes ===
+#include "stdafx.h"
+#include "EBehaviorTreeBuilder.h"
+
+#include <cstdint>
+using namespace Elite;
+
+constexpr size_t BehaviorArena::BlockSize;
+
+//-----------------------------------------------------------------
+// BEHAVIOR ARENA
+//-----------------------------------------------------------------
+BehaviorArena::~BehaviorArena()
+{
+	// Parents were created after their children, so they are destroyed first
+	for (auto it = m_Behaviors.rbegin(); it != m_Behaviors.rend(); ++it)
+		(*it)->~IBehavior();
+	m_Behaviors.clear();
+}
+
+void* BehaviorArena::Allocate(size_t size, size_t alignment)
+{
+	const size_t padding = (alignment - reinterpret_cast<uintptr_t>(m_pCurrent) % alignment) % alignment;
+	if (m_pCurrent == nullptr || padding + size > m_Remaining)
+	{
+		// Anything larger than a block gets a block of its own
+		const size_t blockSize = size + alignment > BlockSize ? size + alignment : BlockSize;
+		m_Blocks.push_back(std::unique_ptr<char[]>(new char[blockSize]));
+		m_pCurrent = m_Blocks.back().get();
+		m_Remaining = blockSize;
+		return Allocate(size, alignment);
+	}
+
+	void* pMemory = m_pCurrent + padding;
+	m_pCurrent += padding + size;
+	m_Remaining -= padding + size;
+	m_UsedBytes += size;
+	return pMemory;
+}
+
+BehaviorSpan BehaviorArena::CopyBehaviors(std::initializer_list<IBehavior*> behaviors)
+{
+	return CopyBehaviors(behaviors.begin(), behaviors.size());
+}
+
+BehaviorSpan BehaviorArena::CopyBehaviors(IBehavior* const* pBehaviors, size_t count)
+{
+	if (count == 0)
+		return BehaviorSpan{};
+
+	IBehavior** pData = static_cast<IBehavior**>(Allocate(sizeof(IBehavior*) * count, alignof(IBehavior*)));
+	std::copy(pBehaviors, pBehaviors + count, pData);
+	return BehaviorSpan{ pData, count };
+}
+
+//-----------------------------------------------------------------
+// BEHAVIOR TREE BUILDER
+//-----------------------------------------------------------------
+BehaviorTreeBuilder::BehaviorTreeBuilder()
+	: m_pArena(std::make_unique<BehaviorArena>())
+{
+}
+
+IBehavior* BehaviorTreeBuilder::Selector(std::initializer_list<IBehavior*> childBehaviors)
+{
+	return m_pArena->Create<BehaviorSelector>(m_pArena->CopyBehaviors(childBehaviors));
+}
+
+IBehavior* BehaviorTreeBuilder::Sequence(std::initializer_list<IBehavior*> childBehaviors)
+{
+	return m_pArena->Create<BehaviorSequence>(m_pArena->CopyBehaviors(childBehaviors));
+}
+
+IBehavior* BehaviorTreeBuilder::PartialSequence(std::initializer_list<IBehavior*> childBehaviors)
+{
+	return m_pArena->Create<BehaviorPartialSequence>(m_pArena->CopyBehaviors(childBehaviors));
+}
+
+IBehavior* BehaviorTreeBuilder::MemorySelector(std::initializer_list<IBehavior*> childBehaviors, std::initializer_list<IBehavior*> interruptGuards)
+{
+	return m_pArena->Create<BehaviorMemorySelector>(m_pArena->CopyBehaviors(childBehaviors), m_pArena->CopyBehaviors(interruptGuards));
+}
+
+IBehavior* BehaviorTreeBuilder::MemorySequence(std::initializer_list<IBehavior*> childBehaviors, std::initializer_list<IBehavior*> interruptGuards)
+{
+	return m_pArena->Create<BehaviorMemorySequence>(m_pArena->CopyBehaviors(childBehaviors), m_pArena->CopyBehaviors(interruptGuards));
+}
+
+IBehavior* BehaviorTreeBuilder::Parallel(std::initializer_list<IBehavior*> childBehaviors,
+	BehaviorParallelPolicy successPolicy, BehaviorParallelPolicy failurePolicy, JobSystem* pJobSystem)
+{
+	return m_pArena->Create<BehaviorParallel>(m_pArena->CopyBehaviors(childBehaviors), successPolicy, failurePolicy, pJobSystem);
+}
+
+BehaviorUtilitySelector* BehaviorTreeBuilder::UtilitySelector(std::initializer_list<std::pair<IBehavior*, BehaviorUtilitySelector::ScoreFunction>> options,
+	float hysteresis)
+{
+	std::vector<IBehavior*> childBehaviors{};
+	std::vector<BehaviorUtilitySelector::ScoreFunction> scoreFunctions{};
+	childBehaviors.reserve(options.size());
+	scoreFunctions.reserve(options.size());
+	for (const auto& option : options)
+	{
+		childBehaviors.push_back(option.first);
+		scoreFunctions.push_back(option.second);
+	}
+
+	return m_pArena->Create<BehaviorUtilitySelector>(m_pArena->CopyBehaviors(childBehaviors.data(), childBehaviors.size()),
+		std::move(scoreFunctions), hysteresis);
+}
+
+IBehavior* BehaviorTreeBuilder::Conditional(std::function<bool(Blackboard*)> fp)
+{
+	return m_pArena->Create<BehaviorConditional>(std::move(fp));
+}
+
+IBehavior* BehaviorTreeBuilder::Conditional(std::function<bool(Blackboard*)> fp, std::initializer_list<BlackboardKeyBase> dependencies)
+{
+	return m_pArena->Create<BehaviorConditional>(std::move(fp), dependencies);
+}
+
+IBehavior* BehaviorTreeBuilder::Action(std::function<BehaviorState(Blackboard*)> fp)
+{
+	return m_pArena->Create<BehaviorAction>(std::move(fp));
+}
+
+BehaviorTickRate* BehaviorTreeBuilder::TickRate(IBehavior* pChildBehavior, float frequency, float budget)
+{
+	return m_pArena->Create<BehaviorTickRate>(m_pArena->CopyBehaviors({ pChildBehavior }), frequency, budget);
+}
+
+BehaviorTickRate* BehaviorTreeBuilder::TickRate(IBehavior* pChildBehavior, float frequency, std::initializer_list<BlackboardKeyBase> keys, float budget)
+{
+	return m_pArena->Create<BehaviorTickRate>(m_pArena->CopyBehaviors({ pChildBehavior }), frequency, keys, budget);
+}
+
+IBehavior* BehaviorTreeBuilder::Cooldown(IBehavior* pChildBehavior, float duration)
+{
+	return m_pArena->Create<BehaviorCooldown>(m_pArena->CopyBehaviors({ pChildBehavior }), duration);
+}
+
+IBehavior* BehaviorTreeBuilder::Timeout(IBehavior* pChildBehavior, float duration)
+{
+	return m_pArena->Create<BehaviorTimeout>(m_pArena->CopyBehaviors({ pChildBehavior }), duration);
+}
+
+IBehavior* BehaviorTreeBuilder::RateLimit(IBehavior* pChildBehavior, unsigned int count, float period)
+{
+	return m_pArena->Create<BehaviorRateLimit>(m_pArena->CopyBehaviors({ pChildBehavior }), count, period);
+}
+
+IBehavior* BehaviorTreeBuilder::RunOnceUntilKeyChanges(IBehavior* pChildBehavior, std::initializer_list<BlackboardKeyBase> keys)
+{
+	return m_pArena->Create<BehaviorRunOnceUntilKeyChanges>(m_pArena->CopyBehaviors({ pChildBehavior }), keys);
+}
+
+std::unique_ptr<BehaviorTree> BehaviorTreeBuilder::Build(Blackboard* pBlackBoard, IBehavior* pRootBehavior)
+{
+	return std::make_unique<BehaviorTree>(pBlackBoard, pRootBehavior, std::move(m_pArena));
+}
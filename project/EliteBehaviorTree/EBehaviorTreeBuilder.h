@@ -0,0 +1,120 @@
+/*=============================================================================*/
+// EBehaviorTreeBuilder.h: Arena allocation of behavior tree nodes
+/*=============================================================================*/
+#ifndef ELITE_BEHAVIOR_TREE_BUILDER
+#define ELITE_BEHAVIOR_TREE_BUILDER
+
+//--- Includes ---
+#include "EBehaviorTree.h"
+
+#include <initializer_list>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Elite
+{
+	//-----------------------------------------------------------------
+	// BEHAVIOR ARENA
+	//-----------------------------------------------------------------
+	// Bump allocator for the nodes of one tree and the arrays of their children.
+	// Nothing is freed on its own: the nodes are destroyed and the blocks released together with the arena.
+	class BehaviorArena final
+	{
+	public:
+		static constexpr size_t BlockSize{ 16 * 1024 };
+
+		BehaviorArena() = default;
+		~BehaviorArena();
+
+		BehaviorArena(const BehaviorArena& other) = delete;
+		BehaviorArena& operator=(const BehaviorArena& other) = delete;
+		BehaviorArena(BehaviorArena&& other) = delete;
+		BehaviorArena& operator=(BehaviorArena&& other) = delete;
+
+		void* Allocate(size_t size, size_t alignment);
+
+		template<typename T, typename... Args>
+		T* Create(Args&&... args)
+		{
+			static_assert(std::is_base_of<IBehavior, T>::value, "The arena only holds behaviors");
+			T* pBehavior = new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+			m_Behaviors.push_back(pBehavior);
+			return pBehavior;
+		}
+
+		BehaviorSpan CopyBehaviors(std::initializer_list<IBehavior*> behaviors);
+		BehaviorSpan CopyBehaviors(IBehavior* const* pBehaviors, size_t count);
+
+		size_t GetUsedBytes() const { return m_UsedBytes; }
+		size_t GetBehaviorCount() const { return m_Behaviors.size(); }
+
+	private:
+		std::vector<std::unique_ptr<char[]>> m_Blocks{};
+		char* m_pCurrent{ nullptr };
+		size_t m_Remaining{ 0 };
+		size_t m_UsedBytes{ 0 };
+
+		// In creation order, destroyed in reverse
+		std::vector<IBehavior*> m_Behaviors{};
+	};
+
+	//-----------------------------------------------------------------
+	// BEHAVIOR TREE BUILDER
+	//-----------------------------------------------------------------
+	// Creates the nodes of a tree in a BehaviorArena, the composites get spans into the arena instead of vectors:
+	//	BehaviorTreeBuilder builder{};
+	//	IBehavior* pRoot = builder.Selector({ builder.Conditional(...), builder.Action(...) });
+	//	std::unique_ptr<BehaviorTree> pTree = builder.Build(pBlackboard, pRoot);
+	class BehaviorTreeBuilder final
+	{
+	public:
+		BehaviorTreeBuilder();
+		~BehaviorTreeBuilder() = default;
+
+		BehaviorTreeBuilder(const BehaviorTreeBuilder& other) = delete;
+		BehaviorTreeBuilder& operator=(const BehaviorTreeBuilder& other) = delete;
+		BehaviorTreeBuilder(BehaviorTreeBuilder&& other) = delete;
+		BehaviorTreeBuilder& operator=(BehaviorTreeBuilder&& other) = delete;
+
+		IBehavior* Selector(std::initializer_list<IBehavior*> childBehaviors);
+		IBehavior* Sequence(std::initializer_list<IBehavior*> childBehaviors);
+		IBehavior* PartialSequence(std::initializer_list<IBehavior*> childBehaviors);
+		IBehavior* MemorySelector(std::initializer_list<IBehavior*> childBehaviors, std::initializer_list<IBehavior*> interruptGuards = {});
+		IBehavior* MemorySequence(std::initializer_list<IBehavior*> childBehaviors, std::initializer_list<IBehavior*> interruptGuards = {});
+		IBehavior* Parallel(std::initializer_list<IBehavior*> childBehaviors,
+			BehaviorParallelPolicy successPolicy = BehaviorParallelPolicy::RequireAll,
+			BehaviorParallelPolicy failurePolicy = BehaviorParallelPolicy::RequireOne,
+			JobSystem* pJobSystem = nullptr);
+		// Each option is a child and the function that scores it
+		BehaviorUtilitySelector* UtilitySelector(std::initializer_list<std::pair<IBehavior*, BehaviorUtilitySelector::ScoreFunction>> options,
+			float hysteresis = BehaviorUtilitySelector::DefaultHysteresis);
+		IBehavior* Conditional(std::function<bool(Blackboard*)> fp);
+		IBehavior* Conditional(std::function<bool(Blackboard*)> fp, std::initializer_list<BlackboardKeyBase> dependencies);
+		IBehavior* Action(std::function<BehaviorState(Blackboard*)> fp);
+		BehaviorTickRate* TickRate(IBehavior* pChildBehavior, float frequency, float budget = 0.f);
+		// Also evaluates the child again when one of the keys changed
+		BehaviorTickRate* TickRate(IBehavior* pChildBehavior, float frequency, std::initializer_list<BlackboardKeyBase> keys, float budget = 0.f);
+		IBehavior* Cooldown(IBehavior* pChildBehavior, float duration);
+		IBehavior* Timeout(IBehavior* pChildBehavior, float duration);
+		IBehavior* RateLimit(IBehavior* pChildBehavior, unsigned int count, float period);
+		IBehavior* RunOnceUntilKeyChanges(IBehavior* pChildBehavior, std::initializer_list<BlackboardKeyBase> keys);
+
+		// Any other behavior, composites have to take a BehaviorSpan so they do not own their children
+		template<typename T, typename... Args>
+		T* Create(Args&&... args)
+		{
+			return m_pArena->Create<T>(std::forward<Args>(args)...);
+		}
+
+		// Copies children that were collected at runtime into the arena, for the span constructors
+		BehaviorSpan CopyBehaviors(IBehavior* const* pBehaviors, size_t count) { return m_pArena->CopyBehaviors(pBehaviors, count); }
+
+		// Hands the arena over to the tree, the builder can not be used afterwards
+		std::unique_ptr<BehaviorTree> Build(Blackboard* pBlackBoard, IBehavior* pRootBehavior);
+
+	private:
+		std::unique_ptr<BehaviorArena> m_pArena;
+	};
+}
+#endif
@@ -0,0 +1,68 @@
+//=== General Includes ===
+#include "stdafx.h"
+#include "EBehaviorTreeMemo.h"
+using namespace Elite;
+
+unsigned int BehaviorConditionMemo::GetSlot(ConditionFunction fpCondition)
+{
+	// Only called when a tree is compiled or a node runs for the first time, a linear search is fine
+	for (size_t i = 0; i < m_Entries.size(); ++i)
+	{
+		if (m_Entries[i].fpCondition == fpCondition)
+			return static_cast<unsigned int>(i);
+	}
+
+	m_Entries.push_back(Entry{});
+	m_Entries.back().fpCondition = fpCondition;
+	return static_cast<unsigned int>(m_Entries.size() - 1);
+}
+
+bool BehaviorConditionMemo::Evaluate(unsigned int slot, Blackboard* pBlackBoard)
+{
+	Entry& entry = m_Entries[slot];
+	if (entry.Tick == m_Tick && IsUpToDate(entry, pBlackBoard))
+	{
+		++m_SavedCount;
+		return entry.Result;
+	}
+
+	// Record what the condition reads, an outer recorder still has to see those reads as well
+	BlackboardReadSet* pOuterRecorder = pBlackBoard->GetReadRecorder();
+	entry.Reads.Clear();
+	pBlackBoard->SetReadRecorder(&entry.Reads);
+	entry.Result = entry.fpCondition(pBlackBoard);
+	pBlackBoard->SetReadRecorder(pOuterRecorder);
+
+	const std::vector<unsigned int>& indices = entry.Reads.GetIndices();
+	entry.ReadVersions.resize(indices.size());
+	for (size_t i = 0; i < indices.size(); ++i)
+	{
+		entry.ReadVersions[i] = pBlackBoard->GetVersion(indices[i]);
+		if (pOuterRecorder)
+			pOuterRecorder->Add(indices[i]);
+	}
+
+	entry.Tick = m_Tick;
+	++m_EvaluationCount;
+	return entry.Result;
+}
+
+bool BehaviorConditionMemo::IsUpToDate(const Entry& entry, const Blackboard* pBlackBoard) const
+{
+	const std::vector<unsigned int>& indices = entry.Reads.GetIndices();
+	for (size_t i = 0; i < indices.size(); ++i)
+	{
+		if (pBlackBoard->GetVersion(indices[i]) != entry.ReadVersions[i])
+			return false;
+	}
+	return true;
+}
+
+void BehaviorConditionMemo::PrintReport() const
+{
+	const uint64_t total = m_EvaluationCount + m_SavedCount;
+	printf("--- Condition memo ---\n");
+	printf("Evaluated: %llu, served from the memo: %llu (%.1f%%)\n",
+		static_cast<unsigned long long>(m_EvaluationCount), static_cast<unsigned long long>(m_SavedCount),
+		total > 0 ? 100.0 * static_cast<double>(m_SavedCount) / static_cast<double>(total) : 0.0);
+}
@@ -0,0 +1,63 @@
+/*=============================================================================*/
+// EBehaviorTreeMemo.h: Per-tick memoization of behavior tree conditions
+/*=============================================================================*/
+#ifndef ELITE_BEHAVIOR_TREE_MEMO
+#define ELITE_BEHAVIOR_TREE_MEMO
+
+//--- Includes ---
+#include "../EliteData/EBlackboard.h"
+
+#include <cstdint>
+
+namespace Elite
+{
+	//--- CONDITION MEMO ---
+	// Conditions are identified by their function, every node with the same condition shares one entry.
+	// An entry is only reused in the tick it was evaluated in and only while none of the blackboard slots
+	// the condition read changed version. Actions that change data through a pointer in the blackboard
+	// have to call Blackboard::NotifyChanged for the key, otherwise the memo can not see the change.
+	class BehaviorConditionMemo final
+	{
+	public:
+		using ConditionFunction = bool(*)(Blackboard*);
+
+		BehaviorConditionMemo() = default;
+		~BehaviorConditionMemo() = default;
+
+		BehaviorConditionMemo(const BehaviorConditionMemo& other) = delete;
+		BehaviorConditionMemo& operator=(const BehaviorConditionMemo& other) = delete;
+		BehaviorConditionMemo(BehaviorConditionMemo&& other) = delete;
+		BehaviorConditionMemo& operator=(BehaviorConditionMemo&& other) = delete;
+
+		// Drops every result of the previous tick
+		void BeginTick() { ++m_Tick; }
+
+		// Resolve the slot once per node, Evaluate with the slot is then a plain array access
+		unsigned int GetSlot(ConditionFunction fpCondition);
+		bool Evaluate(unsigned int slot, Blackboard* pBlackBoard);
+
+		uint64_t GetEvaluationCount() const { return m_EvaluationCount; }
+		uint64_t GetSavedCount() const { return m_SavedCount; }
+
+		void PrintReport() const;
+
+	private:
+		struct Entry
+		{
+			ConditionFunction fpCondition = nullptr;
+			uint32_t Tick = 0;
+			bool Result = false;
+			BlackboardReadSet Reads = {};
+			std::vector<uint32_t> ReadVersions = {};
+		};
+
+		std::vector<Entry> m_Entries = {};
+		uint32_t m_Tick = 1;
+
+		uint64_t m_EvaluationCount = 0;
+		uint64_t m_SavedCount = 0;
+
+		bool IsUpToDate(const Entry& entry, const Blackboard* pBlackBoard) const;
+	};
+}
+#endif
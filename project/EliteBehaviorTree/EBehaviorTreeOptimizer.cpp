@@ -0,0 +1,763 @@
+//=== General Includes ===
+#include "stdafx.h"
+#include "EBehaviorTreeOptimizer.h"
+
+#include <algorithm>
+#include <typeinfo>
+using namespace Elite;
+
+namespace
+{
+	const char* const StateNames[3]{ "Failure", "Success", "Running" };
+}
+
+//-----------------------------------------------------------------
+// PROBE
+//-----------------------------------------------------------------
+// Records the result of a leaf of the original tree for VerifyEquivalence, together with the keys
+// a condition actually read or an action actually changed
+class BehaviorTreeOptimizer::Probe final : public BehaviorDecorator
+{
+public:
+	Probe(BehaviorSpan childBehavior, BehaviorTreeOptimizer* pOptimizer, unsigned int leafIndex, bool isCondition)
+		: BehaviorDecorator(childBehavior), m_pOptimizer(pOptimizer), m_LeafIndex(leafIndex), m_IsCondition(isCondition) {}
+	virtual ~Probe() = default;
+
+protected:
+	virtual const char* GetTypeName() const override { return "OptimizerProbe"; }
+	virtual BehaviorState OnExecute(Blackboard* pBlackBoard) override
+	{
+		m_Keys.clear();
+		if (m_IsCondition)
+		{
+			// An outer recorder still has to see the reads, same as the condition memo
+			BlackboardReadSet* pOuterRecorder = pBlackBoard->GetReadRecorder();
+			m_Reads.Clear();
+			pBlackBoard->SetReadRecorder(&m_Reads);
+			m_CurrentState = m_pChildBehavior->Execute(pBlackBoard);
+			pBlackBoard->SetReadRecorder(pOuterRecorder);
+
+			m_Keys = m_Reads.GetIndices();
+			if (pOuterRecorder)
+			{
+				for (unsigned int index : m_Keys)
+					pOuterRecorder->Add(index);
+			}
+		}
+		else
+		{
+			m_Versions.resize(pBlackBoard->GetSlotCount());
+			for (unsigned int i = 0; i < m_Versions.size(); ++i)
+				m_Versions[i] = pBlackBoard->GetVersion(i);
+
+			m_CurrentState = m_pChildBehavior->Execute(pBlackBoard);
+
+			for (unsigned int i = 0; i < m_Versions.size(); ++i)
+			{
+				if (pBlackBoard->GetVersion(i) != m_Versions[i])
+					m_Keys.push_back(i);
+			}
+		}
+
+		m_pOptimizer->Record(m_LeafIndex, m_CurrentState, m_Keys);
+		return m_CurrentState;
+	}
+
+private:
+	BehaviorTreeOptimizer* m_pOptimizer;
+	unsigned int m_LeafIndex;
+	bool m_IsCondition;
+
+	BlackboardReadSet m_Reads{};
+	std::vector<uint32_t> m_Versions{};
+	std::vector<unsigned int> m_Keys{};
+};
+
+//-----------------------------------------------------------------
+// KEY SETS
+//-----------------------------------------------------------------
+void BehaviorTreeOptimizer::KeySet::Add(const KeySet& other)
+{
+	if (other.IsAll)
+		IsAll = true;
+	if (IsAll)
+	{
+		Indices.clear();
+		return;
+	}
+
+	for (unsigned int index : other.Indices)
+	{
+		if (std::find(Indices.begin(), Indices.end(), index) == Indices.end())
+			Indices.push_back(index);
+	}
+}
+
+bool BehaviorTreeOptimizer::KeySet::Intersects(const KeySet& other) const
+{
+	if ((IsAll && (other.IsAll || !other.Indices.empty())) || (other.IsAll && !Indices.empty()))
+		return true;
+
+	for (unsigned int index : Indices)
+	{
+		if (std::find(other.Indices.begin(), other.Indices.end(), index) != other.Indices.end())
+			return true;
+	}
+	return false;
+}
+
+//-----------------------------------------------------------------
+// DECLARATIONS
+//-----------------------------------------------------------------
+void BehaviorTreeOptimizer::DeclareCondition(const char* pName, ConditionFunction fpCondition, std::initializer_list<BlackboardKeyBase> reads)
+{
+	Declaration& declaration = m_Declarations[reinterpret_cast<const void*>(fpCondition)];
+	declaration.Name = pName;
+	for (const BlackboardKeyBase& key : reads)
+		declaration.Keys.Indices.push_back(key.GetIndex());
+}
+
+void BehaviorTreeOptimizer::DeclareAction(const char* pName, ActionFunction fpAction, std::initializer_list<BlackboardKeyBase> writes, bool canFail)
+{
+	Declaration& declaration = m_Declarations[reinterpret_cast<const void*>(fpAction)];
+	declaration.Name = pName;
+	declaration.CanFail = canFail;
+	for (const BlackboardKeyBase& key : writes)
+		declaration.Keys.Indices.push_back(key.GetIndex());
+}
+
+void BehaviorTreeOptimizer::DeclareExclusive(ConditionFunction fpFirst, ConditionFunction fpSecond)
+{
+	m_ExclusivePairs.emplace_back(reinterpret_cast<const void*>(fpFirst), reinterpret_cast<const void*>(fpSecond));
+}
+
+void BehaviorTreeOptimizer::EnableVerification(unsigned int maxFrames)
+{
+	m_IsVerificationEnabled = true;
+	m_MaxFrames = maxFrames;
+}
+
+//-----------------------------------------------------------------
+// ANALYSIS
+//-----------------------------------------------------------------
+IBehavior* BehaviorTreeOptimizer::Optimize(IBehavior* pRootBehavior, BehaviorTreeBuilder& builder)
+{
+	if (pRootBehavior == nullptr)
+		return nullptr;
+
+	m_OriginalRoot = Lower(pRootBehavior);
+	m_Stats.NodeCountBefore = CountNodes(m_OriginalRoot);
+
+	m_OptimizedRoot = Rewrite(m_OriginalRoot);
+	m_Stats.NodeCountAfter = CountNodes(m_OptimizedRoot);
+
+	// The recording is made on the original tree, the rewritten one does not run before it is verified
+	if (m_IsVerificationEnabled)
+		m_pRecordingRoot = Emit(m_OriginalRoot, builder, true);
+	return Emit(m_OptimizedRoot, builder, false);
+}
+
+int BehaviorTreeOptimizer::Lower(IBehavior* pBehavior)
+{
+	// Only the exact node types are analysed, like the FlatBehaviorTree does
+	const std::type_info& type = typeid(*pBehavior);
+	if (type == typeid(BehaviorSelector) || type == typeid(BehaviorSequence))
+	{
+		std::vector<int> children{};
+		for (IBehavior* pChild : static_cast<BehaviorComposite*>(pBehavior)->GetChildBehaviors())
+			children.push_back(Lower(pChild));
+		return AddNode(type == typeid(BehaviorSelector) ? NodeType::Selector : NodeType::Sequence, std::move(children));
+	}
+	if (type == typeid(BehaviorMemorySelector) || type == typeid(BehaviorMemorySequence))
+	{
+		const BehaviorMemoryComposite* pComposite = static_cast<BehaviorMemoryComposite*>(pBehavior);
+		std::vector<int> guards{};
+		for (IBehavior* pGuard : pComposite->GetInterruptGuards())
+			guards.push_back(Lower(pGuard));
+		std::vector<int> children{};
+		for (IBehavior* pChild : pComposite->GetChildBehaviors())
+			children.push_back(Lower(pChild));
+
+		const int nodeIndex = AddNode(type == typeid(BehaviorMemorySelector) ? NodeType::MemorySelector : NodeType::MemorySequence, std::move(children));
+		m_Nodes[nodeIndex].Guards = std::move(guards);
+		return nodeIndex;
+	}
+
+	int leafIndex = -1;
+	if (type == typeid(BehaviorConditional))
+	{
+		const BehaviorConditional* pConditional = static_cast<BehaviorConditional*>(pBehavior);
+		const ConditionFunction* pFunction = pConditional->GetConditional().target<ConditionFunction>();
+
+		KeySet dependencies{};
+		const BlackboardSubscription& subscription = pConditional->GetDependencies();
+		dependencies.IsAll = subscription.IsEmpty();
+		for (size_t i = 0; i < subscription.GetKeyCount(); ++i)
+			dependencies.Indices.push_back(subscription.GetKeyIndex(i));
+
+		const void* pIdentity = pFunction && *pFunction ? reinterpret_cast<const void*>(*pFunction) : pBehavior;
+		leafIndex = GetLeafIndex(pIdentity, pBehavior, true, dependencies);
+	}
+	else
+	{
+		const ActionFunction* pFunction = type == typeid(BehaviorAction)
+			? static_cast<BehaviorAction*>(pBehavior)->GetAction().target<ActionFunction>() : nullptr;
+		const void* pIdentity = pFunction && *pFunction ? reinterpret_cast<const void*>(*pFunction) : pBehavior;
+		leafIndex = GetLeafIndex(pIdentity, pBehavior, false, KeySet{});
+	}
+
+	const int nodeIndex = AddNode(NodeType::Leaf, {});
+	m_Nodes[nodeIndex].LeafIndex = leafIndex;
+	m_Nodes[nodeIndex].pBehavior = pBehavior;
+	return nodeIndex;
+}
+
+int BehaviorTreeOptimizer::GetLeafIndex(const void* pIdentity, IBehavior* pBehavior, bool isCondition, const KeySet& dependencies)
+{
+	auto it = m_LeafIndices.find(pIdentity);
+	if (it != m_LeafIndices.end())
+		return it->second;
+
+	Leaf leaf{};
+	leaf.pIdentity = pIdentity;
+	leaf.IsCondition = isCondition;
+	leaf.Name = pBehavior->GetName();
+
+	auto declaration = m_Declarations.find(pIdentity);
+	const bool isDeclared = declaration != m_Declarations.end();
+	if (isDeclared)
+		leaf.Name = declaration->second.Name;
+
+	if (isCondition)
+	{
+		leaf.Reads = isDeclared ? declaration->second.Keys : dependencies;
+	}
+	else
+	{
+		leaf.Reads.IsAll = true;
+		leaf.Writes.IsAll = !isDeclared;
+		if (isDeclared)
+		{
+			leaf.Writes = declaration->second.Keys;
+			leaf.CanFail = declaration->second.CanFail;
+		}
+	}
+
+	m_Leaves.push_back(std::move(leaf));
+	const int leafIndex = static_cast<int>(m_Leaves.size() - 1);
+	m_LeafIndices.emplace(pIdentity, leafIndex);
+	return leafIndex;
+}
+
+int BehaviorTreeOptimizer::AddNode(NodeType type, std::vector<int> children)
+{
+	Node node{};
+	node.Type = type;
+	node.Children = std::move(children);
+	m_Nodes.push_back(std::move(node));
+	return static_cast<int>(m_Nodes.size() - 1);
+}
+
+unsigned int BehaviorTreeOptimizer::CountNodes(int nodeIndex) const
+{
+	const Node& node = m_Nodes[nodeIndex];
+	unsigned int count = 1;
+	for (int childIndex : node.Children)
+		count += CountNodes(childIndex);
+	for (int guardIndex : node.Guards)
+		count += CountNodes(guardIndex);
+	return count;
+}
+
+BehaviorTreeOptimizer::KeySet BehaviorTreeOptimizer::GetWrites(int nodeIndex) const
+{
+	const Node& node = m_Nodes[nodeIndex];
+	if (node.Type == NodeType::Leaf)
+		return m_Leaves[node.LeafIndex].Writes;
+
+	KeySet writes{};
+	for (int childIndex : node.Children)
+		writes.Add(GetWrites(childIndex));
+	for (int guardIndex : node.Guards)
+		writes.Add(GetWrites(guardIndex));
+	return writes;
+}
+
+bool BehaviorTreeOptimizer::CanFail(int nodeIndex) const
+{
+	const Node& node = m_Nodes[nodeIndex];
+	switch (node.Type)
+	{
+	case NodeType::Leaf:
+		return m_Leaves[node.LeafIndex].IsCondition || m_Leaves[node.LeafIndex].CanFail;
+	case NodeType::Sequence:
+		return std::any_of(node.Children.begin(), node.Children.end(), [this](int childIndex) { return CanFail(childIndex); });
+	case NodeType::Selector:
+		return std::all_of(node.Children.begin(), node.Children.end(), [this](int childIndex) { return CanFail(childIndex); });
+	default:
+		return true;
+	}
+}
+
+bool BehaviorTreeOptimizer::IsConditionLeaf(int nodeIndex) const
+{
+	const Node& node = m_Nodes[nodeIndex];
+	return node.Type == NodeType::Leaf && m_Leaves[node.LeafIndex].IsCondition;
+}
+
+bool BehaviorTreeOptimizer::AreExclusive(int firstLeaf, int secondLeaf) const
+{
+	const void* pFirst = m_Leaves[firstLeaf].pIdentity;
+	const void* pSecond = m_Leaves[secondLeaf].pIdentity;
+	return std::any_of(m_ExclusivePairs.begin(), m_ExclusivePairs.end(), [pFirst, pSecond](const std::pair<const void*, const void*>& pair)
+		{
+			return (pair.first == pFirst && pair.second == pSecond) || (pair.first == pSecond && pair.second == pFirst);
+		});
+}
+
+int BehaviorTreeOptimizer::GetLeadingCondition(int nodeIndex) const
+{
+	const Node& node = m_Nodes[nodeIndex];
+	if (node.Type != NodeType::Sequence || node.Children.empty() || !IsConditionLeaf(node.Children[0]))
+		return -1;
+	return m_Nodes[node.Children[0]].LeafIndex;
+}
+
+//-----------------------------------------------------------------
+// REWRITING
+//-----------------------------------------------------------------
+int BehaviorTreeOptimizer::Rewrite(int nodeIndex)
+{
+	// Copied, the node vector grows while rewriting
+	const Node node = m_Nodes[nodeIndex];
+	if (node.Type == NodeType::Leaf)
+		return nodeIndex;
+
+	std::vector<int> children{};
+	for (int childIndex : node.Children)
+		children.push_back(Rewrite(childIndex));
+	bool hasChanged = children != node.Children;
+
+	if (node.Type == NodeType::MemorySelector || node.Type == NodeType::MemorySequence)
+	{
+		std::vector<int> guards{};
+		for (int guardIndex : node.Guards)
+			guards.push_back(Rewrite(guardIndex));
+		if (!hasChanged && guards == node.Guards)
+			return nodeIndex;
+
+		const int newIndex = AddNode(node.Type, std::move(children));
+		m_Nodes[newIndex].Guards = std::move(guards);
+		return newIndex;
+	}
+
+	bool isChanging = true;
+	while (isChanging)
+	{
+		isChanging = Flatten(node.Type, children);
+		if (node.Type == NodeType::Sequence)
+			isChanging |= SimplifySequence(children);
+		else
+			isChanging = HoistConditions(children) | SimplifySelector(children) | isChanging;
+		hasChanged |= isChanging;
+	}
+
+	// A selector or sequence of one child returns what the child returns
+	if (children.size() == 1)
+	{
+		++m_Stats.FlattenedComposites;
+		return children[0];
+	}
+	return hasChanged ? AddNode(node.Type, std::move(children)) : nodeIndex;
+}
+
+bool BehaviorTreeOptimizer::Flatten(NodeType type, std::vector<int>& children)
+{
+	bool hasChanged = false;
+	std::vector<int> flattened{};
+	for (int childIndex : children)
+	{
+		if (m_Nodes[childIndex].Type == type)
+		{
+			const std::vector<int>& grandChildren = m_Nodes[childIndex].Children;
+			flattened.insert(flattened.end(), grandChildren.begin(), grandChildren.end());
+			++m_Stats.FlattenedComposites;
+			hasChanged = true;
+		}
+		else
+		{
+			flattened.push_back(childIndex);
+		}
+	}
+	children = std::move(flattened);
+	return hasChanged;
+}
+
+bool BehaviorTreeOptimizer::SimplifySequence(std::vector<int>& children)
+{
+	// Conditions that succeeded earlier in this sequence and of which nothing since changed what they read
+	std::vector<int> trueConditions{};
+	for (size_t i = 0; i < children.size(); ++i)
+	{
+		if (!IsConditionLeaf(children[i]))
+		{
+			const KeySet writes = GetWrites(children[i]);
+			trueConditions.erase(std::remove_if(trueConditions.begin(), trueConditions.end(), [this, &writes](int leafIndex)
+				{
+					return m_Leaves[leafIndex].Reads.Intersects(writes);
+				}), trueConditions.end());
+			continue;
+		}
+
+		const int leafIndex = m_Nodes[children[i]].LeafIndex;
+		if (std::find(trueConditions.begin(), trueConditions.end(), leafIndex) != trueConditions.end())
+		{
+			children.erase(children.begin() + i);
+			++m_Stats.RemovedConditions;
+			return true;
+		}
+
+		// This condition always fails here, nothing after it runs
+		const bool isExclusive = std::any_of(trueConditions.begin(), trueConditions.end(), [this, leafIndex](int trueLeafIndex)
+			{
+				return AreExclusive(trueLeafIndex, leafIndex);
+			});
+		if (isExclusive && i + 1 < children.size())
+		{
+			for (size_t j = i + 1; j < children.size(); ++j)
+				m_Stats.RemovedUnreachable += CountNodes(children[j]);
+			children.resize(i + 1);
+			return true;
+		}
+		trueConditions.push_back(leafIndex);
+	}
+	return false;
+}
+
+bool BehaviorTreeOptimizer::SimplifySelector(std::vector<int>& children)
+{
+	for (size_t i = 0; i + 1 < children.size(); ++i)
+	{
+		if (CanFail(children[i]))
+			continue;
+
+		// Everything after a child that can not fail is unreachable
+		for (size_t j = i + 1; j < children.size(); ++j)
+			m_Stats.RemovedUnreachable += CountNodes(children[j]);
+		children.resize(i + 1);
+		return true;
+	}
+	return false;
+}
+
+bool BehaviorTreeOptimizer::HoistConditions(std::vector<int>& children)
+{
+	bool hasChanged = false;
+	for (size_t i = 0; i < children.size(); ++i)
+	{
+		const int leafIndex = GetLeadingCondition(children[i]);
+		if (leafIndex < 0)
+			continue;
+
+		// The selector checks the condition again for every sequence, so the sequences that come before
+		// the last one may not change what the condition reads
+		size_t end = i + 1;
+		for (; end < children.size() && GetLeadingCondition(children[end]) == leafIndex; ++end)
+		{
+			const std::vector<int>& previous = m_Nodes[children[end - 1]].Children;
+			auto writer = std::find_if(previous.begin() + 1, previous.end(), [this, leafIndex](int childIndex)
+				{
+					return GetWrites(childIndex).Intersects(m_Leaves[leafIndex].Reads);
+				});
+			if (writer != previous.end())
+			{
+				const Node& writerNode = m_Nodes[*writer];
+				const std::string note = m_Leaves[leafIndex].Name + " is checked again: "
+					+ (writerNode.Type == NodeType::Leaf ? m_Leaves[writerNode.LeafIndex].Name : std::string{ "a subtree" })
+					+ " may change what it reads";
+				if (std::find(m_Notes.begin(), m_Notes.end(), note) == m_Notes.end())
+					m_Notes.push_back(note);
+				break;
+			}
+		}
+		if (end - i < 2)
+			continue;
+
+		std::vector<int> tails{};
+		for (size_t j = i; j < end; ++j)
+			tails.push_back(MakeTail(children[j]));
+
+		const int conditionIndex = m_Nodes[children[i]].Children[0];
+		const int selectorIndex = Rewrite(AddNode(NodeType::Selector, std::move(tails)));
+		const int sequenceIndex = Rewrite(AddNode(NodeType::Sequence, { conditionIndex, selectorIndex }));
+
+		m_Stats.HoistedConditions += static_cast<unsigned int>(end - i - 1);
+		children.erase(children.begin() + i + 1, children.begin() + end);
+		children[i] = sequenceIndex;
+		hasChanged = true;
+	}
+	return hasChanged;
+}
+
+int BehaviorTreeOptimizer::MakeTail(int sequenceIndex)
+{
+	const std::vector<int>& children = m_Nodes[sequenceIndex].Children;
+	if (children.size() == 2)
+		return children[1];
+	return AddNode(NodeType::Sequence, std::vector<int>(children.begin() + 1, children.end()));
+}
+
+IBehavior* BehaviorTreeOptimizer::Emit(int nodeIndex, BehaviorTreeBuilder& builder, bool addProbes)
+{
+	const Node& node = m_Nodes[nodeIndex];
+	if (node.Type == NodeType::Leaf)
+	{
+		IBehavior* pBehavior = node.pBehavior;
+		if (addProbes)
+			return builder.Create<Probe>(builder.CopyBehaviors(&pBehavior, 1), this, static_cast<unsigned int>(node.LeafIndex),
+				m_Leaves[node.LeafIndex].IsCondition);
+		return pBehavior;
+	}
+
+	std::vector<IBehavior*> children{};
+	for (int childIndex : node.Children)
+		children.push_back(Emit(childIndex, builder, addProbes));
+	const BehaviorSpan childSpan = builder.CopyBehaviors(children.data(), children.size());
+
+	std::vector<IBehavior*> guards{};
+	for (int guardIndex : node.Guards)
+		guards.push_back(Emit(guardIndex, builder, addProbes));
+	const BehaviorSpan guardSpan = builder.CopyBehaviors(guards.data(), guards.size());
+
+	switch (node.Type)
+	{
+	case NodeType::Selector:
+		return builder.Create<BehaviorSelector>(childSpan);
+	case NodeType::Sequence:
+		return builder.Create<BehaviorSequence>(childSpan);
+	case NodeType::MemorySelector:
+		return builder.Create<BehaviorMemorySelector>(childSpan, guardSpan);
+	default:
+		return builder.Create<BehaviorMemorySequence>(childSpan, guardSpan);
+	}
+}
+
+//-----------------------------------------------------------------
+// VERIFICATION
+//-----------------------------------------------------------------
+void BehaviorTreeOptimizer::Record(unsigned int leafIndex, BehaviorState result, const std::vector<unsigned int>& keys)
+{
+	// The replay also respects what the probes saw, so a declaration that leaves out a key can not hide a difference
+	Leaf& leaf = m_Leaves[leafIndex];
+	KeySet& declaredKeys = leaf.IsCondition ? leaf.Reads : leaf.Writes;
+	if (!declaredKeys.IsAll)
+	{
+		for (unsigned int index : keys)
+		{
+			if (std::find(declaredKeys.Indices.begin(), declaredKeys.Indices.end(), index) == declaredKeys.Indices.end())
+				declaredKeys.Indices.push_back(index);
+		}
+	}
+
+	const BehaviorTreeContext* pContext = BehaviorTreeContext::GetCurrent();
+	const uint32_t tick = pContext ? pContext->Tick : m_LastTick;
+	if (m_Frames.empty() || tick != m_LastTick)
+	{
+		if (m_Frames.size() >= m_MaxFrames)
+			return;
+		m_Frames.emplace_back();
+		m_LastTick = tick;
+	}
+
+	TraceFrame& frame = m_Frames.back();
+	frame.Events.push_back(TraceEvent{ leafIndex, result, static_cast<unsigned int>(frame.ActionEvents.size()) });
+	if (!leaf.IsCondition)
+		frame.ActionEvents.push_back(static_cast<unsigned int>(frame.Events.size() - 1));
+}
+
+bool BehaviorTreeOptimizer::VerifyEquivalence()
+{
+	Replay original{};
+	original.RunningChildren.resize(m_Nodes.size(), -1);
+	Replay optimized{};
+	optimized.RunningChildren.resize(m_Nodes.size(), -1);
+
+	const size_t frameCount = m_Frames.size();
+	for (size_t i = 0; i < frameCount; ++i)
+	{
+		const TraceFrame& frame = m_Frames[i];
+		original.pFrame = &frame;
+		original.NextAction = 0;
+		optimized.pFrame = &frame;
+		optimized.NextAction = 0;
+
+		const BehaviorState originalResult = ReplayNode(m_OriginalRoot, original);
+		if (!original.HasDiverged && original.NextAction != frame.ActionEvents.size())
+			original.HasDiverged = true, original.Reason = "stops before the recorded actions ran";
+		if (original.HasDiverged)
+		{
+			m_VerificationResult = "The recording of tick " + std::to_string(i) + " does not replay on the original tree: " + original.Reason;
+			return false;
+		}
+
+		const BehaviorState optimizedResult = ReplayNode(m_OptimizedRoot, optimized);
+		if (!optimized.HasDiverged && optimized.NextAction != frame.ActionEvents.size())
+			optimized.HasDiverged = true, optimized.Reason = "stops before the recorded actions ran";
+		if (!optimized.HasDiverged && optimizedResult != originalResult)
+		{
+			optimized.HasDiverged = true;
+			optimized.Reason = std::string{ "ends in " } + StateNames[static_cast<int>(optimizedResult)]
+				+ " instead of " + StateNames[static_cast<int>(originalResult)];
+		}
+		if (optimized.HasDiverged)
+		{
+			m_VerificationResult = "NOT equivalent at tick " + std::to_string(i) + ", the optimized tree " + optimized.Reason;
+			return false;
+		}
+	}
+
+	m_VerificationResult = "Equivalent on " + std::to_string(frameCount) + " recorded ticks";
+	return true;
+}
+
+BehaviorState BehaviorTreeOptimizer::ReplayNode(int nodeIndex, Replay& replay) const
+{
+	const Node& node = m_Nodes[nodeIndex];
+	switch (node.Type)
+	{
+	case NodeType::Leaf:
+		return ReplayLeaf(nodeIndex, replay);
+	case NodeType::Selector:
+		for (int childIndex : node.Children)
+		{
+			const BehaviorState state = ReplayNode(childIndex, replay);
+			if (replay.HasDiverged || state != BehaviorState::Failure)
+				return state;
+		}
+		return BehaviorState::Failure;
+	case NodeType::Sequence:
+		for (int childIndex : node.Children)
+		{
+			const BehaviorState state = ReplayNode(childIndex, replay);
+			if (replay.HasDiverged || state != BehaviorState::Success)
+				return state;
+		}
+		return BehaviorState::Success;
+	default:
+	{
+		// Same as the memory composites, the index of the running child is kept between ticks
+		const BehaviorState stopState = node.Type == NodeType::MemorySelector ? BehaviorState::Success : BehaviorState::Failure;
+		for (size_t i = ReplayResumeIndex(nodeIndex, replay); i < node.Children.size(); ++i)
+		{
+			const BehaviorState state = ReplayNode(node.Children[i], replay);
+			if (replay.HasDiverged)
+				return state;
+			if (state == BehaviorState::Running)
+				replay.RunningChildren[nodeIndex] = static_cast<int>(i);
+			if (state == BehaviorState::Running || state == stopState)
+				return state;
+		}
+		return node.Type == NodeType::MemorySelector ? BehaviorState::Failure : BehaviorState::Success;
+	}
+	}
+}
+
+BehaviorState BehaviorTreeOptimizer::ReplayLeaf(int nodeIndex, Replay& replay) const
+{
+	const unsigned int leafIndex = static_cast<unsigned int>(m_Nodes[nodeIndex].LeafIndex);
+	const Leaf& leaf = m_Leaves[leafIndex];
+	const TraceFrame& frame = *replay.pFrame;
+
+	// Actions have to run in the recorded order and give the recorded result
+	if (!leaf.IsCondition)
+	{
+		if (replay.NextAction >= frame.ActionEvents.size())
+		{
+			replay.HasDiverged = true;
+			replay.Reason = "runs " + leaf.Name + " after the recorded actions";
+			return BehaviorState::Failure;
+		}
+
+		const TraceEvent& event = frame.Events[frame.ActionEvents[replay.NextAction]];
+		if (event.LeafIndex != leafIndex)
+		{
+			replay.HasDiverged = true;
+			replay.Reason = "runs " + leaf.Name + " where " + m_Leaves[event.LeafIndex].Name + " ran";
+			return BehaviorState::Failure;
+		}
+		++replay.NextAction;
+		return event.Result;
+	}
+
+	// A condition can use any recorded result of the same condition, as long as none of the actions
+	// between that evaluation and now writes what the condition reads
+	const unsigned int epoch = replay.NextAction;
+	const TraceEvent* pClosest = nullptr;
+	unsigned int closestDistance = ~0u;
+	for (const TraceEvent& event : frame.Events)
+	{
+		if (event.LeafIndex != leafIndex)
+			continue;
+
+		const unsigned int first = event.Epoch < epoch ? event.Epoch : epoch;
+		const unsigned int last = event.Epoch < epoch ? epoch : event.Epoch;
+		bool isValid = true;
+		for (unsigned int i = first; i < last && isValid; ++i)
+			isValid = !m_Leaves[frame.Events[frame.ActionEvents[i]].LeafIndex].Writes.Intersects(leaf.Reads);
+
+		if (isValid && last - first < closestDistance)
+		{
+			pClosest = &event;
+			closestDistance = last - first;
+		}
+	}
+
+	if (pClosest == nullptr)
+	{
+		replay.HasDiverged = true;
+		replay.Reason = "checks " + leaf.Name + " where the recording has no result for it";
+		return BehaviorState::Failure;
+	}
+	return pClosest->Result;
+}
+
+unsigned int BehaviorTreeOptimizer::ReplayResumeIndex(int nodeIndex, Replay& replay) const
+{
+	const int runningChildIndex = replay.RunningChildren[nodeIndex];
+	if (runningChildIndex < 0)
+		return 0;
+	replay.RunningChildren[nodeIndex] = -1;
+
+	const Node& node = m_Nodes[nodeIndex];
+	for (int guardIndex : node.Guards)
+	{
+		if (ReplayNode(guardIndex, replay) == BehaviorState::Success)
+		{
+			ResetReplay(node.Children[runningChildIndex], replay);
+			return 0;
+		}
+	}
+	return static_cast<unsigned int>(runningChildIndex);
+}
+
+void BehaviorTreeOptimizer::ResetReplay(int nodeIndex, Replay& replay) const
+{
+	replay.RunningChildren[nodeIndex] = -1;
+	for (int childIndex : m_Nodes[nodeIndex].Children)
+		ResetReplay(childIndex, replay);
+}
+
+//-----------------------------------------------------------------
+// REPORTING
+//-----------------------------------------------------------------
+void BehaviorTreeOptimizer::PrintReport() const
+{
+	printf("--- Behavior tree optimizer ---\n");
+	printf("Nodes: %u -> %u\n", m_Stats.NodeCountBefore, m_Stats.NodeCountAfter);
+	printf("Flattened composites: %u, hoisted conditions: %u, removed conditions: %u, removed unreachable nodes: %u\n",
+		m_Stats.FlattenedComposites, m_Stats.HoistedConditions, m_Stats.RemovedConditions, m_Stats.RemovedUnreachable);
+	for (const std::string& note : m_Notes)
+		printf("  %s\n", note.c_str());
+	if (m_IsVerificationEnabled)
+		printf("Verification: %s\n", m_VerificationResult.empty() ? "not run" : m_VerificationResult.c_str());
+}
@@ -0,0 +1,195 @@
+/*=============================================================================*/
+// EBehaviorTreeOptimizer.h: Startup analysis and rewriting of behavior trees
+/*=============================================================================*/
+#ifndef ELITE_BEHAVIOR_TREE_OPTIMIZER
+#define ELITE_BEHAVIOR_TREE_OPTIMIZER
+
+//--- Includes ---
+#include "EBehaviorTreeBuilder.h"
+
+#include <string>
+#include <unordered_map>
+
+namespace Elite
+{
+	struct BehaviorTreeOptimizerStats
+	{
+		unsigned int NodeCountBefore = 0;
+		unsigned int NodeCountAfter = 0;
+		unsigned int HoistedConditions = 0;
+		unsigned int FlattenedComposites = 0;
+		unsigned int RemovedConditions = 0;
+		unsigned int RemovedUnreachable = 0;
+	};
+
+	//-----------------------------------------------------------------
+	// BEHAVIOR TREE OPTIMIZER
+	//-----------------------------------------------------------------
+	// Rewrites a tree made with a BehaviorTreeBuilder before it is built:
+	//	- nested selectors and sequences of the same type are flattened, composites with one child are removed
+	//	- a condition that already succeeded earlier in the same sequence is removed
+	//	- children that can never run are removed: after a selector child that can not fail,
+	//	  and after a condition in a sequence that is declared exclusive with an earlier one
+	//	- sibling sequences in a selector that start with the same condition share one check of it
+	// Every rewrite relies on the declared read and write sets. A condition without a declaration reads
+	// every key (or only its dependencies when it has them), an action without a declaration writes every key
+	// and can fail. Other behaviors (decorators, parallels, ...) are kept as they are and count as such an action.
+	// Memory composites keep their shape, only their children are rewritten.
+	//
+	// With verification enabled, Optimize also makes a copy of the original tree with every leaf wrapped in a probe
+	// that records its results and the keys it really read or changed. That copy runs until the recording is complete,
+	// VerifyEquivalence then replays each recorded tick on the original and on the rewritten tree: both have to run
+	// the same actions with the recorded results and end in the same state. Only then is the rewritten tree used.
+	class BehaviorTreeOptimizer final
+	{
+	public:
+		using ConditionFunction = bool(*)(Blackboard*);
+		using ActionFunction = BehaviorState(*)(Blackboard*);
+
+		BehaviorTreeOptimizer() = default;
+		~BehaviorTreeOptimizer() = default;
+
+		BehaviorTreeOptimizer(const BehaviorTreeOptimizer& other) = delete;
+		BehaviorTreeOptimizer& operator=(const BehaviorTreeOptimizer& other) = delete;
+		BehaviorTreeOptimizer(BehaviorTreeOptimizer&& other) = delete;
+		BehaviorTreeOptimizer& operator=(BehaviorTreeOptimizer&& other) = delete;
+
+		void DeclareCondition(const char* pName, ConditionFunction fpCondition, std::initializer_list<BlackboardKeyBase> reads);
+		void DeclareAction(const char* pName, ActionFunction fpAction, std::initializer_list<BlackboardKeyBase> writes, bool canFail = true);
+		// The two conditions are never true at the same time as long as none of the keys they read changes
+		void DeclareExclusive(ConditionFunction fpFirst, ConditionFunction fpSecond);
+
+		// Has to be called before Optimize, records the first maxFrames ticks
+		void EnableVerification(unsigned int maxFrames = 600);
+
+		// Returns the new root, the nodes are created in the arena of the builder
+		IBehavior* Optimize(IBehavior* pRootBehavior, BehaviorTreeBuilder& builder);
+
+		// With verification enabled: the original tree with the probes, made by Optimize. Run it instead of either
+		// root until the recording is complete, then switch to the new root only when VerifyEquivalence passes.
+		IBehavior* GetRecordingRoot() const { return m_pRecordingRoot; }
+		bool IsRecordingComplete() const { return m_IsVerificationEnabled && m_Frames.size() >= m_MaxFrames; }
+
+		bool VerifyEquivalence();
+		const BehaviorTreeOptimizerStats& GetStats() const { return m_Stats; }
+		void PrintReport() const;
+
+	private:
+		class Probe;
+
+		struct KeySet
+		{
+			bool IsAll = false;
+			std::vector<unsigned int> Indices = {};
+
+			void Add(const KeySet& other);
+			bool Intersects(const KeySet& other) const;
+		};
+
+		struct Declaration
+		{
+			std::string Name = {};
+			KeySet Keys = {};
+			bool CanFail = true;
+		};
+
+		// Everything with the same identity (the function, or the node itself for lambdas and other behaviors)
+		// shares one leaf
+		struct Leaf
+		{
+			const void* pIdentity = nullptr;
+			std::string Name = {};
+			bool IsCondition = false;
+			bool CanFail = true;
+			KeySet Reads = {};
+			KeySet Writes = {};
+		};
+
+		enum class NodeType
+		{
+			Selector,
+			Sequence,
+			MemorySelector,
+			MemorySequence,
+			Leaf
+		};
+
+		struct Node
+		{
+			NodeType Type = NodeType::Leaf;
+			std::vector<int> Children = {};
+			std::vector<int> Guards = {};
+			int LeafIndex = -1;
+			IBehavior* pBehavior = nullptr; // Leaves only, reused in the rewritten tree
+		};
+
+		struct TraceEvent
+		{
+			unsigned int LeafIndex;
+			BehaviorState Result;
+			unsigned int Epoch; // Actions that ran before it in the same tick
+		};
+
+		struct TraceFrame
+		{
+			std::vector<TraceEvent> Events = {};
+			std::vector<unsigned int> ActionEvents = {};
+		};
+
+		struct Replay
+		{
+			const TraceFrame* pFrame = nullptr;
+			std::vector<int> RunningChildren = {};
+			unsigned int NextAction = 0;
+			bool HasDiverged = false;
+			std::string Reason = {};
+		};
+
+		std::unordered_map<const void*, Declaration> m_Declarations = {};
+		std::vector<std::pair<const void*, const void*>> m_ExclusivePairs = {};
+
+		std::vector<Leaf> m_Leaves = {};
+		std::unordered_map<const void*, int> m_LeafIndices = {};
+		std::vector<Node> m_Nodes = {};
+		int m_OriginalRoot = -1;
+		int m_OptimizedRoot = -1;
+
+		BehaviorTreeOptimizerStats m_Stats = {};
+		std::vector<std::string> m_Notes = {};
+
+		bool m_IsVerificationEnabled = false;
+		unsigned int m_MaxFrames = 0;
+		IBehavior* m_pRecordingRoot = nullptr;
+		std::vector<TraceFrame> m_Frames = {};
+		uint32_t m_LastTick = 0;
+		std::string m_VerificationResult = {};
+
+		// Analysis
+		int Lower(IBehavior* pBehavior);
+		int GetLeafIndex(const void* pIdentity, IBehavior* pBehavior, bool isCondition, const KeySet& dependencies);
+		int AddNode(NodeType type, std::vector<int> children);
+		unsigned int CountNodes(int nodeIndex) const;
+		KeySet GetWrites(int nodeIndex) const;
+		bool CanFail(int nodeIndex) const;
+		bool IsConditionLeaf(int nodeIndex) const;
+		bool AreExclusive(int firstLeaf, int secondLeaf) const;
+		int GetLeadingCondition(int nodeIndex) const;
+
+		// Rewriting
+		int Rewrite(int nodeIndex);
+		bool Flatten(NodeType type, std::vector<int>& children);
+		bool SimplifySequence(std::vector<int>& children);
+		bool SimplifySelector(std::vector<int>& children);
+		bool HoistConditions(std::vector<int>& children);
+		int MakeTail(int sequenceIndex);
+		IBehavior* Emit(int nodeIndex, BehaviorTreeBuilder& builder, bool addProbes);
+
+		// Verification
+		void Record(unsigned int leafIndex, BehaviorState result, const std::vector<unsigned int>& keys);
+		BehaviorState ReplayNode(int nodeIndex, Replay& replay) const;
+		BehaviorState ReplayLeaf(int nodeIndex, Replay& replay) const;
+		unsigned int ReplayResumeIndex(int nodeIndex, Replay& replay) const;
+		void ResetReplay(int nodeIndex, Replay& replay) const;
+	};
+}
+#endif
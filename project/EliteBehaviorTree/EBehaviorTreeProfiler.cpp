@@ -0,0 +1,322 @@
+//=== General Includes ===
+#include "stdafx.h"
+#include "EBehaviorTreeProfiler.h"
+#include "EBehaviorTree.h"
+
+using namespace Elite;
+
+constexpr unsigned int BehaviorTreeProfiler::WindowSize;
+constexpr size_t BehaviorTreeProfiler::MaxTraceEvents;
+
+namespace
+{
+	const char* const ResultNames[3]{ "Failure", "Success", "Running" };
+
+	double ToMicroseconds(BehaviorTreeProfiler::Clock::duration duration)
+	{
+		return std::chrono::duration<double, std::micro>(duration).count();
+	}
+
+	// Names are type names or set in code, only quotes and backslashes need escaping
+	std::string EscapeJson(const std::string& text)
+	{
+		std::string escaped{};
+		escaped.reserve(text.size());
+		for (char c : text)
+		{
+			if (c == '"' || c == '\\')
+				escaped.push_back('\\');
+			escaped.push_back(c);
+		}
+		return escaped;
+	}
+}
+
+//-----------------------------------------------------------------
+// SAMPLES
+//-----------------------------------------------------------------
+BehaviorNodeSample& BehaviorNodeSample::operator+=(const BehaviorNodeSample& other)
+{
+	Calls += other.Calls;
+	for (int i = 0; i < 3; ++i)
+		Results[i] += other.Results[i];
+	InclusiveSeconds += other.InclusiveSeconds;
+	ExclusiveSeconds += other.ExclusiveSeconds;
+	return *this;
+}
+
+BehaviorNodeSample& BehaviorNodeSample::operator-=(const BehaviorNodeSample& other)
+{
+	Calls -= other.Calls;
+	for (int i = 0; i < 3; ++i)
+		Results[i] -= other.Results[i];
+	InclusiveSeconds -= other.InclusiveSeconds;
+	ExclusiveSeconds -= other.ExclusiveSeconds;
+	return *this;
+}
+
+//-----------------------------------------------------------------
+// RECORDING
+//-----------------------------------------------------------------
+BehaviorTreeProfiler& BehaviorTreeProfiler::GetInstance()
+{
+	static BehaviorTreeProfiler instance{};
+	return instance;
+}
+
+void BehaviorTreeProfiler::Enter(const IBehavior* pBehavior)
+{
+	const int nodeIndex = GetNodeIndex(pBehavior);
+	m_Stack.push_back(ActiveNode{ nodeIndex, Clock::now(), Clock::duration::zero() });
+}
+
+void BehaviorTreeProfiler::Exit(BehaviorState result)
+{
+	const Clock::time_point end = Clock::now();
+	const ActiveNode active = m_Stack.back();
+	m_Stack.pop_back();
+
+	// Exclusive time is what is left after the children that ran inside this call
+	const Clock::duration inclusive = end - active.Start;
+	if (!m_Stack.empty())
+		m_Stack.back().ChildTime += inclusive;
+
+	BehaviorNodeSample& frame = m_Nodes[active.NodeIndex].Frame;
+	++frame.Calls;
+	++frame.Results[static_cast<int>(result)];
+	frame.InclusiveSeconds += std::chrono::duration<double>(inclusive).count();
+	frame.ExclusiveSeconds += std::chrono::duration<double>(inclusive - active.ChildTime).count();
+
+	if (m_CaptureFramesLeft > 0 && m_TraceEvents.size() < MaxTraceEvents)
+		m_TraceEvents.push_back(TraceEvent{ active.NodeIndex, result, active.Start, inclusive });
+}
+
+void BehaviorTreeProfiler::EndFrame()
+{
+	const unsigned int historyIndex = m_FrameCount % WindowSize;
+	for (BehaviorNodeStats& stats : m_Nodes)
+	{
+		// The window drops the frame that is overwritten in the ring buffer
+		BehaviorNodeSample& oldest = stats.History[historyIndex];
+		stats.Window -= oldest;
+		oldest = stats.Frame;
+		stats.Window += stats.Frame;
+
+		stats.Total += stats.Frame;
+		stats.LastFrame = stats.Frame;
+		stats.Frame = BehaviorNodeSample{};
+	}
+
+	if (m_CaptureFramesLeft > 0)
+	{
+		m_TraceFrames.push_back(Clock::now());
+		--m_CaptureFramesLeft;
+	}
+
+	++m_FrameCount;
+}
+
+void BehaviorTreeProfiler::Reset()
+{
+	m_Nodes.clear();
+	m_NodeIndices.clear();
+	m_Roots.clear();
+	m_Stack.clear();
+	m_FrameCount = 0;
+
+	m_TraceEvents.clear();
+	m_TraceFrames.clear();
+	m_CaptureFramesLeft = 0;
+}
+
+int BehaviorTreeProfiler::GetNodeIndex(const IBehavior* pBehavior)
+{
+	auto it = m_NodeIndices.find(pBehavior);
+	if (it != m_NodeIndices.end())
+		return it->second;
+
+	const int nodeIndex = static_cast<int>(m_Nodes.size());
+	m_NodeIndices.emplace(pBehavior, nodeIndex);
+
+	BehaviorNodeStats stats{};
+	stats.pBehavior = pBehavior;
+	stats.Name = pBehavior->GetName();
+	stats.History.resize(WindowSize);
+
+	// The node that is running while this one gets entered for the first time is its parent
+	if (m_Stack.empty())
+	{
+		m_Roots.push_back(nodeIndex);
+	}
+	else
+	{
+		stats.ParentIndex = m_Stack.back().NodeIndex;
+		m_Nodes[stats.ParentIndex].Children.push_back(nodeIndex);
+	}
+
+	m_Nodes.push_back(std::move(stats));
+	return nodeIndex;
+}
+
+unsigned int BehaviorTreeProfiler::GetWindowFrameCount() const
+{
+	return m_FrameCount < WindowSize ? m_FrameCount : WindowSize;
+}
+
+//-----------------------------------------------------------------
+// CHROME TRACE
+//-----------------------------------------------------------------
+void BehaviorTreeProfiler::StartCapture(unsigned int frameCount)
+{
+	m_TraceEvents.clear();
+	m_TraceFrames.clear();
+	m_CaptureStart = Clock::now();
+	m_CaptureFramesLeft = frameCount;
+}
+
+bool BehaviorTreeProfiler::ExportChromeTrace(const std::string& path) const
+{
+	std::ofstream file{ path };
+	if (!file)
+		return false;
+
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+	bool isFirst = true;
+	auto separate = [&file, &isFirst]()
+	{
+		if (!isFirst)
+			file << ",\n";
+		isFirst = false;
+	};
+
+	char buffer[64]{};
+	for (const Clock::time_point& frameEnd : m_TraceFrames)
+	{
+		separate();
+		snprintf(buffer, sizeof(buffer), "%.3f", ToMicroseconds(frameEnd - m_CaptureStart));
+		file << "{\"name\":\"EndFrame\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":1,\"ts\":" << buffer << "}";
+	}
+
+	for (const TraceEvent& event : m_TraceEvents)
+	{
+		separate();
+		file << "{\"name\":\"" << EscapeJson(m_Nodes[event.NodeIndex].Name) << "\",\"cat\":\"BehaviorTree\",\"ph\":\"X\",\"pid\":1,\"tid\":1";
+		snprintf(buffer, sizeof(buffer), "%.3f", ToMicroseconds(event.Start - m_CaptureStart));
+		file << ",\"ts\":" << buffer;
+		snprintf(buffer, sizeof(buffer), "%.3f", ToMicroseconds(event.Duration));
+		file << ",\"dur\":" << buffer;
+		file << ",\"args\":{\"result\":\"" << ResultNames[static_cast<int>(event.Result)] << "\"}}";
+	}
+
+	file << "\n]}\n";
+	return static_cast<bool>(file);
+}
+
+//-----------------------------------------------------------------
+// REPORTING
+//-----------------------------------------------------------------
+void BehaviorTreeProfiler::PrintReport() const
+{
+	printf("--- Behavior tree profile over %u frames ---\n", m_FrameCount);
+	printf("%-40s %10s %10s %10s %10s %14s %14s\n", "Node", "Calls", "Success", "Failure", "Running", "Inclusive (us)", "Exclusive (us)");
+
+	// Depth first, so the report reads like the tree
+	std::vector<std::pair<int, int>> stack{};
+	for (auto it = m_Roots.rbegin(); it != m_Roots.rend(); ++it)
+		stack.emplace_back(*it, 0);
+
+	while (!stack.empty())
+	{
+		const int nodeIndex = stack.back().first;
+		const int depth = stack.back().second;
+		stack.pop_back();
+
+		const BehaviorNodeStats& stats = m_Nodes[nodeIndex];
+		const std::string label = std::string(depth * 2, ' ') + stats.Name;
+		printf("%-40s %10u %10u %10u %10u %14.2f %14.2f\n", label.c_str(), stats.Total.Calls,
+			stats.Total.Results[static_cast<int>(BehaviorState::Success)],
+			stats.Total.Results[static_cast<int>(BehaviorState::Failure)],
+			stats.Total.Results[static_cast<int>(BehaviorState::Running)],
+			stats.Total.InclusiveSeconds * 1000000.0, stats.Total.ExclusiveSeconds * 1000000.0);
+
+		for (auto it = stats.Children.rbegin(); it != stats.Children.rend(); ++it)
+			stack.emplace_back(*it, depth + 1);
+	}
+}
+
+void BehaviorTreeProfiler::RenderImGui() const
+{
+	if (!ImGui::Begin("Behavior Tree Profiler"))
+	{
+		ImGui::End();
+		return;
+	}
+
+	const unsigned int windowFrames = GetWindowFrameCount();
+	ImGui::Text("Frames: %u (averaged over the last %u)", m_FrameCount, windowFrames);
+	if (IsCapturing())
+		ImGui::Text("Capturing trace: %u frames left, %u events", m_CaptureFramesLeft, static_cast<unsigned int>(m_TraceEvents.size()));
+	ImGui::Separator();
+
+	// The bars show the share of the root time that is spent inside each node
+	ImGui::Columns(5, "BehaviorTreeProfilerColumns");
+	ImGui::Text("Node");
+	ImGui::NextColumn();
+	ImGui::Text("Inclusive (us/frame)");
+	ImGui::NextColumn();
+	ImGui::Text("Exclusive (us/frame)");
+	ImGui::NextColumn();
+	ImGui::Text("Calls/frame");
+	ImGui::NextColumn();
+	ImGui::Text("S / F / R");
+	ImGui::NextColumn();
+	ImGui::Separator();
+
+	for (int rootIndex : m_Roots)
+		RenderNode(rootIndex, m_Nodes[rootIndex].Window.InclusiveSeconds);
+
+	ImGui::Columns(1);
+	ImGui::End();
+}
+
+void BehaviorTreeProfiler::RenderNode(int nodeIndex, double rootSeconds) const
+{
+	const BehaviorNodeStats& stats = m_Nodes[nodeIndex];
+	const BehaviorNodeSample& window = stats.Window;
+	const double frames = GetWindowFrameCount() > 0 ? static_cast<double>(GetWindowFrameCount()) : 1.0;
+
+	bool isOpen = false;
+	if (stats.Children.empty())
+	{
+		ImGui::Bullet();
+		ImGui::Text("%s", stats.Name.c_str());
+	}
+	else
+	{
+		isOpen = ImGui::TreeNode(stats.pBehavior, "%s", stats.Name.c_str());
+	}
+	ImGui::NextColumn();
+
+	char overlay[32]{};
+	snprintf(overlay, sizeof(overlay), "%.2f", window.InclusiveSeconds * 1000000.0 / frames);
+	const float fraction = rootSeconds > 0.0 ? static_cast<float>(window.InclusiveSeconds / rootSeconds) : 0.f;
+	ImGui::ProgressBar(fraction, ImVec2(-1, 0), overlay);
+	ImGui::NextColumn();
+	ImGui::Text("%.2f", window.ExclusiveSeconds * 1000000.0 / frames);
+	ImGui::NextColumn();
+	ImGui::Text("%.1f", window.Calls / frames);
+	ImGui::NextColumn();
+	ImGui::Text("%u / %u / %u",
+		stats.LastFrame.Results[static_cast<int>(BehaviorState::Success)],
+		stats.LastFrame.Results[static_cast<int>(BehaviorState::Failure)],
+		stats.LastFrame.Results[static_cast<int>(BehaviorState::Running)]);
+	ImGui::NextColumn();
+
+	if (isOpen)
+	{
+		for (int childIndex : stats.Children)
+			RenderNode(childIndex, rootSeconds);
+		ImGui::TreePop();
+	}
+}
@@ -0,0 +1,139 @@
+/*=============================================================================*/
+// EBehaviorTreeProfiler.h: Per-node instrumentation of behavior trees
+/*=============================================================================*/
+#ifndef ELITE_BEHAVIOR_TREE_PROFILER
+#define ELITE_BEHAVIOR_TREE_PROFILER
+
+//--- Includes ---
+#include <chrono>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+// Compile-time switch, IBehavior::Execute and the flat interpreter only call into the profiler when this is 1.
+// Define it for the whole project (e.g. in the preprocessor definitions), the profiler costs nothing when it is 0.
+#ifndef ELITE_BT_PROFILING
+#define ELITE_BT_PROFILING 0
+#endif
+
+namespace Elite
+{
+	class IBehavior;
+	enum class BehaviorState;
+
+	// Counters of one node, for a single frame or summed over several
+	struct BehaviorNodeSample
+	{
+		unsigned int Calls{};
+		unsigned int Results[3]{}; // Indexed by BehaviorState
+		double InclusiveSeconds{};
+		double ExclusiveSeconds{};
+
+		BehaviorNodeSample& operator+=(const BehaviorNodeSample& other);
+		BehaviorNodeSample& operator-=(const BehaviorNodeSample& other);
+	};
+
+	struct BehaviorNodeStats
+	{
+		const IBehavior* pBehavior{ nullptr };
+		std::string Name{};
+		int ParentIndex{ -1 };
+		std::vector<int> Children{};
+
+		BehaviorNodeSample Frame{};
+		BehaviorNodeSample LastFrame{};
+		BehaviorNodeSample Window{};
+		BehaviorNodeSample Total{};
+		std::vector<BehaviorNodeSample> History{}; // Ring buffer of the last WindowSize frames
+	};
+
+	//--- PROFILER ---
+	// Records call counts, results and inclusive/exclusive time of every behavior that runs with ELITE_BT_PROFILING on.
+	// The hierarchy is learned from the nesting of the calls, so a node only shows up once it ran.
+	// Counters are kept for the running frame, the last frame, a sliding window and the whole run.
+	// Single-threaded: only profile trees that are ticked on the main thread.
+	class BehaviorTreeProfiler final
+	{
+	public:
+		using Clock = std::chrono::high_resolution_clock;
+
+		static constexpr unsigned int WindowSize{ 120 };
+		static constexpr size_t MaxTraceEvents{ 1 << 20 };
+
+		static BehaviorTreeProfiler& GetInstance();
+
+		BehaviorTreeProfiler(const BehaviorTreeProfiler& other) = delete;
+		BehaviorTreeProfiler& operator=(const BehaviorTreeProfiler& other) = delete;
+		BehaviorTreeProfiler(BehaviorTreeProfiler&& other) = delete;
+		BehaviorTreeProfiler& operator=(BehaviorTreeProfiler&& other) = delete;
+
+		// Enter and Exit have to be balanced, prefer the Scope helper
+		void Enter(const IBehavior* pBehavior);
+		void Exit(BehaviorState result);
+
+		class Scope final
+		{
+		public:
+			explicit Scope(const IBehavior* pBehavior) { GetInstance().Enter(pBehavior); }
+			~Scope() = default;
+
+			Scope(const Scope& other) = delete;
+			Scope& operator=(const Scope& other) = delete;
+			Scope(Scope&& other) = delete;
+			Scope& operator=(Scope&& other) = delete;
+
+			BehaviorState Exit(BehaviorState result) { GetInstance().Exit(result); return result; }
+		};
+
+		void EndFrame();
+		void Reset();
+
+		unsigned int GetFrameCount() const { return m_FrameCount; }
+		const std::vector<BehaviorNodeStats>& GetNodeStats() const { return m_Nodes; }
+
+		// Records every Enter/Exit pair of the next frames as a trace event
+		void StartCapture(unsigned int frameCount);
+		bool IsCapturing() const { return m_CaptureFramesLeft > 0; }
+		// Writes the captured events in the Chrome trace event format (chrome://tracing, Perfetto)
+		bool ExportChromeTrace(const std::string& path) const;
+
+		void PrintReport() const;
+		void RenderImGui() const;
+
+	private:
+		struct ActiveNode
+		{
+			int NodeIndex;
+			Clock::time_point Start;
+			Clock::duration ChildTime;
+		};
+
+		struct TraceEvent
+		{
+			int NodeIndex;
+			BehaviorState Result;
+			Clock::time_point Start;
+			Clock::duration Duration;
+		};
+
+		std::vector<BehaviorNodeStats> m_Nodes{};
+		std::unordered_map<const IBehavior*, int> m_NodeIndices{};
+		std::vector<int> m_Roots{};
+		std::vector<ActiveNode> m_Stack{};
+		unsigned int m_FrameCount{ 0 };
+
+		std::vector<TraceEvent> m_TraceEvents{};
+		std::vector<Clock::time_point> m_TraceFrames{};
+		Clock::time_point m_CaptureStart{};
+		unsigned int m_CaptureFramesLeft{ 0 };
+
+		BehaviorTreeProfiler() = default;
+		~BehaviorTreeProfiler() = default;
+
+		int GetNodeIndex(const IBehavior* pBehavior);
+		unsigned int GetWindowFrameCount() const;
+		void RenderNode(int nodeIndex, double rootSeconds) const;
+	};
+}
+#endif
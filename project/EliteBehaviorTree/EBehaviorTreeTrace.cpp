@@ -0,0 +1,576 @@
+//=== General Includes ===
+#include "stdafx.h"
+#include "EBehaviorTreeTrace.h"
+#include "EFlatBehaviorTree.h"
+
+#include <chrono>
+#include <fstream>
+#include <iterator>
+using namespace Elite;
+
+constexpr size_t BehaviorTraceRecorder::DefaultCapacity;
+constexpr uint32_t BehaviorTraceRecorder::KeyframeInterval;
+constexpr uint32_t BehaviorTraceRecorder::KeyframeSlotCount;
+
+// Format of Capture and Save:
+//	"EBTT" varint(version)
+//	varint(watched value count) { varint(name length) name }
+//	records: varint(payload size) payload
+//	payload: flags (1 = keyframe)
+//	         varint(tick) absolute in a keyframe, otherwise the distance to the previous tick
+//	         keyframe: varint(node count) u64(structure hash) u32(time bits)
+//	         u32(delta time bits)
+//	         keyframe: varint(count) { varint(memory composite) varint(running child) }
+//	         varint(count) { varint(slot - previous slot - 1) }
+//	         varint(count) { varint(value - previous value - 1) u32(float bits) }, every value in a keyframe
+//	         varint(count) { varint(zigzag(node - previous node) << 2 | state) }
+//	         root state
+// Integers are little endian. The time of a tick that is not a keyframe is the previous time plus its delta time.
+// Only the indices of the slots that changed are stored, not their contents: most slots hold pointers into the game.
+// A watched value that is not stored keeps its value of the previous tick.
+namespace
+{
+	const char TraceMagic[4]{ 'E', 'B', 'T', 'T' };
+	constexpr uint32_t TraceVersion{ 3 };
+	constexpr uint8_t KeyframeFlag{ 1 };
+
+	constexpr size_t MaxVarintSize{ 10 };
+
+	const char* const StateNames[3]{ "Failure", "Success", "Running" };
+
+	size_t EncodeVarint(uint8_t(&bytes)[MaxVarintSize], uint64_t value)
+	{
+		size_t size = 0;
+		while (value >= 0x80)
+		{
+			bytes[size++] = static_cast<uint8_t>(value | 0x80);
+			value >>= 7;
+		}
+		bytes[size++] = static_cast<uint8_t>(value);
+		return size;
+	}
+
+	void WriteFixed(std::vector<uint8_t>& bytes, uint64_t value, unsigned int byteCount)
+	{
+		for (unsigned int i = 0; i < byteCount; ++i)
+			bytes.push_back(static_cast<uint8_t>(value >> (8 * i)));
+	}
+
+	uint32_t FloatBits(float value)
+	{
+		uint32_t bits{};
+		std::memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	float BitsFloat(uint32_t bits)
+	{
+		float value{};
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	class TraceReader final
+	{
+	public:
+		TraceReader(const std::vector<uint8_t>& bytes, size_t position, size_t end)
+			: m_Bytes(bytes), m_Position(position), m_End(end) {}
+
+		bool IsValid() const { return m_IsValid; }
+		size_t GetPosition() const { return m_Position; }
+
+		uint64_t ReadVarint()
+		{
+			uint64_t value{ 0 };
+			for (unsigned int shift = 0; shift < 64; shift += 7)
+			{
+				const uint8_t byte = ReadByte();
+				value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+				if ((byte & 0x80) == 0)
+					return value;
+			}
+			m_IsValid = false;
+			return 0;
+		}
+
+		uint64_t ReadFixed(unsigned int byteCount)
+		{
+			uint64_t value{ 0 };
+			for (unsigned int i = 0; i < byteCount; ++i)
+				value |= static_cast<uint64_t>(ReadByte()) << (8 * i);
+			return value;
+		}
+
+		uint8_t ReadByte()
+		{
+			if (m_Position >= m_End)
+			{
+				m_IsValid = false;
+				return 0;
+			}
+			return m_Bytes[m_Position++];
+		}
+
+	private:
+		const std::vector<uint8_t>& m_Bytes;
+		size_t m_Position;
+		size_t m_End;
+		bool m_IsValid{ true };
+	};
+
+	int32_t UnZigZag(uint64_t value)
+	{
+		const uint32_t bits = static_cast<uint32_t>(value);
+		return static_cast<int32_t>(bits >> 1) ^ -static_cast<int32_t>(bits & 1);
+	}
+}
+
+//-----------------------------------------------------------------
+// RECORDER
+//-----------------------------------------------------------------
+BehaviorTraceRecorder::BehaviorTraceRecorder(size_t capacity)
+	: m_pRing(new std::atomic<uint8_t>[capacity]),
+	m_Capacity(capacity),
+	m_pKeyframePositions(new std::atomic<uint64_t>[KeyframeSlotCount])
+{
+	for (size_t i = 0; i < m_Capacity; ++i)
+		m_pRing[i].store(0, std::memory_order_relaxed);
+	for (uint32_t i = 0; i < KeyframeSlotCount; ++i)
+		m_pKeyframePositions[i].store(0, std::memory_order_relaxed);
+}
+
+void BehaviorTraceRecorder::WatchValue(const std::string& name, const float* pValue)
+{
+	assert(m_TickCount == 0 && !m_IsRecordingTick && "Values can only be watched before the first tick");
+	m_WatchedValues.push_back(WatchedValue{ name, pValue, nullptr });
+}
+
+void BehaviorTraceRecorder::WatchValue(const std::string& name, const bool* pValue)
+{
+	assert(m_TickCount == 0 && !m_IsRecordingTick && "Values can only be watched before the first tick");
+	m_WatchedValues.push_back(WatchedValue{ name, nullptr, pValue });
+}
+
+void BehaviorTraceRecorder::BeginTick(const BehaviorTreeContext& context, const Blackboard* pBlackBoard, const FlatBehaviorTree& tree)
+{
+	m_IsRecordingTick = true;
+	m_IsKeyframe = m_NeedsKeyframe || m_TickCount % KeyframeInterval == 0;
+	m_TickBytes.clear();
+	m_EventBytes.clear();
+	m_EventCount = 0;
+	m_LastNodeIndex = 0;
+
+	m_TickBytes.push_back(m_IsKeyframe ? KeyframeFlag : 0);
+	WriteVarint(m_TickBytes, m_IsKeyframe ? context.Tick : context.Tick - m_LastTick);
+	m_LastTick = context.Tick;
+	if (m_IsKeyframe)
+	{
+		WriteVarint(m_TickBytes, tree.GetNodes().size());
+		WriteFixed(m_TickBytes, tree.GetStructureHash(), 8);
+		WriteFixed(m_TickBytes, FloatBits(context.Time), 4);
+	}
+	WriteFixed(m_TickBytes, FloatBits(context.DeltaTime), 4);
+
+	if (m_IsKeyframe)
+	{
+		const std::vector<uint32_t>& runningChildren = tree.GetRunningChildren();
+		const size_t runningCount = runningChildren.size() - std::count(runningChildren.begin(), runningChildren.end(), 0u);
+		WriteVarint(m_TickBytes, runningCount);
+		for (uint32_t i = 0; i < runningChildren.size(); ++i)
+		{
+			if (runningChildren[i] == 0)
+				continue;
+			WriteVarint(m_TickBytes, i);
+			WriteVarint(m_TickBytes, runningChildren[i]);
+		}
+	}
+
+	// The slots that changed version since the previous tick
+	const unsigned int slotCount = pBlackBoard ? pBlackBoard->GetSlotCount() : 0;
+	m_SlotVersions.resize(slotCount, 0);
+	unsigned int changedCount = 0;
+	for (unsigned int i = 0; i < slotCount; ++i)
+		changedCount += pBlackBoard->GetVersion(i) != m_SlotVersions[i] ? 1 : 0;
+
+	WriteVarint(m_TickBytes, changedCount);
+	unsigned int nextSlot = 0;
+	for (unsigned int i = 0; i < slotCount; ++i)
+	{
+		if (pBlackBoard->GetVersion(i) == m_SlotVersions[i])
+			continue;
+
+		WriteVarint(m_TickBytes, i - nextSlot);
+		nextSlot = i + 1;
+		m_SlotVersions[i] = pBlackBoard->GetVersion(i);
+	}
+
+	// The watched values that changed since the previous tick, every value in a keyframe
+	const unsigned int valueCount = static_cast<unsigned int>(m_WatchedValues.size());
+	m_ValueBits.resize(valueCount, 0);
+	unsigned int changedValueCount = 0;
+	for (unsigned int i = 0; i < valueCount; ++i)
+		changedValueCount += m_IsKeyframe || GetWatchedBits(i) != m_ValueBits[i] ? 1 : 0;
+
+	WriteVarint(m_TickBytes, changedValueCount);
+	unsigned int nextValue = 0;
+	for (unsigned int i = 0; i < valueCount; ++i)
+	{
+		const uint32_t bits = GetWatchedBits(i);
+		if (!m_IsKeyframe && bits == m_ValueBits[i])
+			continue;
+
+		WriteVarint(m_TickBytes, i - nextValue);
+		WriteFixed(m_TickBytes, bits, 4);
+		nextValue = i + 1;
+		m_ValueBits[i] = bits;
+	}
+}
+
+uint32_t BehaviorTraceRecorder::GetWatchedBits(unsigned int index) const
+{
+	const WatchedValue& watched = m_WatchedValues[index];
+	return FloatBits(watched.pFloat ? *watched.pFloat : (*watched.pBool ? 1.f : 0.f));
+}
+
+std::vector<uint8_t> BehaviorTraceRecorder::MakeHeader() const
+{
+	std::vector<uint8_t> bytes{ TraceMagic, TraceMagic + sizeof(TraceMagic) };
+	WriteVarint(bytes, TraceVersion);
+	WriteVarint(bytes, m_WatchedValues.size());
+	for (const WatchedValue& watched : m_WatchedValues)
+	{
+		WriteVarint(bytes, watched.Name.size());
+		bytes.insert(bytes.end(), watched.Name.begin(), watched.Name.end());
+	}
+	return bytes;
+}
+
+void BehaviorTraceRecorder::EndTick(BehaviorState rootState)
+{
+	if (!m_IsRecordingTick)
+		return;
+	m_IsRecordingTick = false;
+
+	uint8_t eventCount[MaxVarintSize]{};
+	const size_t eventCountSize = EncodeVarint(eventCount, m_EventCount);
+	m_EventBytes.push_back(static_cast<uint8_t>(rootState));
+
+	const size_t payloadSize = m_TickBytes.size() + eventCountSize + m_EventBytes.size();
+	uint8_t size[MaxVarintSize]{};
+	const size_t sizeSize = EncodeVarint(size, payloadSize);
+	const size_t recordSize = sizeSize + payloadSize;
+
+	// A tick that does not fit is lost, the next one has to be a keyframe because it can not be decoded relative to it
+	++m_TickCount;
+	if (recordSize > m_Capacity)
+	{
+		++m_DroppedTickCount;
+		m_NeedsKeyframe = true;
+		return;
+	}
+	m_NeedsKeyframe = false;
+
+	// The reserved position is published before the bytes, so a reader that sees one of the new bytes also sees
+	// that the record it belonged to was overwritten
+	const uint64_t position = m_Head.load(std::memory_order_relaxed);
+	m_Reserved.store(position + recordSize, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	uint64_t writePosition = position;
+	WriteRing(size, sizeSize, writePosition);
+	writePosition += sizeSize;
+	WriteRing(m_TickBytes.data(), m_TickBytes.size(), writePosition);
+	writePosition += m_TickBytes.size();
+	WriteRing(eventCount, eventCountSize, writePosition);
+	writePosition += eventCountSize;
+	WriteRing(m_EventBytes.data(), m_EventBytes.size(), writePosition);
+
+	if (m_IsKeyframe)
+	{
+		const uint64_t keyframeCount = m_KeyframeCount.load(std::memory_order_relaxed);
+		m_pKeyframePositions[keyframeCount % KeyframeSlotCount].store(position, std::memory_order_relaxed);
+		m_KeyframeCount.store(keyframeCount + 1, std::memory_order_release);
+	}
+	m_Head.store(position + recordSize, std::memory_order_release);
+}
+
+void BehaviorTraceRecorder::WriteRing(const uint8_t* pBytes, size_t count, uint64_t position)
+{
+	for (size_t i = 0; i < count; ++i)
+		m_pRing[(position + i) % m_Capacity].store(pBytes[i], std::memory_order_relaxed);
+}
+
+std::vector<uint8_t> BehaviorTraceRecorder::Capture() const
+{
+	std::vector<uint8_t> bytes = MakeHeader();
+	const size_t headerSize = bytes.size();
+
+	// Only fails when the ring is overwritten while it is copied, which takes a few ticks in a row
+	for (unsigned int attempt = 0; attempt < 4; ++attempt)
+	{
+		const uint64_t head = m_Head.load(std::memory_order_acquire);
+		const uint64_t keyframeCount = m_KeyframeCount.load(std::memory_order_acquire);
+
+		// Oldest keyframe that is still in the ring
+		uint64_t start = head;
+		for (uint64_t i = keyframeCount; i > 0 && keyframeCount - i < KeyframeSlotCount; --i)
+		{
+			const uint64_t position = m_pKeyframePositions[(i - 1) % KeyframeSlotCount].load(std::memory_order_relaxed);
+			if (position >= head)
+				continue;
+			if (position > start || head - position > m_Capacity)
+				break;
+			start = position;
+		}
+
+		bytes.resize(headerSize);
+		for (uint64_t position = start; position < head; ++position)
+			bytes.push_back(m_pRing[position % m_Capacity].load(std::memory_order_relaxed));
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (m_Reserved.load(std::memory_order_relaxed) - start <= m_Capacity)
+			return bytes;
+	}
+
+	bytes.resize(headerSize);
+	return bytes;
+}
+
+bool BehaviorTraceRecorder::Save(const std::string& path) const
+{
+	std::ofstream file{ path, std::ios::binary };
+	if (!file)
+		return false;
+
+	const std::vector<uint8_t> bytes = Capture();
+	file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+	return static_cast<bool>(file);
+}
+
+//-----------------------------------------------------------------
+// DECODING
+//-----------------------------------------------------------------
+bool BehaviorTrace::Decode(const std::vector<uint8_t>& bytes, BehaviorTrace& trace)
+{
+	trace = BehaviorTrace{};
+	if (bytes.size() < sizeof(TraceMagic) || !std::equal(TraceMagic, TraceMagic + sizeof(TraceMagic), bytes.begin()))
+		return false;
+
+	TraceReader header{ bytes, sizeof(TraceMagic), bytes.size() };
+	if (header.ReadVarint() != TraceVersion || !header.IsValid())
+		return false;
+
+	const uint64_t valueCount = header.ReadVarint();
+	for (uint64_t i = 0; i < valueCount && header.IsValid(); ++i)
+	{
+		const uint64_t nameLength = header.ReadVarint();
+		std::string name{};
+		for (uint64_t c = 0; c < nameLength && header.IsValid(); ++c)
+			name.push_back(static_cast<char>(header.ReadByte()));
+		trace.ValueNames.push_back(std::move(name));
+	}
+	if (!header.IsValid())
+		return false;
+
+	size_t position = header.GetPosition();
+	while (position < bytes.size())
+	{
+		TraceReader sizeReader{ bytes, position, bytes.size() };
+		const uint64_t payloadSize = sizeReader.ReadVarint();
+		if (!sizeReader.IsValid() || payloadSize > bytes.size() - sizeReader.GetPosition())
+			return false;
+
+		const size_t end = sizeReader.GetPosition() + static_cast<size_t>(payloadSize);
+		TraceReader reader{ bytes, sizeReader.GetPosition(), end };
+		position = end;
+
+		BehaviorTraceTick tick{};
+		tick.IsKeyframe = (reader.ReadByte() & KeyframeFlag) != 0;
+		const uint32_t tickValue = static_cast<uint32_t>(reader.ReadVarint());
+		if (tick.IsKeyframe)
+		{
+			tick.Tick = tickValue;
+			const uint32_t nodeCount = static_cast<uint32_t>(reader.ReadVarint());
+			const uint64_t structureHash = reader.ReadFixed(8);
+			if (!trace.Ticks.empty() && (nodeCount != trace.NodeCount || structureHash != trace.StructureHash))
+				return false;
+			trace.NodeCount = nodeCount;
+			trace.StructureHash = structureHash;
+			tick.Time = BitsFloat(static_cast<uint32_t>(reader.ReadFixed(4)));
+		}
+		else if (!trace.Ticks.empty())
+		{
+			tick.Tick = trace.Ticks.back().Tick + tickValue;
+		}
+		else
+		{
+			return false;
+		}
+		tick.DeltaTime = BitsFloat(static_cast<uint32_t>(reader.ReadFixed(4)));
+		if (!tick.IsKeyframe)
+			tick.Time = trace.Ticks.back().Time + tick.DeltaTime;
+
+		if (tick.IsKeyframe)
+		{
+			const uint64_t runningCount = reader.ReadVarint();
+			for (uint64_t i = 0; i < runningCount && reader.IsValid(); ++i)
+			{
+				const uint32_t compositeIndex = static_cast<uint32_t>(reader.ReadVarint());
+				tick.RunningChildren.emplace_back(compositeIndex, static_cast<uint32_t>(reader.ReadVarint()));
+			}
+		}
+
+		const uint64_t slotCount = reader.ReadVarint();
+		uint32_t nextSlot = 0;
+		for (uint64_t i = 0; i < slotCount && reader.IsValid(); ++i)
+		{
+			const uint32_t slot = nextSlot + static_cast<uint32_t>(reader.ReadVarint());
+			nextSlot = slot + 1;
+			tick.ChangedSlots.push_back(slot);
+		}
+
+		// A value that was not stored did not change since the previous tick
+		if (!tick.IsKeyframe)
+			tick.Values = trace.Ticks.back().Values;
+		tick.Values.resize(trace.ValueNames.size(), 0.f);
+		const uint64_t changedValueCount = reader.ReadVarint();
+		uint32_t nextValue = 0;
+		for (uint64_t i = 0; i < changedValueCount && reader.IsValid(); ++i)
+		{
+			const uint32_t value = nextValue + static_cast<uint32_t>(reader.ReadVarint());
+			nextValue = value + 1;
+			const uint32_t bits = static_cast<uint32_t>(reader.ReadFixed(4));
+			if (value >= tick.Values.size())
+				return false;
+			tick.Values[value] = BitsFloat(bits);
+		}
+
+		const uint64_t eventCount = reader.ReadVarint();
+		uint32_t nodeIndex = 0;
+		for (uint64_t i = 0; i < eventCount && reader.IsValid(); ++i)
+		{
+			const uint64_t value = reader.ReadVarint();
+			nodeIndex += static_cast<uint32_t>(UnZigZag(value >> 2));
+			tick.Events.push_back(BehaviorTraceEvent{ nodeIndex, static_cast<BehaviorState>(value & 3) });
+		}
+		tick.RootState = static_cast<BehaviorState>(reader.ReadByte());
+
+		if (!reader.IsValid() || reader.GetPosition() != end)
+			return false;
+		trace.Ticks.push_back(std::move(tick));
+	}
+	return true;
+}
+
+bool BehaviorTrace::Load(const std::string& path, BehaviorTrace& trace)
+{
+	std::ifstream file{ path, std::ios::binary };
+	if (!file)
+		return false;
+
+	const std::vector<uint8_t> bytes{ std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+	return Decode(bytes, trace);
+}
+
+//-----------------------------------------------------------------
+// REPLAY
+//-----------------------------------------------------------------
+bool BehaviorTraceReplay::Run(FlatBehaviorTree& tree)
+{
+	m_HasDiverged = false;
+	m_ReplayedTickCount = 0;
+	m_Seconds = 0.0;
+
+	if (m_Trace.Ticks.empty())
+	{
+		m_Result = "The trace has no ticks";
+		return false;
+	}
+	if (tree.GetNodes().size() != m_Trace.NodeCount || tree.GetStructureHash() != m_Trace.StructureHash)
+	{
+		m_Result = "The trace was recorded on a tree with a different structure";
+		return false;
+	}
+
+	tree.RestoreRunningChildren(m_Trace.Ticks.front().RunningChildren);
+	tree.SetTraceReplay(this);
+
+	BehaviorTreeContext context{};
+	BehaviorTreeContext::Scope contextScope{ &context };
+	const auto start = std::chrono::high_resolution_clock::now();
+	for (const BehaviorTraceTick& tick : m_Trace.Ticks)
+	{
+		context.Tick = tick.Tick;
+		context.Time = tick.Time;
+		context.DeltaTime = tick.DeltaTime;
+		m_pTick = &tick;
+		m_NextEvent = 0;
+
+		// The leaves do not run, so there is no blackboard
+		const BehaviorState rootState = tree.Execute(nullptr);
+		if (!m_HasDiverged && m_NextEvent != tick.Events.size())
+		{
+			m_HasDiverged = true;
+			m_Result = "Tick " + std::to_string(tick.Tick) + ": the tree stopped after " + std::to_string(m_NextEvent)
+				+ " of " + std::to_string(tick.Events.size()) + " recorded nodes";
+		}
+		if (!m_HasDiverged && rootState != tick.RootState)
+		{
+			m_HasDiverged = true;
+			m_Result = "Tick " + std::to_string(tick.Tick) + ": the root ended in " + StateNames[static_cast<int>(rootState)]
+				+ " instead of " + StateNames[static_cast<int>(tick.RootState)];
+		}
+		if (m_HasDiverged)
+			break;
+		++m_ReplayedTickCount;
+	}
+	m_Seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+	tree.SetTraceReplay(nullptr);
+	m_pTick = nullptr;
+	if (!m_HasDiverged)
+		m_Result = "Replayed " + std::to_string(m_ReplayedTickCount) + " ticks without a difference";
+	return !m_HasDiverged;
+}
+
+BehaviorState BehaviorTraceReplay::ReplayLeaf(uint32_t nodeIndex) const
+{
+	// A leaf that is not the next recorded node fails, CheckNode reports it right after
+	if (m_HasDiverged || m_NextEvent >= m_pTick->Events.size() || m_pTick->Events[m_NextEvent].NodeIndex != nodeIndex)
+		return BehaviorState::Failure;
+	return m_pTick->Events[m_NextEvent].State;
+}
+
+void BehaviorTraceReplay::CheckNode(uint32_t nodeIndex, BehaviorState state)
+{
+	if (m_HasDiverged)
+		return;
+
+	if (m_NextEvent < m_pTick->Events.size())
+	{
+		const BehaviorTraceEvent& event = m_pTick->Events[m_NextEvent];
+		if (event.NodeIndex == nodeIndex && event.State == state)
+		{
+			++m_NextEvent;
+			return;
+		}
+	}
+	Diverge(nodeIndex, state);
+}
+
+void BehaviorTraceReplay::Diverge(uint32_t nodeIndex, BehaviorState state)
+{
+	m_HasDiverged = true;
+	m_Result = "Tick " + std::to_string(m_pTick->Tick) + ", event " + std::to_string(m_NextEvent) + ": node "
+		+ std::to_string(nodeIndex) + " finished with " + StateNames[static_cast<int>(state)];
+
+	if (m_NextEvent < m_pTick->Events.size())
+	{
+		const BehaviorTraceEvent& event = m_pTick->Events[m_NextEvent];
+		m_Result += ", the recording has node " + std::to_string(event.NodeIndex) + " with " + StateNames[static_cast<int>(event.State)];
+	}
+	else
+	{
+		m_Result += ", the recording has no more nodes";
+	}
+}
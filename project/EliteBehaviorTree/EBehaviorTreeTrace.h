@@ -0,0 +1,200 @@
+/*=============================================================================*/
+// EBehaviorTreeTrace.h: Recording of the path through a behavior tree and its offline replay
+/*=============================================================================*/
+#ifndef ELITE_BEHAVIOR_TREE_TRACE
+#define ELITE_BEHAVIOR_TREE_TRACE
+
+//--- Includes ---
+#include "EBehaviorTree.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Elite
+{
+	class FlatBehaviorTree;
+
+	// A node of the flat tree that finished, with its state
+	struct BehaviorTraceEvent
+	{
+		uint32_t NodeIndex;
+		BehaviorState State;
+	};
+
+	struct BehaviorTraceTick
+	{
+		uint32_t Tick = 0;
+		float Time = 0.f;
+		float DeltaTime = 0.f;
+		BehaviorState RootState = BehaviorState::Failure;
+		bool IsKeyframe = false;
+		std::vector<std::pair<uint32_t, uint32_t>> RunningChildren = {}; // Keyframes only: memory composite, running child
+		std::vector<uint32_t> ChangedSlots = {};                         // Blackboard slots that changed since the previous tick
+		std::vector<float> Values = {};                                  // Watched values at the start of the tick, see WatchValue
+		std::vector<BehaviorTraceEvent> Events = {};                     // In the order the nodes finished
+	};
+
+	// Decoded recording, starts at a keyframe
+	struct BehaviorTrace
+	{
+		uint32_t NodeCount = 0;
+		uint64_t StructureHash = 0;
+		std::vector<std::string> ValueNames = {}; // Of BehaviorTraceTick::Values
+		std::vector<BehaviorTraceTick> Ticks = {};
+
+		// Both return false when the bytes are not a trace, see BehaviorTraceRecorder::Capture for the format
+		static bool Decode(const std::vector<uint8_t>& bytes, BehaviorTrace& trace);
+		static bool Load(const std::string& path, BehaviorTrace& trace);
+	};
+
+	//-----------------------------------------------------------------
+	// TRACE RECORDER
+	//-----------------------------------------------------------------
+	// Records every tick of a compiled BehaviorTree into a ring buffer: each node that finished with its state, the delta
+	// time and which blackboard slots changed version since the previous tick. A node index is stored as the varint of
+	// its distance to the previous node, packed with the state, so most ticks take a few dozen bytes. The contents of the
+	// slots are not recorded, most of them are pointers into the game that mean nothing outside of it. The values the
+	// owner registered with WatchValue are recorded instead, only when they changed. Every KeyframeInterval ticks a
+	// keyframe stores the running children of the memory composites and every watched value, decoding starts at the
+	// oldest keyframe left in the ring.
+	//
+	// A tick is encoded on the ticking thread and copied into the ring when it ends. Capture can be called from any
+	// thread without a lock: it copies the ring and drops whatever the ticking thread overwrote in the meantime.
+	class BehaviorTraceRecorder final
+	{
+	public:
+		static constexpr size_t DefaultCapacity{ 1 << 20 };
+		static constexpr uint32_t KeyframeInterval{ 120 };
+
+		explicit BehaviorTraceRecorder(size_t capacity = DefaultCapacity);
+		~BehaviorTraceRecorder() = default;
+
+		BehaviorTraceRecorder(const BehaviorTraceRecorder& other) = delete;
+		BehaviorTraceRecorder& operator=(const BehaviorTraceRecorder& other) = delete;
+		BehaviorTraceRecorder(BehaviorTraceRecorder&& other) = delete;
+		BehaviorTraceRecorder& operator=(BehaviorTraceRecorder&& other) = delete;
+
+		// Read at the start of every tick, a bool is recorded as 0 or 1. Only before the first tick: the names are
+		// part of the header of every capture.
+		void WatchValue(const std::string& name, const float* pValue);
+		void WatchValue(const std::string& name, const bool* pValue);
+
+		// Called by BehaviorTree::Update around the execution of the flat tree
+		void BeginTick(const BehaviorTreeContext& context, const Blackboard* pBlackBoard, const FlatBehaviorTree& tree);
+		void EndTick(BehaviorState rootState);
+
+		// Called by the flat interpreter for every node that finished
+		void RecordNode(uint32_t nodeIndex, BehaviorState state)
+		{
+			const int32_t distance = static_cast<int32_t>(nodeIndex - m_LastNodeIndex);
+			m_LastNodeIndex = nodeIndex;
+			WriteVarint(m_EventBytes, (ZigZag(distance) << 2) | static_cast<uint32_t>(state));
+			++m_EventCount;
+		}
+
+		// Header followed by the records from the oldest keyframe on, safe from any thread
+		std::vector<uint8_t> Capture() const;
+		bool Save(const std::string& path) const;
+
+		uint64_t GetRecordedTickCount() const { return m_TickCount; }
+		uint64_t GetDroppedTickCount() const { return m_DroppedTickCount; }
+		uint64_t GetWrittenByteCount() const { return m_Head.load(std::memory_order_relaxed); }
+
+		static void WriteVarint(std::vector<uint8_t>& bytes, uint64_t value)
+		{
+			while (value >= 0x80)
+			{
+				bytes.push_back(static_cast<uint8_t>(value | 0x80));
+				value >>= 7;
+			}
+			bytes.push_back(static_cast<uint8_t>(value));
+		}
+		static uint64_t ZigZag(int32_t value) { return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31); }
+
+	private:
+		static constexpr uint32_t KeyframeSlotCount{ 256 };
+
+		struct WatchedValue
+		{
+			std::string Name;
+			const float* pFloat;
+			const bool* pBool;
+		};
+
+		// Positions in the ring only grow, the byte of position p is at p % m_Capacity
+		std::unique_ptr<std::atomic<uint8_t>[]> m_pRing;
+		const size_t m_Capacity;
+		std::atomic<uint64_t> m_Head{ 0 };     // End of the last complete record
+		std::atomic<uint64_t> m_Reserved{ 0 }; // End of the record that is being copied in
+		std::unique_ptr<std::atomic<uint64_t>[]> m_pKeyframePositions;
+		std::atomic<uint64_t> m_KeyframeCount{ 0 };
+
+		// Tick that is being encoded
+		bool m_IsRecordingTick = false;
+		bool m_IsKeyframe = false;
+		std::vector<uint8_t> m_TickBytes = {};
+		std::vector<uint8_t> m_EventBytes = {};
+		uint32_t m_EventCount = 0;
+		uint32_t m_LastNodeIndex = 0;
+
+		uint32_t m_LastTick = 0;
+		uint64_t m_TickCount = 0;
+		uint64_t m_DroppedTickCount = 0;
+		bool m_NeedsKeyframe = true;
+		std::vector<uint32_t> m_SlotVersions = {};
+		std::vector<WatchedValue> m_WatchedValues = {};
+		std::vector<uint32_t> m_ValueBits = {};
+
+		uint32_t GetWatchedBits(unsigned int index) const;
+		std::vector<uint8_t> MakeHeader() const;
+		void WriteRing(const uint8_t* pBytes, size_t count, uint64_t position);
+	};
+
+	//-----------------------------------------------------------------
+	// TRACE REPLAY
+	//-----------------------------------------------------------------
+	// Runs a recording on a flat tree with the same structure. The leaves (conditions, actions and external behaviors)
+	// never run: the recording has no game state to run them against, so they return their recorded state. Every node
+	// that finishes has to match the recording in order. A replay therefore only checks the composites, the decorators
+	// and the interpreter on the real paths of the agent, a change inside a condition or an action goes unnoticed.
+	// Run also times the interpreter on those paths.
+	class BehaviorTraceReplay final
+	{
+	public:
+		explicit BehaviorTraceReplay(const BehaviorTrace& trace) : m_Trace(trace) {}
+		~BehaviorTraceReplay() = default;
+
+		BehaviorTraceReplay(const BehaviorTraceReplay& other) = delete;
+		BehaviorTraceReplay& operator=(const BehaviorTraceReplay& other) = delete;
+		BehaviorTraceReplay(BehaviorTraceReplay&& other) = delete;
+		BehaviorTraceReplay& operator=(BehaviorTraceReplay&& other) = delete;
+
+		// Overwrites the state of the memory composites of the tree, returns true when every tick matched
+		bool Run(FlatBehaviorTree& tree);
+
+		const std::string& GetResult() const { return m_Result; }
+		size_t GetReplayedTickCount() const { return m_ReplayedTickCount; }
+		double GetSeconds() const { return m_Seconds; }
+
+		// Called by the flat interpreter while Run executes the tree: a leaf gets the state the recording has for it,
+		// then every node that finished is checked against the recording
+		BehaviorState ReplayLeaf(uint32_t nodeIndex) const;
+		void CheckNode(uint32_t nodeIndex, BehaviorState state);
+
+	private:
+		const BehaviorTrace& m_Trace;
+		const BehaviorTraceTick* m_pTick = nullptr;
+		size_t m_NextEvent = 0;
+		bool m_HasDiverged = false;
+
+		std::string m_Result = {};
+		size_t m_ReplayedTickCount = 0;
+		double m_Seconds = 0.0;
+
+		void Diverge(uint32_t nodeIndex, BehaviorState state);
+	};
+}
+#endif
@@ -0,0 +1,311 @@
+//=== General Includes ===
+#include "stdafx.h"
+#include "EFlatBehaviorTree.h"
+#include "EBehaviorTreeMemo.h"
+#include "EBehaviorTreeTrace.h"
+
+#include <typeinfo>
+using namespace Elite;
+
+//-----------------------------------------------------------------
+// COMPILER
+//-----------------------------------------------------------------
+FlatBehaviorTree::FlatBehaviorTree(IBehavior* pRoot)
+{
+	if (pRoot)
+		Compile(pRoot, 1);
+
+	m_RunningChildren.resize(m_Nodes.size(), 0);
+}
+
+void FlatBehaviorTree::Compile(IBehavior* pBehavior, unsigned int depth)
+{
+	const uint32_t index = static_cast<uint32_t>(m_Nodes.size());
+	m_Nodes.push_back(FlatNode{});
+#if ELITE_BT_PROFILING
+	m_SourceBehaviors.push_back(pBehavior);
+#endif
+	if (m_CompositeStack.capacity() < depth)
+		m_CompositeStack.reserve(depth);
+
+	// Only the exact node types are lowered, derived behaviors (e.g. PartialSequence) keep their own Execute
+	const std::type_info& type = typeid(*pBehavior);
+	if (type == typeid(BehaviorSelector) || type == typeid(BehaviorSequence))
+	{
+		const BehaviorComposite* pComposite = static_cast<BehaviorComposite*>(pBehavior);
+		m_Nodes[index].Type = type == typeid(BehaviorSelector) ? FlatNodeType::Selector : FlatNodeType::Sequence;
+		m_Nodes[index].ChildCount = static_cast<uint16_t>(pComposite->GetChildBehaviors().size());
+
+		for (IBehavior* pChild : pComposite->GetChildBehaviors())
+			Compile(pChild, depth + 1);
+	}
+	else if (type == typeid(BehaviorMemorySelector) || type == typeid(BehaviorMemorySequence))
+	{
+		const BehaviorMemoryComposite* pComposite = static_cast<BehaviorMemoryComposite*>(pBehavior);
+		m_Nodes[index].Type = type == typeid(BehaviorMemorySelector) ? FlatNodeType::MemorySelector : FlatNodeType::MemorySequence;
+		m_Nodes[index].GuardCount = static_cast<uint8_t>(pComposite->GetInterruptGuards().size());
+		m_Nodes[index].ChildCount = static_cast<uint16_t>(pComposite->GetChildBehaviors().size());
+
+		for (IBehavior* pGuard : pComposite->GetInterruptGuards())
+			Compile(pGuard, depth + 1);
+		m_Nodes[index].FirstChildOffset = static_cast<uint32_t>(m_Nodes.size()) - index;
+
+		for (IBehavior* pChild : pComposite->GetChildBehaviors())
+			Compile(pChild, depth + 1);
+	}
+	else if (type == typeid(BehaviorConditional))
+	{
+		const BehaviorConditional* pConditional = static_cast<BehaviorConditional*>(pBehavior);
+		const ConditionFunction* pFunction = pConditional->GetConditional().target<ConditionFunction>();
+		if (pFunction && *pFunction)
+		{
+			m_Nodes[index].Type = FlatNodeType::Conditional;
+			m_Nodes[index].FunctionIndex = static_cast<uint32_t>(m_Conditions.size());
+			m_Conditions.push_back(*pFunction);
+
+			if (!pConditional->GetDependencies().IsEmpty())
+			{
+				m_Nodes[index].CacheIndex = static_cast<int32_t>(m_ConditionDependencies.size());
+				m_ConditionDependencies.push_back(pConditional->GetDependencies());
+				m_CachedConditionResults.push_back(false);
+			}
+		}
+		else
+		{
+			// Lambdas and bound functions can not be stored as a plain function pointer
+			AddExternal(pBehavior);
+		}
+	}
+	else if (type == typeid(BehaviorAction))
+	{
+		const BehaviorAction* pAction = static_cast<BehaviorAction*>(pBehavior);
+		const ActionFunction* pFunction = pAction->GetAction().target<ActionFunction>();
+		if (pFunction && *pFunction)
+		{
+			m_Nodes[index].Type = FlatNodeType::Action;
+			m_Nodes[index].FunctionIndex = static_cast<uint32_t>(m_Actions.size());
+			m_Actions.push_back(*pFunction);
+		}
+		else
+		{
+			AddExternal(pBehavior);
+		}
+	}
+	else
+	{
+		AddExternal(pBehavior);
+	}
+
+	m_Nodes[index].SubtreeSize = static_cast<uint32_t>(m_Nodes.size()) - index;
+}
+
+void FlatBehaviorTree::AddExternal(IBehavior* pBehavior)
+{
+	FlatNode& node = m_Nodes.back();
+	node.Type = FlatNodeType::External;
+	node.FunctionIndex = static_cast<uint32_t>(m_Externals.size());
+	m_Externals.push_back(pBehavior);
+}
+
+//-----------------------------------------------------------------
+// INTERPRETER
+//-----------------------------------------------------------------
+BehaviorState FlatBehaviorTree::Execute(Blackboard* pBlackBoard)
+{
+	if (m_Nodes.empty())
+		return BehaviorState::Failure;
+
+	const BehaviorTreeContext* pContext = BehaviorTreeContext::GetCurrent();
+	m_pConditionMemo = pContext ? pContext->pConditionMemo : nullptr;
+	if (m_pConditionMemo && m_pConditionMemo != m_pSlotMemo)
+		ResolveMemoSlots();
+	m_pTraceRecorder = pContext ? pContext->pTraceRecorder : nullptr;
+
+	m_CompositeStack.clear();
+	return ExecuteSubtree(0, pBlackBoard);
+}
+
+// Re-entrant for the interrupt guards, which run on top of the composite stack of the tick
+BehaviorState FlatBehaviorTree::ExecuteSubtree(uint32_t rootIndex, Blackboard* pBlackBoard)
+{
+	const size_t stackBase = m_CompositeStack.size();
+	uint32_t index = rootIndex;
+	BehaviorState state = BehaviorState::Failure;
+
+	while (true)
+	{
+		const FlatNode& node = m_Nodes[index];
+#if ELITE_BT_PROFILING
+		// Externals are profiled by their own Execute
+		if (node.Type != FlatNodeType::External)
+			BehaviorTreeProfiler::GetInstance().Enter(m_SourceBehaviors[index]);
+#endif
+		switch (node.Type)
+		{
+		case FlatNodeType::Selector:
+		case FlatNodeType::Sequence:
+		case FlatNodeType::MemorySelector:
+		case FlatNodeType::MemorySequence:
+			if (node.ChildCount > 0)
+			{
+				// Descend into the first (or running) child, the result is handled once it comes back up
+				m_CompositeStack.push_back(index);
+				const bool isMemory = node.Type == FlatNodeType::MemorySelector || node.Type == FlatNodeType::MemorySequence;
+				index = isMemory ? ResumeIndex(index, pBlackBoard) : index + node.FirstChildOffset;
+				continue;
+			}
+			state = node.Type == FlatNodeType::Selector || node.Type == FlatNodeType::MemorySelector ? BehaviorState::Failure : BehaviorState::Success;
+			break;
+		case FlatNodeType::Conditional:
+			if (m_pTraceReplay)
+				state = m_pTraceReplay->ReplayLeaf(index);
+			else
+				state = EvaluateCondition(node, pBlackBoard) ? BehaviorState::Success : BehaviorState::Failure;
+			break;
+		case FlatNodeType::Action:
+			state = m_pTraceReplay ? m_pTraceReplay->ReplayLeaf(index) : m_Actions[node.FunctionIndex](pBlackBoard);
+			break;
+		case FlatNodeType::External:
+			state = m_pTraceReplay ? m_pTraceReplay->ReplayLeaf(index) : m_Externals[node.FunctionIndex]->Execute(pBlackBoard);
+			break;
+		}
+#if ELITE_BT_PROFILING
+		if (node.Type != FlatNodeType::External)
+			BehaviorTreeProfiler::GetInstance().Exit(state);
+#endif
+		if (m_pTraceRecorder)
+			m_pTraceRecorder->RecordNode(index, state);
+		if (m_pTraceReplay)
+			m_pTraceReplay->CheckNode(index, state);
+
+		// Walk back up until a composite wants its next child
+		while (true)
+		{
+			if (m_CompositeStack.size() == stackBase)
+				return state;
+
+			const uint32_t parentIndex = m_CompositeStack.back();
+			const FlatNode& parent = m_Nodes[parentIndex];
+
+			// A selector stops on Success/Running, a sequence on Failure/Running.
+			// When all children ran, the state of the last one is also the result of the composite.
+			const bool isSelector = parent.Type == FlatNodeType::Selector || parent.Type == FlatNodeType::MemorySelector;
+			const BehaviorState continueState = isSelector ? BehaviorState::Failure : BehaviorState::Success;
+			const uint32_t nextSibling = index + m_Nodes[index].SubtreeSize;
+			if (state == continueState && nextSibling < parentIndex + parent.SubtreeSize)
+			{
+				index = nextSibling;
+				break;
+			}
+
+			if (parent.Type == FlatNodeType::MemorySelector || parent.Type == FlatNodeType::MemorySequence)
+				m_RunningChildren[parentIndex] = state == BehaviorState::Running ? index : 0;
+
+			index = parentIndex;
+			m_CompositeStack.pop_back();
+#if ELITE_BT_PROFILING
+			BehaviorTreeProfiler::GetInstance().Exit(state);
+#endif
+			if (m_pTraceRecorder)
+				m_pTraceRecorder->RecordNode(index, state);
+			if (m_pTraceReplay)
+				m_pTraceReplay->CheckNode(index, state);
+		}
+	}
+}
+
+void FlatBehaviorTree::Reset()
+{
+	if (!m_Nodes.empty())
+		ResetSubtree(0);
+}
+
+uint64_t FlatBehaviorTree::GetStructureHash() const
+{
+	// FNV-1a over the shape of every node, the functions behind the leaves are not part of it
+	uint64_t hash{ 14695981039346656037ull };
+	auto add = [&hash](uint32_t value)
+	{
+		for (unsigned int i = 0; i < 4; ++i)
+		{
+			hash ^= (value >> (8 * i)) & 0xFF;
+			hash *= 1099511628211ull;
+		}
+	};
+	for (const FlatNode& node : m_Nodes)
+	{
+		add(static_cast<uint32_t>(node.Type));
+		add(node.GuardCount);
+		add(node.ChildCount);
+		add(node.FirstChildOffset);
+		add(node.SubtreeSize);
+	}
+	return hash;
+}
+
+void FlatBehaviorTree::RestoreRunningChildren(const std::vector<std::pair<uint32_t, uint32_t>>& runningChildren)
+{
+	std::fill(m_RunningChildren.begin(), m_RunningChildren.end(), 0);
+	for (const std::pair<uint32_t, uint32_t>& runningChild : runningChildren)
+	{
+		if (runningChild.first < m_RunningChildren.size())
+			m_RunningChildren[runningChild.first] = runningChild.second;
+	}
+}
+
+bool FlatBehaviorTree::EvaluateCondition(const FlatNode& node, Blackboard* pBlackBoard)
+{
+	if (node.CacheIndex < 0)
+	{
+		if (m_pConditionMemo)
+			return m_pConditionMemo->Evaluate(m_MemoSlots[node.FunctionIndex], pBlackBoard);
+		return m_Conditions[node.FunctionIndex](pBlackBoard);
+	}
+
+	// Same caching as BehaviorConditional: only re-evaluate when a dependency changed
+	if (m_ConditionDependencies[node.CacheIndex].PollChanges(pBlackBoard))
+		m_CachedConditionResults[node.CacheIndex] = m_Conditions[node.FunctionIndex](pBlackBoard);
+	return m_CachedConditionResults[node.CacheIndex];
+}
+
+void FlatBehaviorTree::ResolveMemoSlots()
+{
+	m_pSlotMemo = m_pConditionMemo;
+	m_MemoSlots.resize(m_Conditions.size());
+	for (size_t i = 0; i < m_Conditions.size(); ++i)
+		m_MemoSlots[i] = m_pConditionMemo->GetSlot(m_Conditions[i]);
+}
+
+uint32_t FlatBehaviorTree::ResumeIndex(uint32_t index, Blackboard* pBlackBoard)
+{
+	const FlatNode& node = m_Nodes[index];
+	const uint32_t runningChild = m_RunningChildren[index];
+	if (runningChild == 0)
+		return index + node.FirstChildOffset;
+
+	m_RunningChildren[index] = 0;
+
+	// Same as BehaviorMemoryComposite: a guard that succeeds restarts the composite from its first child
+	uint32_t guardIndex = index + 1;
+	for (uint8_t i = 0; i < node.GuardCount; ++i)
+	{
+		if (ExecuteSubtree(guardIndex, pBlackBoard) == BehaviorState::Success)
+		{
+			ResetSubtree(runningChild);
+			return index + node.FirstChildOffset;
+		}
+		guardIndex += m_Nodes[guardIndex].SubtreeSize;
+	}
+	return runningChild;
+}
+
+void FlatBehaviorTree::ResetSubtree(uint32_t rootIndex)
+{
+	const uint32_t endIndex = rootIndex + m_Nodes[rootIndex].SubtreeSize;
+	for (uint32_t i = rootIndex; i < endIndex; ++i)
+	{
+		m_RunningChildren[i] = 0;
+		if (m_Nodes[i].Type == FlatNodeType::External)
+			m_Externals[m_Nodes[i].FunctionIndex]->Reset();
+	}
+}
@@ -0,0 +1,111 @@
+/*=============================================================================*/
+// EFlatBehaviorTree.h: Flat, pre-order representation of a BehaviorTree and its interpreter
+/*=============================================================================*/
+#ifndef ELITE_FLAT_BEHAVIOR_TREE
+#define ELITE_FLAT_BEHAVIOR_TREE
+
+//--- Includes ---
+#include "EBehaviorTree.h"
+
+#include <cstdint>
+
+namespace Elite
+{
+	class BehaviorTraceRecorder;
+	class BehaviorTraceReplay;
+
+	//-----------------------------------------------------------------
+	// FLAT BEHAVIOR TREE
+	//-----------------------------------------------------------------
+	enum class FlatNodeType : uint8_t
+	{
+		Selector,
+		Sequence,
+		MemorySelector,
+		MemorySequence,
+		Conditional,
+		Action,
+		External // Any other IBehavior, executed through its virtual Execute
+	};
+
+	// Nodes are stored in pre-order, so the subtree of node i is the range [i + 1, i + SubtreeSize)
+	// and i + SubtreeSize is its next sibling. Memory composites store their interrupt guard subtrees
+	// in front of their children, the first child is at i + FirstChildOffset.
+	struct FlatNode
+	{
+		FlatNodeType Type = FlatNodeType::External;
+		uint8_t GuardCount = 0;
+		uint16_t ChildCount = 0;
+		uint32_t FirstChildOffset = 1;
+		uint32_t SubtreeSize = 1;
+		uint32_t FunctionIndex = 0; // Into the condition, action or external table depending on Type
+		int32_t CacheIndex = -1;    // Conditionals with dependencies only, into the subscription table
+	};
+
+	class FlatBehaviorTree final
+	{
+	public:
+		using ConditionFunction = bool(*)(Blackboard*);
+		using ActionFunction = BehaviorState(*)(Blackboard*);
+
+		// Lowers the tree under pRoot, which has to outlive the flat tree
+		explicit FlatBehaviorTree(IBehavior* pRoot);
+		~FlatBehaviorTree() = default;
+
+		FlatBehaviorTree(const FlatBehaviorTree& other) = delete;
+		FlatBehaviorTree& operator=(const FlatBehaviorTree& other) = delete;
+		FlatBehaviorTree(FlatBehaviorTree&& other) = delete;
+		FlatBehaviorTree& operator=(FlatBehaviorTree&& other) = delete;
+
+		BehaviorState Execute(Blackboard* pBlackBoard);
+		void Reset();
+
+		const std::vector<FlatNode>& GetNodes() const { return m_Nodes; }
+		size_t GetExternalCount() const { return m_Externals.size(); }
+
+		// Changes whenever the shape of the tree changes, recordings are only replayed on a tree with the same hash
+		uint64_t GetStructureHash() const;
+		const std::vector<uint32_t>& GetRunningChildren() const { return m_RunningChildren; }
+		void RestoreRunningChildren(const std::vector<std::pair<uint32_t, uint32_t>>& runningChildren);
+		// While a replay is set the leaves return the recorded state instead of running, see BehaviorTraceReplay
+		void SetTraceReplay(BehaviorTraceReplay* pReplay) { m_pTraceReplay = pReplay; }
+
+	private:
+		std::vector<FlatNode> m_Nodes = {};
+		std::vector<ConditionFunction> m_Conditions = {};
+		std::vector<ActionFunction> m_Actions = {};
+		std::vector<IBehavior*> m_Externals = {};
+
+		std::vector<BlackboardSubscription> m_ConditionDependencies = {};
+		std::vector<bool> m_CachedConditionResults = {};
+
+		// Memo of the tree that is ticking, with the slot of every condition in it
+		BehaviorConditionMemo* m_pConditionMemo = nullptr;
+		const BehaviorConditionMemo* m_pSlotMemo = nullptr;
+		std::vector<unsigned int> m_MemoSlots = {};
+
+		// Per node, the index of the running child of a memory composite or 0 when it has none
+		std::vector<uint32_t> m_RunningChildren = {};
+
+		std::vector<uint32_t> m_CompositeStack = {};
+
+		// Recorder of the tree that is ticking, every node that finishes is passed to it
+		BehaviorTraceRecorder* m_pTraceRecorder = nullptr;
+		BehaviorTraceReplay* m_pTraceReplay = nullptr;
+
+#if ELITE_BT_PROFILING
+		// Per node, the behavior it was lowered from, so lowered nodes still show up in the profiler
+		std::vector<const IBehavior*> m_SourceBehaviors = {};
+#endif
+
+		void Compile(IBehavior* pBehavior, unsigned int depth);
+		void AddExternal(IBehavior* pBehavior);
+		void ResolveMemoSlots();
+
+		BehaviorState ExecuteSubtree(uint32_t rootIndex, Blackboard* pBlackBoard);
+		bool EvaluateCondition(const FlatNode& node, Blackboard* pBlackBoard);
+		uint32_t ResumeIndex(uint32_t index, Blackboard* pBlackBoard);
+		void ResetSubtree(uint32_t rootIndex);
+	};
+}
+#endif
@@ -0,0 +1,489 @@
+/*=============================================================================*/
+// EStaticBehaviorTree.h: Behavior tree composed at compile time out of template node types
+/*=============================================================================*/
+#ifndef ELITE_STATIC_BEHAVIOR_TREE
+#define ELITE_STATIC_BEHAVIOR_TREE
+
+//--- Includes ---
+#include "EBehaviorTree.h"
+
+// The tree is a single type, e.g.
+//	using Tree = Selector<
+//		Sequence<Condition<&BT_Conditions::HasFood>, Action<&BT_Actions::UseFood>>,
+//		Action<&BT_Actions::Explore>>;
+// Every node stores its children by value, so a tree is one object without allocations or virtual calls and
+// the compiler can inline the conditions and actions. The nodes make the same decisions as their runtime
+// counterparts in EBehaviorTree.h.
+namespace Elite
+{
+	namespace StaticBT
+	{
+		//-----------------------------------------------------------------
+		// LEAVES
+		//-----------------------------------------------------------------
+		template<bool(*Function)(Blackboard*)>
+		class Condition final
+		{
+		public:
+			BehaviorState Tick(Blackboard* pBlackBoard)
+			{
+				return Function(pBlackBoard) ? BehaviorState::Success : BehaviorState::Failure;
+			}
+			void Reset() {}
+		};
+
+		// BehaviorConditional with dependencies: only re-evaluated when one of the keys changed
+		template<bool(*Function)(Blackboard*), unsigned int... KeyIndices>
+		class CachedCondition final
+		{
+			static_assert(sizeof...(KeyIndices) > 0, "A cached condition needs at least one dependency");
+
+		public:
+			BehaviorState Tick(Blackboard* pBlackBoard)
+			{
+				if (m_Dependencies.PollChanges(pBlackBoard))
+					m_Result = Function(pBlackBoard) ? BehaviorState::Success : BehaviorState::Failure;
+				return m_Result;
+			}
+			void Reset() {}
+
+		private:
+			BlackboardSubscription m_Dependencies{ BlackboardKeyBase{ KeyIndices, nullptr }... };
+			BehaviorState m_Result = BehaviorState::Failure;
+		};
+
+		template<BehaviorState(*Function)(Blackboard*)>
+		class Action final
+		{
+		public:
+			BehaviorState Tick(Blackboard* pBlackBoard)
+			{
+				return Function(pBlackBoard);
+			}
+			void Reset() {}
+		};
+
+		//-----------------------------------------------------------------
+		// COMPOSITES
+		//-----------------------------------------------------------------
+		namespace Detail
+		{
+			// Runs the children from index first on, until one returns something else than ContinueState.
+			// When all of them ran, the composite returns ContinueState (Failure for a selector, Success for a sequence).
+			template<BehaviorState ContinueState, typename... Children>
+			class ChildList;
+
+			template<BehaviorState ContinueState>
+			class ChildList<ContinueState>
+			{
+			public:
+				BehaviorState Tick(Blackboard*, unsigned int, unsigned int, int&) { return ContinueState; }
+				void ResetChild(unsigned int, unsigned int) {}
+				void ResetAll() {}
+			};
+
+			template<BehaviorState ContinueState, typename First, typename... Rest>
+			class ChildList<ContinueState, First, Rest...>
+			{
+			public:
+				BehaviorState Tick(Blackboard* pBlackBoard, unsigned int first, unsigned int index, int& runningIndex)
+				{
+					if (index >= first)
+					{
+						const BehaviorState state = m_First.Tick(pBlackBoard);
+						if (state != ContinueState)
+						{
+							if (state == BehaviorState::Running)
+								runningIndex = static_cast<int>(index);
+							return state;
+						}
+					}
+					return m_Rest.Tick(pBlackBoard, first, index + 1, runningIndex);
+				}
+				void ResetChild(unsigned int child, unsigned int index)
+				{
+					if (child == index)
+						m_First.Reset();
+					else
+						m_Rest.ResetChild(child, index + 1);
+				}
+				void ResetAll()
+				{
+					m_First.Reset();
+					m_Rest.ResetAll();
+				}
+
+			private:
+				First m_First;
+				ChildList<ContinueState, Rest...> m_Rest;
+			};
+		}
+
+		//--- SELECTOR / SEQUENCE ---
+		template<typename... Children>
+		class Selector final
+		{
+		public:
+			BehaviorState Tick(Blackboard* pBlackBoard)
+			{
+				int runningIndex = -1;
+				return m_Children.Tick(pBlackBoard, 0, 0, runningIndex);
+			}
+			void Reset() { m_Children.ResetAll(); }
+
+		private:
+			Detail::ChildList<BehaviorState::Failure, Children...> m_Children;
+		};
+
+		template<typename... Children>
+		class Sequence final
+		{
+		public:
+			BehaviorState Tick(Blackboard* pBlackBoard)
+			{
+				int runningIndex = -1;
+				return m_Children.Tick(pBlackBoard, 0, 0, runningIndex);
+			}
+			void Reset() { m_Children.ResetAll(); }
+
+		private:
+			Detail::ChildList<BehaviorState::Success, Children...> m_Children;
+		};
+
+		//--- INTERRUPT GUARDS ---
+		template<typename... Nodes>
+		class Guards;
+
+		template<>
+		class Guards<>
+		{
+		public:
+			bool IsAnySuccessful(Blackboard*) { return false; }
+		};
+
+		template<typename First, typename... Rest>
+		class Guards<First, Rest...>
+		{
+		public:
+			bool IsAnySuccessful(Blackboard* pBlackBoard)
+			{
+				return m_First.Tick(pBlackBoard) == BehaviorState::Success || m_Rest.IsAnySuccessful(pBlackBoard);
+			}
+
+		private:
+			First m_First;
+			Guards<Rest...> m_Rest;
+		};
+
+		//--- MEMORY SELECTOR / SEQUENCE ---
+		// Same as BehaviorMemorySelector/BehaviorMemorySequence, GuardList is a Guards<...> (can be empty)
+		namespace Detail
+		{
+			template<BehaviorState ContinueState, typename GuardList, typename... Children>
+			class MemoryComposite
+			{
+			public:
+				BehaviorState Tick(Blackboard* pBlackBoard)
+				{
+					unsigned int first = 0;
+					if (m_RunningChildIndex >= 0)
+					{
+						const unsigned int runningChildIndex = static_cast<unsigned int>(m_RunningChildIndex);
+						m_RunningChildIndex = -1;
+
+						if (m_Guards.IsAnySuccessful(pBlackBoard))
+							m_Children.ResetChild(runningChildIndex, 0);
+						else
+							first = runningChildIndex;
+					}
+					return m_Children.Tick(pBlackBoard, first, 0, m_RunningChildIndex);
+				}
+				void Reset()
+				{
+					m_RunningChildIndex = -1;
+					m_Children.ResetAll();
+				}
+
+			private:
+				GuardList m_Guards;
+				ChildList<ContinueState, Children...> m_Children;
+				int m_RunningChildIndex = -1;
+			};
+		}
+
+		template<typename GuardList, typename... Children>
+		using MemorySelector = Detail::MemoryComposite<BehaviorState::Failure, GuardList, Children...>;
+
+		template<typename GuardList, typename... Children>
+		using MemorySequence = Detail::MemoryComposite<BehaviorState::Success, GuardList, Children...>;
+
+		//--- UTILITY SELECTOR ---
+		// A child of a UtilitySelector together with the function that scores it
+		template<float(*Score)(Blackboard*), typename Child>
+		class UtilityOption final
+		{
+		public:
+			float GetScore(Blackboard* pBlackBoard) { return Score(pBlackBoard); }
+			BehaviorState Tick(Blackboard* pBlackBoard) { return m_Child.Tick(pBlackBoard); }
+			void Reset() { m_Child.Reset(); }
+
+		private:
+			Child m_Child;
+		};
+
+		namespace Detail
+		{
+			template<typename... Options>
+			class OptionList;
+
+			template<>
+			class OptionList<>
+			{
+			public:
+				void Score(Blackboard*, float*) {}
+				BehaviorState TickOption(Blackboard*, unsigned int, unsigned int) { return BehaviorState::Failure; }
+				void ResetOption(unsigned int, unsigned int) {}
+				void ResetAll() {}
+			};
+
+			template<typename First, typename... Rest>
+			class OptionList<First, Rest...>
+			{
+			public:
+				void Score(Blackboard* pBlackBoard, float* pScores)
+				{
+					*pScores = m_First.GetScore(pBlackBoard);
+					m_Rest.Score(pBlackBoard, pScores + 1);
+				}
+				BehaviorState TickOption(Blackboard* pBlackBoard, unsigned int option, unsigned int index)
+				{
+					return option == index ? m_First.Tick(pBlackBoard) : m_Rest.TickOption(pBlackBoard, option, index + 1);
+				}
+				void ResetOption(unsigned int option, unsigned int index)
+				{
+					if (option == index)
+						m_First.Reset();
+					else
+						m_Rest.ResetOption(option, index + 1);
+				}
+				void ResetAll()
+				{
+					m_First.Reset();
+					m_Rest.ResetAll();
+				}
+
+			private:
+				First m_First;
+				OptionList<Rest...> m_Rest;
+			};
+		}
+
+		// Same as BehaviorUtilitySelector with the default hysteresis, every option is a UtilityOption<...>
+		template<typename... Options>
+		class UtilitySelector final
+		{
+			static_assert(sizeof...(Options) > 0, "A utility selector needs at least one option");
+			static constexpr unsigned int OptionCount{ sizeof...(Options) };
+
+		public:
+			BehaviorState Tick(Blackboard* pBlackBoard)
+			{
+				m_Options.Score(pBlackBoard, m_Scores);
+
+				// Highest score first, equal scores keep the order of the options
+				unsigned int order[OptionCount];
+				for (unsigned int i = 0; i < OptionCount; ++i)
+				{
+					unsigned int j = i;
+					for (; j > 0 && m_Scores[order[j - 1]] < m_Scores[i]; --j)
+						order[j] = order[j - 1];
+					order[j] = i;
+				}
+
+				// The previous choice stays first unless it is clearly beaten
+				const int previousIndex = m_SelectedIndex;
+				if (previousIndex >= 0 && m_Scores[previousIndex] > 0.f
+					&& m_Scores[order[0]] <= m_Scores[previousIndex] + BehaviorUtilitySelector::DefaultHysteresis)
+				{
+					unsigned int j = 0;
+					while (order[j] != static_cast<unsigned int>(previousIndex))
+						++j;
+					for (; j > 0; --j)
+						order[j] = order[j - 1];
+					order[0] = static_cast<unsigned int>(previousIndex);
+				}
+
+				m_SelectedIndex = -1;
+				BehaviorState result = BehaviorState::Failure;
+				for (unsigned int i = 0; i < OptionCount && m_Scores[order[i]] > 0.f; ++i)
+				{
+					const BehaviorState state = m_Options.TickOption(pBlackBoard, order[i], 0);
+					if (state != BehaviorState::Failure)
+					{
+						m_SelectedIndex = static_cast<int>(order[i]);
+						result = state;
+						break;
+					}
+				}
+
+				if (previousIndex >= 0 && previousIndex != m_SelectedIndex)
+					m_Options.ResetOption(static_cast<unsigned int>(previousIndex), 0);
+				return result;
+			}
+			void Reset()
+			{
+				m_SelectedIndex = -1;
+				m_Options.ResetAll();
+			}
+
+		private:
+			Detail::OptionList<Options...> m_Options;
+			float m_Scores[OptionCount] = {};
+			int m_SelectedIndex = -1;
+		};
+
+		//-----------------------------------------------------------------
+		// DECORATORS
+		//-----------------------------------------------------------------
+		// BehaviorTickRate without the budget, the frequency is in whole ticks per second.
+		// The child also runs again when one of the keys changed.
+		template<unsigned int Frequency, typename Child, unsigned int... KeyIndices>
+		class TickRate final
+		{
+			static_assert(Frequency > 0, "A tick rate needs a frequency");
+
+		public:
+			BehaviorState Tick(Blackboard* pBlackBoard)
+			{
+				const BehaviorTreeContext* pContext = BehaviorTreeContext::GetCurrent();
+				if (pContext)
+				{
+					const bool isContinuing = m_HasState && pContext->Tick == m_LastTick + 1;
+					m_LastTick = pContext->Tick;
+
+					const bool hasKeyChanged = !m_Keys.IsEmpty() && m_Keys.PollChanges(pBlackBoard);
+					if (isContinuing && !hasKeyChanged && pContext->Time < m_NextEvaluationTime)
+						return m_State;
+				}
+
+				m_State = m_Child.Tick(pBlackBoard);
+				if (!m_Keys.IsEmpty())
+					m_Keys.PollChanges(pBlackBoard);
+				m_HasState = true;
+				if (pContext)
+					m_NextEvaluationTime = pContext->Time + 1.f / Frequency;
+				return m_State;
+			}
+			void Reset()
+			{
+				m_HasState = false;
+				m_Child.Reset();
+			}
+
+		private:
+			Child m_Child;
+			BlackboardSubscription m_Keys{ BlackboardKeyBase{ KeyIndices, nullptr }... };
+			BehaviorState m_State = BehaviorState::Failure;
+			float m_NextEvaluationTime = 0.f;
+			uint32_t m_LastTick = 0;
+			bool m_HasState = false;
+		};
+
+		// BehaviorCooldown, the duration is in milliseconds
+		template<unsigned int Milliseconds, typename Child>
+		class Cooldown final
+		{
+		public:
+			BehaviorState Tick(Blackboard* pBlackBoard)
+			{
+				const BehaviorTreeContext* pContext = BehaviorTreeContext::GetCurrent();
+				if (pContext && pContext->Time < m_ReadyTime)
+					return BehaviorState::Failure;
+
+				const BehaviorState state = m_Child.Tick(pBlackBoard);
+				if (state == BehaviorState::Success && pContext)
+					m_ReadyTime = pContext->Time + Milliseconds / 1000.f;
+				return state;
+			}
+			void Reset() { m_Child.Reset(); }
+
+		private:
+			Child m_Child;
+			float m_ReadyTime = 0.f;
+		};
+
+		// BehaviorRateLimit, the period is in milliseconds
+		template<unsigned int Count, unsigned int PeriodMilliseconds, typename Child>
+		class RateLimit final
+		{
+			static_assert(Count > 0, "A rate limit needs at least one run per period");
+
+		public:
+			BehaviorState Tick(Blackboard* pBlackBoard)
+			{
+				const BehaviorTreeContext* pContext = BehaviorTreeContext::GetCurrent();
+				if (pContext)
+				{
+					// Refill Count tokens per period, never more than Count
+					if (PeriodMilliseconds > 0)
+					{
+						m_Tokens += (pContext->Time - m_LastRefillTime) * Count / (PeriodMilliseconds / 1000.f);
+						m_Tokens = m_Tokens > Count ? static_cast<float>(Count) : m_Tokens;
+					}
+					m_LastRefillTime = pContext->Time;
+
+					const bool isContinuing = m_WasTicked && pContext->Tick == m_LastTick + 1;
+					m_WasTicked = true;
+					m_LastTick = pContext->Tick;
+
+					if (isContinuing && m_Tokens < 1.f)
+					{
+						if (m_State != BehaviorState::Running)
+							m_State = BehaviorState::Failure;
+						return m_State;
+					}
+					m_Tokens = m_Tokens > 1.f ? m_Tokens - 1.f : 0.f;
+				}
+
+				m_State = m_Child.Tick(pBlackBoard);
+				return m_State;
+			}
+			void Reset()
+			{
+				m_WasTicked = false;
+				m_Child.Reset();
+			}
+
+		private:
+			Child m_Child;
+			BehaviorState m_State = BehaviorState::Failure;
+			float m_Tokens = static_cast<float>(Count);
+			float m_LastRefillTime = 0.f;
+			uint32_t m_LastTick = 0;
+			bool m_WasTicked = false;
+		};
+
+		//-----------------------------------------------------------------
+		// ADAPTER (IBehavior)
+		//-----------------------------------------------------------------
+		// Lets a static tree be the root of an Elite::BehaviorTree
+		template<typename Tree>
+		class StaticBehavior final : public IBehavior
+		{
+		public:
+			virtual void Reset() override { m_Tree.Reset(); }
+
+		protected:
+			virtual BehaviorState OnExecute(Blackboard* pBlackBoard) override
+			{
+				m_CurrentState = m_Tree.Tick(pBlackBoard);
+				return m_CurrentState;
+			}
+			virtual const char* GetTypeName() const override { return "StaticTree"; }
+
+		private:
+			Tree m_Tree;
+		};
+	}
+}
+#endif
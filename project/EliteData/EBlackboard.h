@@ -3,6 +3,16 @@
 #include <unordered_map>
 #include <string>
 #include <memory>
+#include <vector>
+#include <cassert>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <initializer_list>
+#include <atomic>
+
+#include "EBlackboardProfiler.h"
+#include <type_traits>
 
 namespace Elite
 {
@@ -25,6 +35,200 @@ namespace Elite
         T m_Data;
     };
 
+    // Unique address per stored type, used instead of RTTI to validate slot types
+    template<typename T>
+    const void* GetBlackboardTypeTag()
+    {
+        static const char tag{};
+        return &tag;
+    }
+
+    // Small trivially copyable values (pointers, floats, bools, ...) are stored inline in a slab slot,
+    // everything else lives in a heap allocated BlackboardField<T> and the slot holds its address
+    constexpr size_t BlackboardSlotSize{ 8 };
+    constexpr size_t BlackboardCacheLineSize{ 64 };
+
+    template<typename T>
+    struct IsBlackboardInline : std::integral_constant<bool,
+        std::is_trivially_copyable<T>::value && sizeof(T) <= BlackboardSlotSize && alignof(T) <= BlackboardSlotSize>
+    {};
+
+    //--- SLAB ---
+    // One contiguous, cache line aligned block of fixed size slots.
+    // Slots are raw bytes, the owning Blackboard keeps track of what type lives in which slot.
+    class BlackboardSlab final
+    {
+    public:
+        BlackboardSlab() = default;
+
+        BlackboardSlab(const BlackboardSlab& other) = delete;
+        BlackboardSlab& operator=(const BlackboardSlab& other) = delete;
+        BlackboardSlab(BlackboardSlab&& other) = default;
+        BlackboardSlab& operator=(BlackboardSlab&& other) = default;
+
+        // Grows the slab to hold at least slotCount slots, existing slots keep their bytes
+        void Reserve(size_t slotCount)
+        {
+            if (slotCount <= m_Capacity)
+                return;
+
+            const size_t slotsPerLine = BlackboardCacheLineSize / BlackboardSlotSize;
+            size_t newCapacity = (std::max)(slotCount, m_Capacity * 2);
+            newCapacity = (newCapacity + slotsPerLine - 1) / slotsPerLine * slotsPerLine;
+
+            // std::vector/new do not honour over-aligned types in C++14, so align by hand
+            const size_t bytes = newCapacity * BlackboardSlotSize;
+            std::unique_ptr<unsigned char[]> pBuffer{ new unsigned char[bytes + BlackboardCacheLineSize - 1] };
+            const uintptr_t address = reinterpret_cast<uintptr_t>(pBuffer.get());
+            unsigned char* pSlots = pBuffer.get() + ((BlackboardCacheLineSize - address % BlackboardCacheLineSize) % BlackboardCacheLineSize);
+
+            std::memset(pSlots, 0, bytes);
+            if (m_pSlots)
+                std::memcpy(pSlots, m_pSlots, m_Capacity * BlackboardSlotSize);
+
+            m_pBuffer = std::move(pBuffer);
+            m_pSlots = pSlots;
+            m_Capacity = newCapacity;
+        }
+
+        size_t GetCapacity() const { return m_Capacity; }
+
+        void* GetSlot(size_t index) { assert(index < m_Capacity); return m_pSlots + index * BlackboardSlotSize; }
+        const void* GetSlot(size_t index) const { assert(index < m_Capacity); return m_pSlots + index * BlackboardSlotSize; }
+
+        template<typename T>
+        T Read(size_t index) const
+        {
+            static_assert(IsBlackboardInline<T>::value, "Type does not fit in a blackboard slot");
+            T data;
+            std::memcpy(&data, GetSlot(index), sizeof(T));
+            return data;
+        }
+
+        template<typename T>
+        void Write(size_t index, const T& data)
+        {
+            static_assert(IsBlackboardInline<T>::value, "Type does not fit in a blackboard slot");
+            std::memcpy(GetSlot(index), &data, sizeof(T));
+        }
+
+    private:
+        std::unique_ptr<unsigned char[]> m_pBuffer{};
+        unsigned char* m_pSlots{ nullptr };
+        size_t m_Capacity{ 0 };
+    };
+
+    //--- KEYS ---
+    // A key is a typed handle to a fixed blackboard slot. It is registered once with AddData(key, ...),
+    // after which GetData/ChangeData resolve it with an index instead of a string hash + dynamic_cast.
+    class BlackboardKeyBase
+    {
+    public:
+        constexpr BlackboardKeyBase(unsigned int index, const char* name) : m_Index(index), m_Name(name) {}
+
+        constexpr unsigned int GetIndex() const { return m_Index; }
+        constexpr const char* GetName() const { return m_Name; }
+
+    private:
+        unsigned int m_Index;
+        const char* m_Name;
+    };
+
+    template<typename T>
+    class BlackboardKey final : public BlackboardKeyBase
+    {
+    public:
+        using ValueType = T;
+        constexpr BlackboardKey(unsigned int index, const char* name) : BlackboardKeyBase(index, name) {}
+    };
+
+    //--- SNAPSHOTS ---
+    // A published copy of the slab. Readers on other threads only ever see a buffer while it is the front
+    // buffer or while they still hold it, so its slots never change underneath them. Slots holding pointers
+    // are frozen as pointers only: the objects behind them keep changing on the main thread.
+    struct BlackboardSnapshotBuffer
+    {
+        BlackboardSlab Slab{};
+        std::vector<const void*> SlotTypes{};
+        std::vector<uint32_t> SlotVersions{};
+        mutable std::atomic<int> ReaderCount{ 0 };
+    };
+
+    // Read handle on a snapshot buffer, keeps the buffer alive until it goes out of scope.
+    // Only inline values are snapshotted: pointers are copied, the objects they point to are not.
+    class BlackboardSnapshot final
+    {
+    public:
+        BlackboardSnapshot() = default;
+        explicit BlackboardSnapshot(const BlackboardSnapshotBuffer* pBuffer) : m_pBuffer(pBuffer) {}
+        ~BlackboardSnapshot() { Release(); }
+
+        BlackboardSnapshot(const BlackboardSnapshot& other) = delete;
+        BlackboardSnapshot& operator=(const BlackboardSnapshot& other) = delete;
+        BlackboardSnapshot(BlackboardSnapshot&& other) : m_pBuffer(other.m_pBuffer) { other.m_pBuffer = nullptr; }
+        BlackboardSnapshot& operator=(BlackboardSnapshot&& other)
+        {
+            if (this != &other)
+            {
+                Release();
+                m_pBuffer = other.m_pBuffer;
+                other.m_pBuffer = nullptr;
+            }
+            return *this;
+        }
+
+        // False when no snapshot was published yet
+        bool IsValid() const { return m_pBuffer != nullptr; }
+
+        template<typename T>
+        bool IsRegistered(const BlackboardKey<T>& key) const
+        {
+            const unsigned int index = key.GetIndex();
+            return m_pBuffer && index < m_pBuffer->SlotTypes.size() && m_pBuffer->SlotTypes[index] == GetBlackboardTypeTag<T>();
+        }
+
+        template<typename T>
+        T GetData(const BlackboardKey<T>& key) const
+        {
+            static_assert(IsBlackboardInline<T>::value, "Out of line blackboard values are not part of a snapshot");
+            assert(IsRegistered(key) && "Blackboard key not registered in this snapshot");
+            return m_pBuffer->Slab.Read<T>(key.GetIndex());
+        }
+
+        uint32_t GetVersion(const BlackboardKeyBase& key) const
+        {
+            const unsigned int index = key.GetIndex();
+            return m_pBuffer && index < m_pBuffer->SlotVersions.size() ? m_pBuffer->SlotVersions[index] : 0;
+        }
+
+    private:
+        const BlackboardSnapshotBuffer* m_pBuffer{ nullptr };
+
+        void Release()
+        {
+            if (m_pBuffer)
+                m_pBuffer->ReaderCount.fetch_sub(1);
+            m_pBuffer = nullptr;
+        }
+    };
+
+    // Slots read while it is attached to a Blackboard, see Blackboard::SetReadRecorder
+    class BlackboardReadSet final
+    {
+    public:
+        void Add(unsigned int index)
+        {
+            if (std::find(m_Indices.begin(), m_Indices.end(), index) == m_Indices.end())
+                m_Indices.push_back(index);
+        }
+        void Clear() { m_Indices.clear(); }
+
+        const std::vector<unsigned int>& GetIndices() const { return m_Indices; }
+
+    private:
+        std::vector<unsigned int> m_Indices{};
+    };
+
     class Blackboard final
     {
     public:
@@ -36,13 +240,180 @@ namespace Elite
         Blackboard(Blackboard&& other) = delete;
         Blackboard& operator=(Blackboard&& other) = delete;
 
+        // Sizes the slab up front so registering the keys does not reallocate it
+        void Reserve(unsigned int slotCount)
+        {
+            m_Slab.Reserve(slotCount);
+            m_SlotTypes.reserve(slotCount);
+            m_SlotVersions.reserve(slotCount);
+        }
+
+        //--- Versions ---
+        // Every slot carries a counter that is bumped whenever ChangeData actually changes its value.
+        // Unregistered slots report version 0.
+        uint32_t GetVersion(const BlackboardKeyBase& key) const
+        {
+            return GetVersion(key.GetIndex());
+        }
+        uint32_t GetVersion(unsigned int index) const
+        {
+            return index < m_SlotVersions.size() ? m_SlotVersions[index] : 0;
+        }
+        unsigned int GetSlotCount() const { return static_cast<unsigned int>(m_SlotVersions.size()); }
+
+        // For values that are changed through a pointer stored in the blackboard (e.g. *Target), which
+        // ChangeData never sees. Bumps the version so caches depending on the key are refreshed.
+        void NotifyChanged(const BlackboardKeyBase& key)
+        {
+            const unsigned int index = key.GetIndex();
+            if (index < m_SlotVersions.size())
+                ++m_SlotVersions[index];
+        }
+
+        //--- Read tracking ---
+        // Every slot read with GetData is added to the recorder until it is detached with nullptr.
+        // The blackboard does not own the recorder.
+        void SetReadRecorder(BlackboardReadSet* pReadSet) { m_pReadRecorder = pReadSet; }
+        BlackboardReadSet* GetReadRecorder() const { return m_pReadRecorder; }
+
+        //--- Snapshots ---
+        // Snapshot mode keeps three copies of the slab for readers on other threads. The main thread keeps
+        // writing the live slab during the frame and publishes it with PublishSnapshot, which copies every
+        // slot that changed since the back buffer was last published. Only values stored inline are safe to
+        // read through a snapshot, so only enable it for readers of inline keys.
+        void EnableSnapshots()
+        {
+            if (!m_pSnapshotBuffers)
+                m_pSnapshotBuffers = std::make_unique<BlackboardSnapshotBuffer[]>(SnapshotBufferCount);
+        }
+        bool IsSnapshotEnabled() const { return m_pSnapshotBuffers != nullptr; }
+
+        // Main thread only. Brings a buffer nobody is reading up to date and swaps it to the front.
+        // Returns false when snapshots are disabled or every spare buffer is still held by a reader.
+        bool PublishSnapshot()
+        {
+            if (!m_pSnapshotBuffers)
+                return false;
+
+            BlackboardSnapshotBuffer* pFront = m_pFrontSnapshot.load();
+            BlackboardSnapshotBuffer* pBack = nullptr;
+            for (unsigned int i = 0; i < SnapshotBufferCount; ++i)
+            {
+                BlackboardSnapshotBuffer* pBuffer = &m_pSnapshotBuffers[i];
+                if (pBuffer != pFront && pBuffer->ReaderCount.load() == 0)
+                {
+                    pBack = pBuffer;
+                    break;
+                }
+            }
+            if (!pBack)
+                return false;
+
+            // The back buffer is a few frames old, only copy the slots that changed since then
+            const size_t slotCount = m_SlotTypes.size();
+            pBack->Slab.Reserve(slotCount);
+            pBack->SlotTypes.resize(slotCount, nullptr);
+            pBack->SlotVersions.resize(slotCount, 0);
+            for (size_t i = 0; i < slotCount; ++i)
+            {
+                if (pBack->SlotVersions[i] == m_SlotVersions[i])
+                    continue;
+
+                std::memcpy(pBack->Slab.GetSlot(i), m_Slab.GetSlot(i), BlackboardSlotSize);
+                pBack->SlotTypes[i] = m_SlotTypes[i];
+                pBack->SlotVersions[i] = m_SlotVersions[i];
+            }
+
+            m_pFrontSnapshot.store(pBack);
+            return true;
+        }
+
+        // Safe from any thread. The returned snapshot is invalid until the first PublishSnapshot.
+        BlackboardSnapshot AcquireSnapshot() const
+        {
+            while (true)
+            {
+                BlackboardSnapshotBuffer* pBuffer = m_pFrontSnapshot.load();
+                if (!pBuffer)
+                    return BlackboardSnapshot{};
+
+                // The front may have been swapped between the load and the increment, so check it again
+                pBuffer->ReaderCount.fetch_add(1);
+                if (m_pFrontSnapshot.load() == pBuffer)
+                    return BlackboardSnapshot{ pBuffer };
+                pBuffer->ReaderCount.fetch_sub(1);
+            }
+        }
+
+        //--- Profiling ---
+        // Opt-in, the blackboard does not own the profiler. Pass nullptr to stop profiling.
+        void SetProfiler(BlackboardProfiler* pProfiler) { m_pProfiler = pProfiler; }
+        BlackboardProfiler* GetProfiler() const { return m_pProfiler; }
+
+        //--- Key API (hot path) ---
+        template<typename T>
+        bool AddData(const BlackboardKey<T>& key, typename BlackboardKey<T>::ValueType data)
+        {
+            const unsigned int index = key.GetIndex();
+            if (index < m_SlotTypes.size() && m_SlotTypes[index])
+            {
+                printf("WARNING: Slot %u for '%s' is already used by another entry \n", index, key.GetName());
+                return false;
+            }
+            if (m_FieldIndices.find(key.GetName()) != m_FieldIndices.end())
+            {
+                printf("WARNING: Data '%s' of type '%s' already in Blackboard \n", key.GetName(), typeid(T).name());
+                return false;
+            }
+
+            AddSlot<T>(index, data);
+            m_FieldIndices[key.GetName()] = index;
+            return true;
+        }
+
+        template<typename T>
+        bool IsRegistered(const BlackboardKey<T>& key) const
+        {
+            const unsigned int index = key.GetIndex();
+            return index < m_SlotTypes.size() && m_SlotTypes[index] == GetBlackboardTypeTag<T>();
+        }
+
+        // Keys are validated when they are registered, so lookups only assert in debug builds
+        template<typename T>
+        T GetData(const BlackboardKey<T>& key) const
+        {
+            if (m_pReadRecorder)
+                m_pReadRecorder->Add(key.GetIndex());
+            if (m_pProfiler)
+                return ProfileGetData(key);
+
+            assert(IsRegistered(key) && "Blackboard key used before it was registered");
+            return ReadSlot<T>(key.GetIndex(), IsBlackboardInline<T>{});
+        }
+
+        template<typename T>
+        void ChangeData(const BlackboardKey<T>& key, typename BlackboardKey<T>::ValueType data)
+        {
+            if (m_pProfiler)
+            {
+                ProfileChangeData(key, data);
+                return;
+            }
+
+            assert(IsRegistered(key) && "Blackboard key used before it was registered");
+            WriteSlot<T>(key.GetIndex(), data, IsBlackboardInline<T>{});
+        }
+
+        //--- String API (slow path) ---
         template<typename T>
         bool AddData(const std::string& name, T data)
         {
-            auto it = m_BlackboardData.find(name);
-            if (it == m_BlackboardData.end())
+            auto it = m_FieldIndices.find(name);
+            if (it == m_FieldIndices.end())
             {
-                m_BlackboardData[name] = std::make_unique<BlackboardField<T>>(data);
+                const unsigned int index = static_cast<unsigned int>(m_SlotTypes.size());
+                AddSlot<T>(index, data);
+                m_FieldIndices[name] = index;
                 return true;
             }
             printf("WARNING: Data '%s' of type '%s' already in Blackboard \n", name.c_str(), typeid(T).name());
@@ -52,16 +423,16 @@ namespace Elite
         template<typename T>
         bool ChangeData(const std::string& name, T data)
         {
-            auto it = m_BlackboardData.find(name);
-            if (it != m_BlackboardData.end())
-            {
-                BlackboardField<T>* p = dynamic_cast<BlackboardField<T>*>(it->second.get());
-                if (p)
-                {
-                    p->SetData(data);
-                    return true;
-                }
-            }
+            const BlackboardProfiler::Clock::time_point start = m_pProfiler ? BlackboardProfiler::Clock::now() : BlackboardProfiler::Clock::time_point{};
+            const int index = FindSlot<T>(name);
+            if (index >= 0)
+                WriteSlot<T>(index, data, IsBlackboardInline<T>{});
+            if (m_pProfiler)
+                RecordNamedAccess(name, index, BlackboardAccess::Write, start);
+
+            if (index >= 0)
+                return true;
+
             printf("WARNING: Data '%s' of type '%s' not found in Blackboard \n", name.c_str(), typeid(T).name());
             return false;
         }
@@ -69,21 +440,202 @@ namespace Elite
         template<typename T>
         bool GetData(const std::string& name, T& data)
         {
-            auto it = m_BlackboardData.find(name);
-            if (it != m_BlackboardData.end())
+            const BlackboardProfiler::Clock::time_point start = m_pProfiler ? BlackboardProfiler::Clock::now() : BlackboardProfiler::Clock::time_point{};
+            const int index = FindSlot<T>(name);
+            if (index >= 0)
+                data = ReadSlot<T>(index, IsBlackboardInline<T>{});
+            if (index >= 0 && m_pReadRecorder)
+                m_pReadRecorder->Add(index);
+            if (m_pProfiler)
+                RecordNamedAccess(name, index, BlackboardAccess::Read, start);
+
+            if (index >= 0)
+                return true;
+
+            printf("WARNING: Data '%s' of type '%s' not found in Blackboard \n", name.c_str(), typeid(T).name());
+            return false;
+        }
+
+    private:
+        BlackboardSlab m_Slab{};
+        std::vector<const void*> m_SlotTypes{};
+        std::vector<uint32_t> m_SlotVersions{};
+        std::vector<std::unique_ptr<IBlackBoardField>> m_OutOfLineFields{};
+        std::unordered_map<std::string, unsigned int> m_FieldIndices{};
+
+        BlackboardProfiler* m_pProfiler{ nullptr };
+        BlackboardReadSet* m_pReadRecorder{ nullptr };
+
+        static constexpr unsigned int SnapshotBufferCount{ 3 };
+        std::unique_ptr<BlackboardSnapshotBuffer[]> m_pSnapshotBuffers{};
+        std::atomic<BlackboardSnapshotBuffer*> m_pFrontSnapshot{ nullptr };
+
+        template<typename T>
+        void AddSlot(unsigned int index, const T& data)
+        {
+            if (index >= m_SlotTypes.size())
             {
-                BlackboardField<T>* p = dynamic_cast<BlackboardField<T>*>(it->second.get());
-                if (p != nullptr)
+                m_Slab.Reserve(index + 1);
+                m_SlotTypes.resize(index + 1, nullptr);
+                m_SlotVersions.resize(index + 1, 0);
+            }
+            InitSlot<T>(index, data, IsBlackboardInline<T>{});
+            m_SlotTypes[index] = GetBlackboardTypeTag<T>();
+            ++m_SlotVersions[index];
+        }
+
+        template<typename T>
+        void InitSlot(unsigned int index, const T& data, std::true_type)
+        {
+            m_Slab.Write<T>(index, data);
+        }
+
+        template<typename T>
+        void InitSlot(unsigned int index, const T& data, std::false_type)
+        {
+            m_OutOfLineFields.push_back(std::make_unique<BlackboardField<T>>(data));
+            m_Slab.Write<IBlackBoardField*>(index, m_OutOfLineFields.back().get());
+        }
+
+        template<typename T>
+        T ReadSlot(unsigned int index, std::true_type) const
+        {
+            return m_Slab.Read<T>(index);
+        }
+
+        template<typename T>
+        T ReadSlot(unsigned int index, std::false_type) const
+        {
+            return static_cast<BlackboardField<T>*>(m_Slab.Read<IBlackBoardField*>(index))->GetData();
+        }
+
+        // Writing the value a slot already holds does not bump its version
+        template<typename T>
+        void WriteSlot(unsigned int index, const T& data, std::true_type)
+        {
+            if (std::memcmp(m_Slab.GetSlot(index), &data, sizeof(T)) == 0)
+                return;
+
+            m_Slab.Write<T>(index, data);
+            ++m_SlotVersions[index];
+        }
+
+        // Out of line values can not be compared cheaply, so every write counts as a change
+        template<typename T>
+        void WriteSlot(unsigned int index, const T& data, std::false_type)
+        {
+            static_cast<BlackboardField<T>*>(m_Slab.Read<IBlackBoardField*>(index))->SetData(data);
+            ++m_SlotVersions[index];
+        }
+
+        //--- Profiling ---
+        template<typename T>
+        BlackboardAccess ClassifyAccess(const BlackboardKey<T>& key, BlackboardAccess access) const
+        {
+            const unsigned int index = key.GetIndex();
+            if (index >= m_SlotTypes.size() || !m_SlotTypes[index])
+                return BlackboardAccess::Miss;
+            if (m_SlotTypes[index] != GetBlackboardTypeTag<T>())
+                return BlackboardAccess::TypeMismatch;
+            return access;
+        }
+
+        template<typename T>
+        T ProfileGetData(const BlackboardKey<T>& key) const
+        {
+            const BlackboardProfiler::Clock::time_point start = BlackboardProfiler::Clock::now();
+            const BlackboardAccess access = ClassifyAccess(key, BlackboardAccess::Read);
+            T data{};
+            if (access == BlackboardAccess::Read)
+                data = ReadSlot<T>(key.GetIndex(), IsBlackboardInline<T>{});
+            m_pProfiler->Record(key.GetIndex(), key.GetName(), access, BlackboardProfiler::Clock::now() - start);
+
+            assert(access == BlackboardAccess::Read && "Blackboard key used before it was registered");
+            return data;
+        }
+
+        template<typename T>
+        void ProfileChangeData(const BlackboardKey<T>& key, const T& data)
+        {
+            const BlackboardProfiler::Clock::time_point start = BlackboardProfiler::Clock::now();
+            const BlackboardAccess access = ClassifyAccess(key, BlackboardAccess::Write);
+            if (access == BlackboardAccess::Write)
+                WriteSlot<T>(key.GetIndex(), data, IsBlackboardInline<T>{});
+            m_pProfiler->Record(key.GetIndex(), key.GetName(), access, BlackboardProfiler::Clock::now() - start);
+
+            assert(access == BlackboardAccess::Write && "Blackboard key used before it was registered");
+        }
+
+        // Failed string lookups are a type mismatch when the name exists and a miss when it does not
+        void RecordNamedAccess(const std::string& name, int index, BlackboardAccess access, BlackboardProfiler::Clock::time_point start) const
+        {
+            if (index < 0)
+            {
+                auto it = m_FieldIndices.find(name);
+                index = it != m_FieldIndices.end() ? static_cast<int>(it->second) : -1;
+                access = it != m_FieldIndices.end() ? BlackboardAccess::TypeMismatch : BlackboardAccess::Miss;
+            }
+            m_pProfiler->Record(index, name.c_str(), access, BlackboardProfiler::Clock::now() - start);
+        }
+
+        // Returns the slot index of name when it holds a T, -1 otherwise
+        template<typename T>
+        int FindSlot(const std::string& name) const
+        {
+            auto it = m_FieldIndices.find(name);
+            if (it == m_FieldIndices.end() || m_SlotTypes[it->second] != GetBlackboardTypeTag<T>())
+                return -1;
+
+            return static_cast<int>(it->second);
+        }
+    };
+
+    //--- SUBSCRIPTION ---
+    // Remembers the versions of a set of keys, so a consumer can cheaply ask whether any of them changed
+    // since it last looked. The first poll always reports a change.
+    class BlackboardSubscription final
+    {
+    public:
+        BlackboardSubscription() = default;
+        BlackboardSubscription(std::initializer_list<BlackboardKeyBase> keys)
+        {
+            m_Entries.reserve(keys.size());
+            for (const BlackboardKeyBase& key : keys)
+                m_Entries.push_back({ key.GetIndex(), 0 });
+        }
+
+        bool IsEmpty() const { return m_Entries.empty(); }
+        size_t GetKeyCount() const { return m_Entries.size(); }
+        unsigned int GetKeyIndex(size_t i) const { return m_Entries[i].Index; }
+
+        // Returns true when one of the keys changed since the previous poll and records the current versions
+        bool PollChanges(const Blackboard* pBlackboard)
+        {
+            bool hasChanged = !m_IsSynced;
+            for (Entry& entry : m_Entries)
+            {
+                const uint32_t version = pBlackboard->GetVersion(entry.Index);
+                if (version != entry.Version)
                 {
-                    data = p->GetData();
-                    return true;
+                    entry.Version = version;
+                    hasChanged = true;
                 }
             }
-            printf("WARNING: Data '%s' of type '%s' not found in Blackboard \n", name.c_str(), typeid(T).name());
-            return false;
+            m_IsSynced = true;
+            return hasChanged;
         }
 
+        // Forces the next poll to report a change
+        void Invalidate() { m_IsSynced = false; }
+
     private:
-        std::unordered_map<std::string, std::unique_ptr<IBlackBoardField>> m_BlackboardData;
+        struct Entry
+        {
+            unsigned int Index;
+            uint32_t Version;
+        };
+
+        std::vector<Entry> m_Entries{};
+        bool m_IsSynced{ false };
     };
 }
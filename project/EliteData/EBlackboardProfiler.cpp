@@ -0,0 +1,149 @@
+#include "stdafx.h"
+#include "EBlackboardProfiler.h"
+
+using namespace Elite;
+
+namespace
+{
+    const char* const AccessNames[static_cast<int>(BlackboardAccess::Count)]{ "Reads", "Writes", "Misses", "Type Mismatches" };
+
+    template<typename Function>
+    void ForEachAccess(Function function)
+    {
+        for (int i = 0; i < static_cast<int>(BlackboardAccess::Count); ++i)
+            function(i);
+    }
+}
+
+void BlackboardProfiler::Record(int slotIndex, const char* name, BlackboardAccess access, Clock::duration duration)
+{
+    BlackboardKeyStats& stats = GetStats(slotIndex, name);
+    ++stats.FrameCounts[static_cast<int>(access)];
+    stats.FrameSeconds += std::chrono::duration<double>(duration).count();
+}
+
+void BlackboardProfiler::EndFrame()
+{
+    auto rollOver = [](BlackboardKeyStats& stats)
+    {
+        ForEachAccess([&stats](int i)
+        {
+            stats.LastFrameCounts[i] = stats.FrameCounts[i];
+            stats.TotalCounts[i] += stats.FrameCounts[i];
+            stats.FrameCounts[i] = 0;
+        });
+        stats.LastFrameSeconds = stats.FrameSeconds;
+        stats.TotalSeconds += stats.FrameSeconds;
+        stats.FrameSeconds = 0.0;
+    };
+
+    for (BlackboardKeyStats& stats : m_SlotStats)
+        rollOver(stats);
+    for (auto& pair : m_UnknownKeyStats)
+        rollOver(pair.second);
+
+    ++m_FrameCount;
+}
+
+void BlackboardProfiler::Reset()
+{
+    m_SlotStats.clear();
+    m_UnknownKeyStats.clear();
+    m_FrameCount = 0;
+}
+
+std::vector<const BlackboardKeyStats*> BlackboardProfiler::GetSortedStats() const
+{
+    std::vector<const BlackboardKeyStats*> sortedStats{};
+    sortedStats.reserve(m_SlotStats.size() + m_UnknownKeyStats.size());
+
+    for (const BlackboardKeyStats& stats : m_SlotStats)
+    {
+        if (!stats.Name.empty())
+            sortedStats.push_back(&stats);
+    }
+    for (const auto& pair : m_UnknownKeyStats)
+        sortedStats.push_back(&pair.second);
+
+    std::sort(sortedStats.begin(), sortedStats.end(), [](const BlackboardKeyStats* pA, const BlackboardKeyStats* pB)
+    {
+        return pA->TotalSeconds > pB->TotalSeconds;
+    });
+    return sortedStats;
+}
+
+void BlackboardProfiler::PrintReport() const
+{
+    printf("--- Blackboard profile over %u frames ---\n", m_FrameCount);
+    printf("%-26s %10s %10s %8s %10s %12s %14s\n", "Key", "Reads", "Writes", "Misses", "Mismatches", "Total (us)", "Last frame (us)");
+
+    for (const BlackboardKeyStats* pStats : GetSortedStats())
+    {
+        printf("%-26s %10llu %10llu %8llu %10llu %12.2f %14.2f\n", pStats->Name.c_str(),
+            static_cast<unsigned long long>(pStats->TotalCounts[static_cast<int>(BlackboardAccess::Read)]),
+            static_cast<unsigned long long>(pStats->TotalCounts[static_cast<int>(BlackboardAccess::Write)]),
+            static_cast<unsigned long long>(pStats->TotalCounts[static_cast<int>(BlackboardAccess::Miss)]),
+            static_cast<unsigned long long>(pStats->TotalCounts[static_cast<int>(BlackboardAccess::TypeMismatch)]),
+            pStats->TotalSeconds * 1000000.0, pStats->LastFrameSeconds * 1000000.0);
+    }
+}
+
+void BlackboardProfiler::RenderImGui() const
+{
+    if (!ImGui::Begin("Blackboard Profiler"))
+    {
+        ImGui::End();
+        return;
+    }
+
+    ImGui::Text("Frames: %u", m_FrameCount);
+    ImGui::Separator();
+
+    // Counts are of the last finished frame, the time is cumulative
+    ImGui::Columns(static_cast<int>(BlackboardAccess::Count) + 2, "BlackboardProfilerColumns");
+    ImGui::Text("Key");
+    ImGui::NextColumn();
+    ForEachAccess([](int i)
+    {
+        ImGui::Text("%s", AccessNames[i]);
+        ImGui::NextColumn();
+    });
+    ImGui::Text("Total (us)");
+    ImGui::NextColumn();
+    ImGui::Separator();
+
+    for (const BlackboardKeyStats* pStats : GetSortedStats())
+    {
+        ImGui::Text("%s", pStats->Name.c_str());
+        ImGui::NextColumn();
+        ForEachAccess([pStats](int i)
+        {
+            ImGui::Text("%u", pStats->LastFrameCounts[i]);
+            ImGui::NextColumn();
+        });
+        ImGui::Text("%.2f", pStats->TotalSeconds * 1000000.0);
+        ImGui::NextColumn();
+    }
+
+    ImGui::Columns(1);
+    ImGui::End();
+}
+
+BlackboardKeyStats& BlackboardProfiler::GetStats(int slotIndex, const char* name)
+{
+    if (slotIndex < 0)
+    {
+        BlackboardKeyStats& stats = m_UnknownKeyStats[name];
+        if (stats.Name.empty())
+            stats.Name = name;
+        return stats;
+    }
+
+    if (static_cast<size_t>(slotIndex) >= m_SlotStats.size())
+        m_SlotStats.resize(slotIndex + 1);
+
+    BlackboardKeyStats& stats = m_SlotStats[slotIndex];
+    if (stats.Name.empty())
+        stats.Name = name;
+    return stats;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+namespace Elite
+{
+    enum class BlackboardAccess
+    {
+        Read,
+        Write,
+        Miss,
+        TypeMismatch,
+        Count
+    };
+
+    struct BlackboardKeyStats
+    {
+        std::string Name{};
+        unsigned int FrameCounts[static_cast<int>(BlackboardAccess::Count)]{};
+        unsigned int LastFrameCounts[static_cast<int>(BlackboardAccess::Count)]{};
+        uint64_t TotalCounts[static_cast<int>(BlackboardAccess::Count)]{};
+        double FrameSeconds{};
+        double LastFrameSeconds{};
+        double TotalSeconds{};
+    };
+
+    //--- PROFILER ---
+    // Opt-in instrumentation for a Blackboard, attach it with Blackboard::SetProfiler.
+    // Counts reads, writes, misses and type mismatches per key and accumulates the time spent in the lookups.
+    // Counters of the running frame roll over into the "last frame" columns on EndFrame.
+    class BlackboardProfiler final
+    {
+    public:
+        using Clock = std::chrono::high_resolution_clock;
+
+        BlackboardProfiler() = default;
+        ~BlackboardProfiler() = default;
+
+        BlackboardProfiler(const BlackboardProfiler& other) = delete;
+        BlackboardProfiler& operator=(const BlackboardProfiler& other) = delete;
+        BlackboardProfiler(BlackboardProfiler&& other) = delete;
+        BlackboardProfiler& operator=(BlackboardProfiler&& other) = delete;
+
+        // slotIndex is -1 for names that do not resolve to a slot
+        void Record(int slotIndex, const char* name, BlackboardAccess access, Clock::duration duration);
+
+        void EndFrame();
+        void Reset();
+
+        unsigned int GetFrameCount() const { return m_FrameCount; }
+
+        // Keys sorted by their cumulative lookup time, most expensive first
+        std::vector<const BlackboardKeyStats*> GetSortedStats() const;
+
+        void PrintReport() const;
+        void RenderImGui() const;
+
+    private:
+        std::vector<BlackboardKeyStats> m_SlotStats{};
+        std::unordered_map<std::string, BlackboardKeyStats> m_UnknownKeyStats{};
+        unsigned int m_FrameCount{ 0 };
+
+        BlackboardKeyStats& GetStats(int slotIndex, const char* name);
+    };
+}
@@ -0,0 +1,422 @@
+//=== General Includes ===
+#include "stdafx.h"
+#include "ELogger.h"
+
+#include <chrono>
+#include <cstring>
+
+using namespace Elite;
+
+constexpr unsigned int Logger::MaxArguments;
+constexpr unsigned int Logger::StringCapacity;
+constexpr unsigned int Logger::RingCapacity;
+constexpr double Logger::RepeatInterval;
+
+namespace
+{
+	uint64_t HashBytes(uint64_t hash, const void* pData, size_t size)
+	{
+		const uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+		for (size_t i = 0; i < size; ++i)
+		{
+			hash ^= pBytes[i];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	const char* GetLevelName(LogLevel level)
+	{
+		switch (level)
+		{
+		case LogLevel::Debug: return "DEBUG";
+		case LogLevel::Info: return "INFO ";
+		case LogLevel::Warning: return "WARN ";
+		case LogLevel::Error: return "ERROR";
+		}
+		return "?    ";
+	}
+}
+
+//-----------------------------------------------------------------
+// CAPTURE (game thread)
+//-----------------------------------------------------------------
+void Logger::Capture::AddInt(int64_t value)
+{
+	Argument& argument = pRecord->Arguments[pRecord->ArgumentCount++];
+	argument.Type = ArgumentType::Int;
+	argument.Int = value;
+	Hash = HashBytes(Hash, &value, sizeof(value));
+}
+
+void Logger::Capture::AddUInt(uint64_t value)
+{
+	Argument& argument = pRecord->Arguments[pRecord->ArgumentCount++];
+	argument.Type = ArgumentType::UInt;
+	argument.UInt = value;
+	Hash = HashBytes(Hash, &value, sizeof(value));
+}
+
+void Logger::Capture::AddFloat(double value)
+{
+	Argument& argument = pRecord->Arguments[pRecord->ArgumentCount++];
+	argument.Type = ArgumentType::Float;
+	argument.Float = value;
+	Hash = HashBytes(Hash, &value, sizeof(value));
+}
+
+void Logger::Capture::AddString(const char* pString)
+{
+	if (!pString)
+		pString = "(null)";
+
+	Argument& argument = pRecord->Arguments[pRecord->ArgumentCount++];
+	argument.Type = ArgumentType::String;
+
+	// The last byte always ends a string, a string that does not fit anymore is empty
+	if (StringSize >= StringCapacity)
+	{
+		argument.StringOffset = StringCapacity - 1;
+		return;
+	}
+
+	const size_t length = std::min(strlen(pString), static_cast<size_t>(StringCapacity - StringSize - 1));
+	memcpy(pRecord->Strings + StringSize, pString, length);
+	pRecord->Strings[StringSize + length] = '\0';
+	argument.StringOffset = StringSize;
+	StringSize += static_cast<uint32_t>(length) + 1;
+	Hash = HashBytes(Hash, pString, length + 1);
+}
+
+void Logger::Capture::AddPointer(const void* pPointer)
+{
+	Argument& argument = pRecord->Arguments[pRecord->ArgumentCount++];
+	argument.Type = ArgumentType::Pointer;
+	argument.pPointer = pPointer;
+	Hash = HashBytes(Hash, &pPointer, sizeof(pPointer));
+}
+
+//-----------------------------------------------------------------
+// LOGGER
+//-----------------------------------------------------------------
+Logger& Logger::GetInstance()
+{
+	static Logger instance{};
+	return instance;
+}
+
+Logger::~Logger()
+{
+	Stop();
+}
+
+void Logger::Start(const char* filePath)
+{
+	std::lock_guard<std::mutex> lock{ m_WakeMutex };
+	if (m_IsRunning)
+		return;
+
+	if (filePath)
+	{
+		m_pFile = fopen(filePath, "w");
+		if (!m_pFile)
+			printf("Logger could not open %s, only writing to the console\n", filePath);
+	}
+
+	m_IsRunning = true;
+	m_Thread = std::thread{ &Logger::Run, this };
+}
+
+void Logger::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_WakeMutex };
+		if (!m_IsRunning)
+			return;
+		m_IsRunning = false;
+	}
+	m_WakeCondition.notify_all();
+	m_FlushCondition.notify_all();
+	m_Thread.join();
+
+	// Whatever was logged while the thread stopped
+	Drain();
+
+	if (m_pFile)
+	{
+		fclose(m_pFile);
+		m_pFile = nullptr;
+	}
+}
+
+void Logger::Flush()
+{
+	std::unique_lock<std::mutex> lock{ m_WakeMutex };
+	if (!m_IsRunning)
+		return;
+
+	const uint64_t request = ++m_FlushRequests;
+	m_WakeCondition.notify_all();
+	m_FlushCondition.wait(lock, [this, request]() { return m_FlushesDone >= request || !m_IsRunning; });
+}
+
+int64_t Logger::GetTicks()
+{
+	return std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
+int64_t Logger::GetTicksPerSecond()
+{
+	return std::chrono::steady_clock::period::den / std::chrono::steady_clock::period::num;
+}
+
+Logger::Ring* Logger::GetThreadRing()
+{
+	static thread_local Ring* pThreadRing = nullptr;
+	if (pThreadRing)
+		return pThreadRing;
+
+	// First message of this thread, the ring lives as long as the logger
+	std::lock_guard<std::mutex> lock{ m_RingsMutex };
+	m_pRings.push_back(std::make_unique<Ring>());
+	pThreadRing = m_pRings.back().get();
+	return pThreadRing;
+}
+
+Logger::Record* Logger::BeginRecord(LogSite& site, const char* pFormat, Ring*& pRing)
+{
+	pRing = GetThreadRing();
+
+	const uint32_t head = pRing->Head.load(std::memory_order_relaxed);
+	if (head - pRing->Tail.load(std::memory_order_acquire) >= RingCapacity)
+	{
+		m_DroppedCount.fetch_add(1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	Record& record = pRing->Records[head & (RingCapacity - 1)];
+	record.pSite = &site;
+	record.pFormat = pFormat;
+	record.ArgumentCount = 0;
+	return &record;
+}
+
+void Logger::EndRecord(LogSite& site, Record& record, Ring& ring, uint64_t hash)
+{
+	const int64_t ticks = GetTicks();
+
+	// Same message again within the interval, the record is not published and gets overwritten by the next one
+	const int64_t repeatTicks = static_cast<int64_t>(RepeatInterval * static_cast<double>(GetTicksPerSecond()));
+	if (hash == site.LastHash.load(std::memory_order_relaxed) && ticks - site.LastTicks.load(std::memory_order_relaxed) < repeatTicks)
+	{
+		site.RepeatCount.fetch_add(1, std::memory_order_relaxed);
+		m_RepeatedCount.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	site.LastHash.store(hash, std::memory_order_relaxed);
+	site.LastTicks.store(ticks, std::memory_order_relaxed);
+	record.RepeatCount = site.RepeatCount.exchange(0, std::memory_order_relaxed);
+	record.Ticks = ticks;
+
+	ring.Head.store(ring.Head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+//-----------------------------------------------------------------
+// BACKGROUND THREAD
+//-----------------------------------------------------------------
+void Logger::Run()
+{
+	std::unique_lock<std::mutex> lock{ m_WakeMutex };
+	while (m_IsRunning)
+	{
+		// The game thread never wakes this thread, so logging stays free of system calls
+		m_WakeCondition.wait_for(lock, std::chrono::milliseconds{ 10 }, [this]() { return !m_IsRunning || m_FlushRequests != m_FlushesDone; });
+		const uint64_t requests = m_FlushRequests;
+
+		lock.unlock();
+		Drain();
+		lock.lock();
+
+		m_FlushesDone = requests;
+		m_FlushCondition.notify_all();
+	}
+}
+
+void Logger::Drain()
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_RingsMutex };
+		m_pDrainRings.clear();
+		for (const std::unique_ptr<Ring>& pRing : m_pRings)
+			m_pDrainRings.push_back(pRing.get());
+	}
+
+	bool hasWritten = false;
+	for (Ring* pRing : m_pDrainRings)
+	{
+		uint32_t tail = pRing->Tail.load(std::memory_order_relaxed);
+		const uint32_t head = pRing->Head.load(std::memory_order_acquire);
+		while (tail != head)
+		{
+			Write(pRing->Records[tail & (RingCapacity - 1)]);
+			++tail;
+			pRing->Tail.store(tail, std::memory_order_release);
+			hasWritten = true;
+		}
+	}
+
+	const uint64_t droppedCount = m_DroppedCount.load(std::memory_order_relaxed);
+	if (droppedCount != m_ReportedDroppedCount)
+	{
+		m_Line = "[log] ";
+		m_Line += std::to_string(droppedCount - m_ReportedDroppedCount);
+		m_Line += " messages dropped, the game logged faster than the console could keep up\n";
+		WriteLine();
+		m_ReportedDroppedCount = droppedCount;
+		hasWritten = true;
+	}
+
+	if (hasWritten)
+	{
+		fflush(stdout);
+		if (m_pFile)
+			fflush(m_pFile);
+	}
+}
+
+void Logger::Write(const Record& record)
+{
+	char prefix[32];
+	const double seconds = static_cast<double>(record.Ticks - m_StartTicks) / static_cast<double>(GetTicksPerSecond());
+	snprintf(prefix, sizeof(prefix), "[%9.3f] %s ", seconds, GetLevelName(record.pSite->Level));
+	m_Line = prefix;
+
+	// Walks the printf format, every conversion is formatted on its own with the captured argument
+	uint32_t argumentIndex = 0;
+	for (const char* pChar = record.pFormat; *pChar != '\0'; ++pChar)
+	{
+		if (*pChar != '%')
+		{
+			m_Line += *pChar;
+			continue;
+		}
+		if (pChar[1] == '%')
+		{
+			m_Line += '%';
+			++pChar;
+			continue;
+		}
+
+		// Flags, width and precision are kept, the length is replaced by the one of the captured argument
+		m_Specification = "%";
+		++pChar;
+		while (*pChar != '\0' && strchr("-+ #0123456789.", *pChar))
+			m_Specification += *pChar++;
+		while (*pChar != '\0' && strchr("hlLjzt", *pChar))
+			++pChar;
+		if (*pChar == '\0')
+			break;
+
+		const Argument* pArgument = argumentIndex < record.ArgumentCount ? &record.Arguments[argumentIndex++] : nullptr;
+		FormatArgument(record, pArgument, *pChar);
+	}
+
+	// The messages do not have to end their line
+	while (!m_Line.empty() && m_Line.back() == '\n')
+		m_Line.pop_back();
+	if (record.RepeatCount > 0)
+	{
+		m_Line += " (repeated ";
+		m_Line += std::to_string(record.RepeatCount);
+		m_Line += " more times)";
+	}
+	m_Line += '\n';
+
+	WriteLine();
+	m_WrittenCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Logger::FormatArgument(const Record& record, const Argument* pArgument, char conversion)
+{
+	if (!pArgument)
+	{
+		m_Line += "<missing>";
+		return;
+	}
+
+	char buffer[128];
+	int size = 0;
+	switch (conversion)
+	{
+	case 'd':
+	case 'i':
+	{
+		const long long value = pArgument->Type == ArgumentType::Float ? static_cast<long long>(pArgument->Float) : static_cast<long long>(pArgument->Int);
+		m_Specification += "ll";
+		m_Specification += conversion;
+		size = snprintf(buffer, sizeof(buffer), m_Specification.c_str(), value);
+		break;
+	}
+	case 'u':
+	case 'o':
+	case 'x':
+	case 'X':
+	{
+		const unsigned long long value = pArgument->Type == ArgumentType::Float ? static_cast<unsigned long long>(pArgument->Float) : static_cast<unsigned long long>(pArgument->UInt);
+		m_Specification += "ll";
+		m_Specification += conversion;
+		size = snprintf(buffer, sizeof(buffer), m_Specification.c_str(), value);
+		break;
+	}
+	case 'c':
+		m_Specification += conversion;
+		size = snprintf(buffer, sizeof(buffer), m_Specification.c_str(), static_cast<int>(pArgument->Int));
+		break;
+	case 'e':
+	case 'E':
+	case 'f':
+	case 'F':
+	case 'g':
+	case 'G':
+	case 'a':
+	case 'A':
+	{
+		double value = pArgument->Float;
+		if (pArgument->Type == ArgumentType::Int)
+			value = static_cast<double>(pArgument->Int);
+		else if (pArgument->Type == ArgumentType::UInt)
+			value = static_cast<double>(pArgument->UInt);
+		m_Specification += conversion;
+		size = snprintf(buffer, sizeof(buffer), m_Specification.c_str(), value);
+		break;
+	}
+	case 's':
+		if (pArgument->Type != ArgumentType::String)
+		{
+			m_Line += "<not a string>";
+			return;
+		}
+		m_Specification += conversion;
+		size = snprintf(buffer, sizeof(buffer), m_Specification.c_str(), record.Strings + pArgument->StringOffset);
+		break;
+	case 'p':
+		m_Specification += conversion;
+		size = snprintf(buffer, sizeof(buffer), m_Specification.c_str(), pArgument->pPointer);
+		break;
+	default:
+		m_Line += m_Specification;
+		m_Line += conversion;
+		return;
+	}
+
+	if (size > 0)
+		m_Line.append(buffer, std::min(static_cast<size_t>(size), sizeof(buffer) - 1));
+}
+
+void Logger::WriteLine()
+{
+	fwrite(m_Line.data(), 1, m_Line.size(), stdout);
+	if (m_pFile)
+		fwrite(m_Line.data(), 1, m_Line.size(), m_pFile);
+}
@@ -0,0 +1,242 @@
+/*=============================================================================*/
+// ELogger.h: Asynchronous logging that keeps console and file output off the game thread
+/*=============================================================================*/
+#ifndef ELITE_LOGGER
+#define ELITE_LOGGER
+
+//--- Includes ---
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Compile-time switch, messages below this level are compiled out of the ELITE_LOG macros.
+// 0 = Debug, 1 = Info, 2 = Warning, 3 = Error. Define it for the whole project to change it.
+#ifndef ELITE_LOG_MIN_LEVEL
+#ifdef _DEBUG
+#define ELITE_LOG_MIN_LEVEL 0
+#else
+#define ELITE_LOG_MIN_LEVEL 1
+#endif
+#endif
+
+namespace Elite
+{
+	enum class LogLevel : uint8_t
+	{
+		Debug,
+		Info,
+		Warning,
+		Error
+	};
+
+	// One per ELITE_LOG statement, remembers the last message it wrote to drop repeats
+	struct LogSite
+	{
+		constexpr LogSite(LogLevel level, const char* pFile, int line) : Level(level), pFile(pFile), Line(line) {}
+
+		const LogLevel Level;
+		const char* const pFile;
+		const int Line;
+
+		std::atomic<uint64_t> LastHash{ 0 };
+		std::atomic<int64_t> LastTicks{ 0 };
+		std::atomic<uint32_t> RepeatCount{ 0 }; // Dropped since the last message that was written
+	};
+
+	//-----------------------------------------------------------------
+	// LOGGER
+	//-----------------------------------------------------------------
+	// Log only copies the format string pointer and its arguments into a fixed size record, the background thread does
+	// the formatting and the writing. Every thread that logs gets its own single-producer ring, so logging never locks
+	// or allocates after the first message of a thread. When a ring is full the message is dropped and counted.
+	//
+	// The format is printf-like and has to be a string literal, at most MaxArguments arguments of the basic types,
+	// const char* and std::string are supported. Strings are copied, up to StringCapacity bytes per message.
+	// A message with the same arguments as the previous one of the same statement is written at most once every
+	// RepeatInterval seconds, the next message that is written says how many were dropped.
+	// The rings are written out one after the other, messages of different threads can come out of order.
+	class Logger final
+	{
+	public:
+		static constexpr unsigned int MaxArguments{ 4 };
+		static constexpr unsigned int StringCapacity{ 64 };
+		static constexpr unsigned int RingCapacity{ 512 }; // Records per thread, a power of two
+		static constexpr double RepeatInterval{ 1.0 };
+
+		static Logger& GetInstance();
+
+		Logger(const Logger& other) = delete;
+		Logger& operator=(const Logger& other) = delete;
+		Logger(Logger&& other) = delete;
+		Logger& operator=(Logger&& other) = delete;
+
+		// Messages logged before Start are kept until the rings are full. filePath can be nullptr for console only.
+		void Start(const char* filePath = nullptr);
+		// Writes what is left and joins the background thread
+		void Stop();
+		// Blocks until everything logged before the call is written
+		void Flush();
+
+		template<typename... Args>
+		void Log(LogSite& site, const char* pFormat, const Args&... args);
+
+		uint64_t GetWrittenCount() const { return m_WrittenCount.load(std::memory_order_relaxed); }
+		uint64_t GetDroppedCount() const { return m_DroppedCount.load(std::memory_order_relaxed); }
+		uint64_t GetRepeatedCount() const { return m_RepeatedCount.load(std::memory_order_relaxed); }
+
+	private:
+		enum class ArgumentType : uint8_t
+		{
+			Int,
+			UInt,
+			Float,
+			String,
+			Pointer
+		};
+
+		struct Argument
+		{
+			ArgumentType Type;
+			union
+			{
+				int64_t Int;
+				uint64_t UInt;
+				double Float;
+				uint32_t StringOffset; // Into Record::Strings
+				const void* pPointer;
+			};
+		};
+
+		struct Record
+		{
+			const LogSite* pSite;
+			const char* pFormat;
+			int64_t Ticks;
+			uint32_t RepeatCount;
+			uint32_t ArgumentCount;
+			Argument Arguments[MaxArguments];
+			char Strings[StringCapacity];
+		};
+
+		// Written by one thread, read by the background thread
+		struct Ring
+		{
+			Record Records[RingCapacity];
+			alignas(64) std::atomic<uint32_t> Head{ 0 };
+			alignas(64) std::atomic<uint32_t> Tail{ 0 };
+		};
+
+		// Fills in the argument of a record that is being captured
+		struct Capture
+		{
+			Record* pRecord;
+			uint32_t StringSize;
+			uint64_t Hash;
+
+			void AddInt(int64_t value);
+			void AddUInt(uint64_t value);
+			void AddFloat(double value);
+			void AddString(const char* pString);
+			void AddPointer(const void* pPointer);
+
+			void Add(bool value) { AddInt(value); }
+			void Add(char value) { AddInt(value); }
+			void Add(signed char value) { AddInt(value); }
+			void Add(unsigned char value) { AddUInt(value); }
+			void Add(short value) { AddInt(value); }
+			void Add(unsigned short value) { AddUInt(value); }
+			void Add(int value) { AddInt(value); }
+			void Add(unsigned int value) { AddUInt(value); }
+			void Add(long value) { AddInt(value); }
+			void Add(unsigned long value) { AddUInt(value); }
+			void Add(long long value) { AddInt(value); }
+			void Add(unsigned long long value) { AddUInt(value); }
+			void Add(float value) { AddFloat(value); }
+			void Add(double value) { AddFloat(value); }
+			void Add(const char* pString) { AddString(pString); }
+			void Add(char* pString) { AddString(pString); }
+			void Add(const std::string& string) { AddString(string.c_str()); }
+			template<typename T>
+			void Add(T* pPointer) { AddPointer(pPointer); }
+		};
+
+		Logger() = default;
+		~Logger();
+
+		std::mutex m_RingsMutex{};
+		std::vector<std::unique_ptr<Ring>> m_pRings{};
+
+		std::thread m_Thread{};
+		std::mutex m_WakeMutex{};
+		std::condition_variable m_WakeCondition{};
+		bool m_IsRunning{ false };
+		uint64_t m_FlushRequests{ 0 }; // Guarded by m_WakeMutex
+		uint64_t m_FlushesDone{ 0 };   // Guarded by m_WakeMutex
+		std::condition_variable m_FlushCondition{};
+
+		// Only touched by the background thread, or by Stop after it joined
+		FILE* m_pFile{ nullptr };
+		std::string m_Line{};
+		std::string m_Specification{};
+		std::vector<Ring*> m_pDrainRings{};
+		uint64_t m_ReportedDroppedCount{ 0 };
+
+		const int64_t m_StartTicks{ GetTicks() };
+		std::atomic<uint64_t> m_WrittenCount{ 0 };
+		std::atomic<uint64_t> m_DroppedCount{ 0 };
+		std::atomic<uint64_t> m_RepeatedCount{ 0 };
+
+		static int64_t GetTicks();
+		static int64_t GetTicksPerSecond();
+		Ring* GetThreadRing();
+		Record* BeginRecord(LogSite& site, const char* pFormat, Ring*& pRing);
+		void EndRecord(LogSite& site, Record& record, Ring& ring, uint64_t hash);
+
+		void Run();
+		void Drain();
+		void Write(const Record& record);
+		void FormatArgument(const Record& record, const Argument* pArgument, char conversion);
+		void WriteLine();
+	};
+
+	template<typename... Args>
+	void Logger::Log(LogSite& site, const char* pFormat, const Args&... args)
+	{
+		static_assert(sizeof...(Args) <= MaxArguments, "Too many log arguments, see Logger::MaxArguments");
+
+		Ring* pRing = nullptr;
+		Record* pRecord = BeginRecord(site, pFormat, pRing);
+		if (!pRecord)
+			return;
+
+		Capture capture{ pRecord, 0, 14695981039346656037ull };
+		const int expand[]{ 0, (capture.Add(args), 0)... };
+		static_cast<void>(expand);
+
+		EndRecord(site, *pRecord, *pRing, capture.Hash);
+	}
+}
+
+// The statements compile to nothing when level is below ELITE_LOG_MIN_LEVEL, the arguments are still type checked
+#define ELITE_LOG(level, ...) \
+	do \
+	{ \
+		if (static_cast<int>(level) >= ELITE_LOG_MIN_LEVEL) \
+		{ \
+			static Elite::LogSite s_EliteLogSite{ level, __FILE__, __LINE__ }; \
+			Elite::Logger::GetInstance().Log(s_EliteLogSite, __VA_ARGS__); \
+		} \
+	} while (false)
+
+#define ELITE_LOG_DEBUG(...) ELITE_LOG(Elite::LogLevel::Debug, __VA_ARGS__)
+#define ELITE_LOG_INFO(...) ELITE_LOG(Elite::LogLevel::Info, __VA_ARGS__)
+#define ELITE_LOG_WARNING(...) ELITE_LOG(Elite::LogLevel::Warning, __VA_ARGS__)
+#define ELITE_LOG_ERROR(...) ELITE_LOG(Elite::LogLevel::Error, __VA_ARGS__)
+
+#endif
@@ -0,0 +1,128 @@
+//=== General Includes ===
+#include "stdafx.h"
+#include "EJobSystem.h"
+using namespace Elite;
+
+thread_local const JobSystem* JobSystem::s_pWorkerOwner = nullptr;
+thread_local unsigned int JobSystem::s_WorkerIndex = 0;
+
+unsigned int JobSystem::GetDefaultWorkerCount()
+{
+	// hardware_concurrency may report 0 when it does not know
+	const unsigned int hardwareThreads = std::thread::hardware_concurrency();
+	return hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+}
+
+JobSystem::JobSystem(unsigned int workerCount)
+{
+	m_Queues.reserve(workerCount + 1);
+	for (unsigned int i = 0; i <= workerCount; ++i)
+		m_Queues.push_back(std::make_unique<JobQueue>());
+
+	m_Workers.reserve(workerCount);
+	for (unsigned int i = 0; i < workerCount; ++i)
+		m_Workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_SleepMutex };
+		m_IsStopping = true;
+	}
+	m_WakeUp.notify_all();
+
+	for (std::thread& worker : m_Workers)
+		worker.join();
+}
+
+void JobSystem::Run(void(*fpFunction)(void* pData), void* pData, JobCounter& counter)
+{
+	counter.m_Count.fetch_add(1, std::memory_order_relaxed);
+
+	// Counted before it is queued so the count never drops below zero, taking the sleep mutex
+	// makes sure a worker that is about to sleep sees it
+	{
+		std::lock_guard<std::mutex> lock{ m_SleepMutex };
+		m_PendingJobCount.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	JobQueue& queue = *m_Queues[GetQueueIndex()];
+	{
+		std::lock_guard<std::mutex> lock{ queue.Mutex };
+		queue.Jobs.push_back(Job{ fpFunction, pData, &counter });
+	}
+	m_WakeUp.notify_one();
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+	const unsigned int queueIndex = GetQueueIndex();
+	while (!counter.IsDone())
+	{
+		if (!TryRunJob(queueIndex))
+			std::this_thread::yield();
+	}
+}
+
+unsigned int JobSystem::GetQueueIndex() const
+{
+	return s_pWorkerOwner == this ? s_WorkerIndex : static_cast<unsigned int>(m_Workers.size());
+}
+
+bool JobSystem::TryRunJob(unsigned int queueIndex)
+{
+	Job job{};
+	bool hasJob = false;
+
+	// Newest job of the own queue first, it is the most likely to still be in the cache
+	{
+		JobQueue& queue = *m_Queues[queueIndex];
+		std::lock_guard<std::mutex> lock{ queue.Mutex };
+		if (!queue.Jobs.empty())
+		{
+			job = queue.Jobs.back();
+			queue.Jobs.pop_back();
+			hasJob = true;
+		}
+	}
+
+	// Otherwise steal the oldest job of another queue
+	const size_t queueCount = m_Queues.size();
+	for (size_t i = 1; !hasJob && i < queueCount; ++i)
+	{
+		JobQueue& queue = *m_Queues[(queueIndex + i) % queueCount];
+		std::lock_guard<std::mutex> lock{ queue.Mutex };
+		if (!queue.Jobs.empty())
+		{
+			job = queue.Jobs.front();
+			queue.Jobs.pop_front();
+			hasJob = true;
+		}
+	}
+
+	if (!hasJob)
+		return false;
+
+	m_PendingJobCount.fetch_sub(1, std::memory_order_relaxed);
+	job.fpFunction(job.pData);
+	job.pCounter->m_Count.fetch_sub(1, std::memory_order_release);
+	return true;
+}
+
+void JobSystem::WorkerLoop(unsigned int workerIndex)
+{
+	s_pWorkerOwner = this;
+	s_WorkerIndex = workerIndex;
+
+	while (true)
+	{
+		if (TryRunJob(workerIndex))
+			continue;
+
+		std::unique_lock<std::mutex> lock{ m_SleepMutex };
+		m_WakeUp.wait(lock, [this]() { return m_IsStopping || m_PendingJobCount.load(std::memory_order_relaxed) > 0; });
+		if (m_IsStopping && m_PendingJobCount.load(std::memory_order_relaxed) == 0)
+			return;
+	}
+}
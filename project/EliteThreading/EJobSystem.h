@@ -0,0 +1,98 @@
+/*=============================================================================*/
+// EJobSystem.h: Small work-stealing thread pool for short jobs that are joined within a frame
+/*=============================================================================*/
+#ifndef ELITE_JOB_SYSTEM
+#define ELITE_JOB_SYSTEM
+
+//--- Includes ---
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Elite
+{
+	class JobCounter;
+
+	//--- JOB ---
+	// A plain function and its data, so queueing a job never allocates a closure
+	struct Job
+	{
+		void(*fpFunction)(void* pData) = nullptr;
+		void* pData = nullptr;
+		JobCounter* pCounter = nullptr;
+	};
+
+	//--- JOB COUNTER ---
+	// Counts the jobs of one batch that have not finished yet, JobSystem::Wait joins on it
+	class JobCounter final
+	{
+	public:
+		JobCounter() = default;
+		~JobCounter() = default;
+
+		JobCounter(const JobCounter& other) = delete;
+		JobCounter& operator=(const JobCounter& other) = delete;
+		JobCounter(JobCounter&& other) = delete;
+		JobCounter& operator=(JobCounter&& other) = delete;
+
+		bool IsDone() const { return m_Count.load(std::memory_order_acquire) == 0; }
+
+	private:
+		friend class JobSystem;
+		std::atomic<unsigned int> m_Count{ 0 };
+	};
+
+	//-----------------------------------------------------------------
+	// JOB SYSTEM
+	//-----------------------------------------------------------------
+	// Every worker has its own queue: it takes its newest job first and steals the oldest job of another queue
+	// when its own is empty. Threads that are not workers (the game thread) share one extra queue.
+	// A thread that waits on a counter runs jobs itself instead of blocking.
+	class JobSystem final
+	{
+	public:
+		// One worker less than there are hardware threads, the calling thread helps while it waits
+		static unsigned int GetDefaultWorkerCount();
+
+		explicit JobSystem(unsigned int workerCount = GetDefaultWorkerCount());
+		~JobSystem();
+
+		JobSystem(const JobSystem& other) = delete;
+		JobSystem& operator=(const JobSystem& other) = delete;
+		JobSystem(JobSystem&& other) = delete;
+		JobSystem& operator=(JobSystem&& other) = delete;
+
+		void Run(void(*fpFunction)(void* pData), void* pData, JobCounter& counter);
+		void Wait(JobCounter& counter);
+
+		unsigned int GetWorkerCount() const { return static_cast<unsigned int>(m_Workers.size()); }
+
+	private:
+		struct JobQueue
+		{
+			std::mutex Mutex{};
+			std::deque<Job> Jobs{};
+		};
+
+		// Index m_Workers.size() is the queue of the threads that are not workers
+		std::vector<std::unique_ptr<JobQueue>> m_Queues{};
+		std::vector<std::thread> m_Workers{};
+
+		std::atomic<unsigned int> m_PendingJobCount{ 0 };
+		std::mutex m_SleepMutex{};
+		std::condition_variable m_WakeUp{};
+		bool m_IsStopping{ false };
+
+		static thread_local const JobSystem* s_pWorkerOwner;
+		static thread_local unsigned int s_WorkerIndex;
+
+		unsigned int GetQueueIndex() const;
+		bool TryRunJob(unsigned int queueIndex);
+		void WorkerLoop(unsigned int workerIndex);
+	};
+}
+#endif
@@ -1,22 +1,26 @@
 #include "stdafx.h"
 #include "EntityManager.h"
+#include "EliteLogging/ELogger.h"
 
 ZombieGame::EntityManager::EntityManager(Elite::Blackboard* pBlackboard)
 {
 	bool success = pBlackboard->GetData("Interface", m_pInterface);
 	assert(success && m_pInterface && "Interface isn't stored correctly in Blackboard - EntityManager");
+
+	success = pBlackboard->GetData("Perception", m_pPerception);
+	assert(success && m_pPerception && "Perception isn't stored correctly in Blackboard - EntityManager");
 }
 
 void ZombieGame::EntityManager::Update(float dt)
 {
 	// Update PurgeZones
-	if (m_pInterface->FOV_GetStats().NumPurgeZones > 0)
+	if (!m_pPerception->GetPurgeZones().empty())
 	{
 		UpdatePurgeZones(dt);
 	}
 
 	//Update Enemies
-	if (m_pInterface->FOV_GetStats().NumEnemies > 0)
+	if (!m_pPerception->GetEnemies().empty())
 	{
 		UpdateEnemies(dt);
 	}
@@ -41,7 +45,7 @@ EnemyInfo* ZombieGame::EntityManager::GetStoredEnemy(const EnemyInfo& enemyInfo)
 
 void ZombieGame::EntityManager::UpdatePurgeZones(float dt)
 {
-	for (auto& purgeZone : m_pInterface->GetPurgeZonesInFOV())
+	for (auto& purgeZone : m_pPerception->GetPurgeZones())
 	{
 		// focus only on enemies inFOV :reset and recalculate purgezones in fov
 		/*m_PurgeZones.clear();*/
@@ -53,7 +57,7 @@ void ZombieGame::EntityManager::UpdatePurgeZones(float dt)
 		// check if current purgezone isn't stored
 		if (std::find_if(m_PurgeZones.begin(), m_PurgeZones.end(), comparePurgeZone) == m_PurgeZones.end())
 		{
-			std::cout << "New Purge Zone stored\n";
+			ELITE_LOG_INFO("New Purge Zone stored");
 
 			auto pPurgeZone = std::make_unique<PurgeZone>();
 			pPurgeZone->Center = purgeZone.Center;
@@ -95,7 +99,7 @@ void ZombieGame::EntityManager::UpdateEnemies(float dt)
 	// focus only on enemies inFOV :reset and recalculate enemiesinfov
 	m_Enemies.clear();
 
-	for (auto& enemyInfo : m_pInterface->GetEnemiesInFOV())
+	for (auto& enemyInfo : m_pPerception->GetEnemies())
 	{
 		auto uniqueEnemy = std::make_unique<EnemyInfo>(enemyInfo);
 		m_Enemies.emplace_back(std::move(uniqueEnemy));
@@ -108,7 +112,7 @@ EnemyInfo* ZombieGame::EntityManager::SetClosestEnemyAsTarget(const Elite::Vecto
 	float closestDistanceSquared = FLT_MAX;
 
 	// Get enemies from FOV
-	auto enemiesInFOV = m_pInterface->GetEnemiesInFOV();
+	const auto& enemiesInFOV = m_pPerception->GetEnemies();
 
 	// Find closest enemy
 	for (const auto& storedEnemy : m_Enemies)
@@ -133,10 +137,10 @@ EnemyInfo* ZombieGame::EntityManager::SetClosestEnemyAsTarget(const Elite::Vecto
 
 bool ZombieGame::EntityManager::IsAgentInPurgeZone(const Elite::Vector2& agentPosition) const
 {
-	if (m_pInterface->FOV_GetStats().NumPurgeZones > 0)
+	if (!m_pPerception->GetPurgeZones().empty())
 	{
 		float safeDistance{ 35.f };
-		for (const auto& purgeZone : m_pInterface->GetPurgeZonesInFOV())
+		for (const auto& purgeZone : m_pPerception->GetPurgeZones())
 		{
 				const float squaredDistance = Elite::DistanceSquared(agentPosition, purgeZone.Center);
 				if (squaredDistance - safeDistance < purgeZone.Radius * purgeZone.Radius)
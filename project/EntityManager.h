@@ -2,6 +2,7 @@
 #include "stdafx.h"
 #include "EliteData/EBlackboard.h"
 #include "IExamInterface.h"
+#include "PerceptionFrame.h"
 
 namespace ZombieGame
 {
@@ -23,6 +24,7 @@ namespace ZombieGame
 	private:
 		// Member variables
 		IExamInterface* m_pInterface{};
+		const PerceptionFrame* m_pPerception{};
 		std::vector<std::unique_ptr<EnemyInfo>> m_Enemies;
 		std::vector<std::unique_ptr<PurgeZone>> m_PurgeZones;
 
@@ -0,0 +1,253 @@
+#include "stdafx.h"
+#include "FlowField.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+constexpr int ZombieGame::FlowField::NoCell;
+
+namespace
+{
+    const float DiagonalStep{ 1.41421356f };
+    const float Unreachable{ std::numeric_limits<float>::infinity() };
+}
+
+void ZombieGame::FlowField::Initialize(int dimensions)
+{
+    m_Dimensions = dimensions;
+    const int cellCount = dimensions * dimensions;
+
+    // Every cell is its own frontier
+    m_Distances.assign(cellCount, 0.f);
+    m_NextCells.resize(cellCount);
+    for (int cellIndex = 0; cellIndex < cellCount; ++cellIndex)
+    {
+        m_NextCells[cellIndex] = cellIndex;
+    }
+    m_Costs.assign(cellCount, 1.f);
+    m_IsUnvisited.assign(cellCount, 1);
+
+    m_Affected.clear();
+    m_Affected.reserve(cellCount);
+    m_Cheaper.clear();
+    m_Cheaper.reserve(cellCount);
+    m_IsAffected.assign(cellCount, 0);
+    m_Open.clear();
+    m_Open.reserve(cellCount);
+    m_LastRepairedCount = 0;
+}
+
+bool ZombieGame::FlowField::SetVisited(int cellIndex)
+{
+    if (!m_IsUnvisited[cellIndex])
+        return false;
+
+    m_IsUnvisited[cellIndex] = 0;
+
+    // Distances only grow when a source goes away, and only for the cells whose flow ran through it
+    m_Affected.clear();
+    m_Affected.push_back(cellIndex);
+    m_IsAffected[cellIndex] = 1;
+
+    RepairAffected();
+    Propagate();
+    return true;
+}
+
+bool ZombieGame::FlowField::SetUnvisited(int cellIndex)
+{
+    if (m_IsUnvisited[cellIndex])
+        return false;
+
+    // The cell becomes a source again and takes over the cells that are closer to it
+    m_IsUnvisited[cellIndex] = 1;
+    m_Distances[cellIndex] = 0.f;
+    m_NextCells[cellIndex] = cellIndex;
+
+    m_LastRepairedCount = 1;
+    Push(0.f, cellIndex);
+    Propagate();
+    return true;
+}
+
+void ZombieGame::FlowField::UpdateCosts(const std::vector<float>& costs)
+{
+    // A cell that got more expensive only changes the distances of the cells whose flow enters it,
+    // a cell that got cheaper can only make the distances around it shorter
+    m_Affected.clear();
+    m_Cheaper.clear();
+
+    int neighbors[8];
+    float steps[8];
+    const int cellCount = static_cast<int>(m_Costs.size());
+    for (int cellIndex = 0; cellIndex < cellCount; ++cellIndex)
+    {
+        if (costs[cellIndex] == m_Costs[cellIndex])
+            continue;
+
+        if (costs[cellIndex] < m_Costs[cellIndex])
+        {
+            m_Costs[cellIndex] = costs[cellIndex];
+            m_Cheaper.push_back(cellIndex);
+            continue;
+        }
+
+        m_Costs[cellIndex] = costs[cellIndex];
+        const int neighborCount = GetNeighbors(cellIndex, neighbors, steps);
+        for (int neighborIndex = 0; neighborIndex < neighborCount; ++neighborIndex)
+        {
+            const int neighbor = neighbors[neighborIndex];
+            if (!m_IsAffected[neighbor] && m_NextCells[neighbor] == cellIndex)
+            {
+                m_IsAffected[neighbor] = 1;
+                m_Affected.push_back(neighbor);
+            }
+        }
+    }
+
+    m_LastRepairedCount = 0;
+    if (!m_Affected.empty())
+        RepairAffected();
+
+    for (const int cheaper : m_Cheaper)
+    {
+        if (m_NextCells[cheaper] != NoCell)
+            Push(m_Distances[cheaper], cheaper);
+    }
+    m_LastRepairedCount += static_cast<int>(m_Cheaper.size());
+    Propagate();
+}
+
+void ZombieGame::FlowField::RepairAffected()
+{
+    // Every cell that points at an affected cell is affected as well
+    int neighbors[8];
+    float steps[8];
+    for (size_t affectedIndex = 0; affectedIndex < m_Affected.size(); ++affectedIndex)
+    {
+        const int affected = m_Affected[affectedIndex];
+        const int neighborCount = GetNeighbors(affected, neighbors, steps);
+        for (int neighborIndex = 0; neighborIndex < neighborCount; ++neighborIndex)
+        {
+            const int neighbor = neighbors[neighborIndex];
+            if (!m_IsAffected[neighbor] && m_NextCells[neighbor] == affected)
+            {
+                m_IsAffected[neighbor] = 1;
+                m_Affected.push_back(neighbor);
+            }
+        }
+    }
+
+    for (const int affected : m_Affected)
+    {
+        m_Distances[affected] = Unreachable;
+        m_NextCells[affected] = NoCell;
+    }
+
+    // Rebuild them from the cells around them that kept their distance
+    for (const int affected : m_Affected)
+    {
+        const int neighborCount = GetNeighbors(affected, neighbors, steps);
+        for (int neighborIndex = 0; neighborIndex < neighborCount; ++neighborIndex)
+        {
+            const int neighbor = neighbors[neighborIndex];
+            const float distance = m_Distances[neighbor] + steps[neighborIndex] * m_Costs[neighbor];
+            if (!m_IsAffected[neighbor] && distance < m_Distances[affected])
+            {
+                m_Distances[affected] = distance;
+                m_NextCells[affected] = neighbor;
+            }
+        }
+
+        if (m_NextCells[affected] != NoCell)
+            Push(m_Distances[affected], affected);
+    }
+
+    for (const int affected : m_Affected)
+    {
+        m_IsAffected[affected] = 0;
+    }
+
+    m_LastRepairedCount = static_cast<int>(m_Affected.size());
+}
+
+int ZombieGame::FlowField::GetTargetCell(int cellIndex) const
+{
+    int targetCell = cellIndex;
+    while (targetCell != NoCell && m_NextCells[targetCell] != targetCell)
+    {
+        targetCell = m_NextCells[targetCell];
+    }
+    return targetCell;
+}
+
+Elite::Vector2 ZombieGame::FlowField::GetDirection(int cellIndex) const
+{
+    const int nextCell = m_NextCells[cellIndex];
+    if (nextCell == NoCell || nextCell == cellIndex)
+        return Elite::Vector2{};
+
+    Elite::Vector2 direction{ static_cast<float>(nextCell % m_Dimensions - cellIndex % m_Dimensions),
+        static_cast<float>(nextCell / m_Dimensions - cellIndex / m_Dimensions) };
+    direction.Normalize();
+    return direction;
+}
+
+int ZombieGame::FlowField::GetNeighbors(int cellIndex, int (&neighbors)[8], float (&steps)[8]) const
+{
+    const int row = cellIndex / m_Dimensions;
+    const int column = cellIndex % m_Dimensions;
+
+    int count = 0;
+    for (int neighborRow = std::max(row - 1, 0); neighborRow <= std::min(row + 1, m_Dimensions - 1); ++neighborRow)
+    {
+        for (int neighborColumn = std::max(column - 1, 0); neighborColumn <= std::min(column + 1, m_Dimensions - 1); ++neighborColumn)
+        {
+            if (neighborRow == row && neighborColumn == column)
+                continue;
+
+            neighbors[count] = neighborRow * m_Dimensions + neighborColumn;
+            steps[count] = (neighborRow != row && neighborColumn != column) ? DiagonalStep : 1.f;
+            ++count;
+        }
+    }
+    return count;
+}
+
+void ZombieGame::FlowField::Push(float distance, int cellIndex)
+{
+    m_Open.emplace_back(distance, cellIndex);
+    std::push_heap(m_Open.begin(), m_Open.end(), std::greater<std::pair<float, int>>{});
+}
+
+void ZombieGame::FlowField::Propagate()
+{
+    int neighbors[8];
+    float steps[8];
+    while (!m_Open.empty())
+    {
+        std::pop_heap(m_Open.begin(), m_Open.end(), std::greater<std::pair<float, int>>{});
+        const std::pair<float, int> entry = m_Open.back();
+        m_Open.pop_back();
+
+        // Queued again with a shorter distance since
+        const int cellIndex = entry.second;
+        if (entry.first > m_Distances[cellIndex])
+            continue;
+
+        const int neighborCount = GetNeighbors(cellIndex, neighbors, steps);
+        for (int neighborIndex = 0; neighborIndex < neighborCount; ++neighborIndex)
+        {
+            const int neighbor = neighbors[neighborIndex];
+            const float distance = entry.first + steps[neighborIndex] * m_Costs[cellIndex];
+            if (distance < m_Distances[neighbor])
+            {
+                m_Distances[neighbor] = distance;
+                m_NextCells[neighbor] = cellIndex;
+                Push(distance, neighbor);
+                ++m_LastRepairedCount;
+            }
+        }
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include "EliteMath/EMath.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace ZombieGame
+{
+	// Flow towards the cheapest unvisited cell of a square grid, for every cell the next cell to move to.
+	// The distances are 8-connected path costs from all unvisited cells at once (a multi-source Dijkstra), the
+	// visited cells next to them are the exploration frontier. Entering a cell costs the step length times the cost of
+	// the cell, like in GridPathfinder, so the flow bends around danger. Every cell points at the neighbor its distance
+	// came from, so following the field from any cell walks the cheapest way to the frontier.
+	//
+	// Visiting a cell or making it more expensive only repairs the cells whose flow went through it: their distances
+	// are dropped and rebuilt from the cells around them. A cell that got cheaper spreads from itself.
+	// Reading the field is O(1) whatever the size of the grid.
+	class FlowField final
+	{
+	public:
+		static constexpr int NoCell{ -1 };
+
+		FlowField() = default;
+		~FlowField() = default;
+
+		FlowField(const FlowField& other) = delete;
+		FlowField& operator=(const FlowField& other) = delete;
+		FlowField(FlowField&& other) = delete;
+		FlowField& operator=(FlowField&& other) = delete;
+
+		// Every cell starts unvisited with cost 1
+		void Initialize(int dimensions);
+		// One cost per cell, at least 1. Only the cells whose cost differs from the previous call are repaired.
+		void UpdateCosts(const std::vector<float>& costs);
+
+		// Both return false when the cell already had that state
+		bool SetVisited(int cellIndex);
+		bool SetUnvisited(int cellIndex);
+
+		// The cell itself when it is unvisited, NoCell when every cell is visited
+		int GetNextCell(int cellIndex) const { return m_NextCells[cellIndex]; }
+		// Unit vector in grid space (x = column, y = row), zero for an unvisited cell or when every cell is visited
+		Elite::Vector2 GetDirection(int cellIndex) const;
+		// Summed cost of the steps, 0 for an unvisited cell
+		float GetDistance(int cellIndex) const { return m_Distances[cellIndex]; }
+		// Unvisited cell the flow from the cell ends in, NoCell when every cell is visited. Walks the flow, O(path length).
+		int GetTargetCell(int cellIndex) const;
+
+		// Cells the last SetVisited, SetUnvisited or UpdateCosts had to look at again
+		int GetLastRepairedCount() const { return m_LastRepairedCount; }
+
+	private:
+		int m_Dimensions{ 0 };
+		std::vector<float> m_Distances{};
+		std::vector<int> m_NextCells{};
+		std::vector<float> m_Costs{};
+		std::vector<uint8_t> m_IsUnvisited{};
+
+		// Repair state
+		std::vector<int> m_Affected{};
+		std::vector<int> m_Cheaper{};
+		std::vector<uint8_t> m_IsAffected{};
+		std::vector<std::pair<float, int>> m_Open{}; // Min-heap of (distance, cell)
+		int m_LastRepairedCount{ 0 };
+
+		// Writes the up to 8 neighbors of the cell with the length of the step to them, returns how many there are
+		int GetNeighbors(int cellIndex, int (&neighbors)[8], float (&steps)[8]) const;
+		void Push(float distance, int cellIndex);
+		// Drops the distances of m_Affected and of every cell whose flow goes through them, then rebuilds them
+		void RepairAffected();
+		void Propagate();
+	};
+}
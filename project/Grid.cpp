@@ -5,7 +5,9 @@
 #include <cmath>
 
 #include "IExamInterface.h"
+#include "BlackboardKeys.h"
 #include "HouseManager.h"
+#include "InventoryManager.h"
 
 using namespace ZombieGame;
 
@@ -19,11 +21,12 @@ Grid::Grid(Elite::Blackboard* pBlackboard, int cellDimension)
     if (!m_pBlackboard->GetData("Interface", m_pInterface) || !m_pInterface)
         throw std::runtime_error("Interface isn't correctly stored in blackboard.");
 
-    // Initialize grid and neighborins
+    // Initialize grid
     InitializeGrid();
-    InitializeNeighbors();
 }
 
+constexpr int Grid::InvalidCell;
+
     void Grid::InitializeGrid()
     {
         // start middle of the world -> middle of the grid
@@ -33,79 +36,113 @@ Grid::Grid(Elite::Blackboard* pBlackboard, int cellDimension)
         m_CellSize = world.Dimensions.x / m_CellDimensions;
         m_HalfCellSize = m_CellSize * 0.5f;
 
-        int maxCells{ m_CellDimensions * m_CellDimensions };
+        const int maxCells{ m_CellDimensions * m_CellDimensions };
+
+        // every array is allocated once
+        m_CellPositions.resize(maxCells);
+        m_VisitedMap.Initialize(m_CellDimensions);
+        m_FlowField.Initialize(m_CellDimensions);
 
-        // optimization reasons
-        m_GridCells.reserve(maxCells);
-        m_VisitedCells.reserve(maxCells);
-        m_UnVisitedCells.reserve(maxCells);
+        // Danger fades slower than it builds up, so the agent keeps away from where enemies were for a while
+        m_InfluenceMap.Initialize(m_CellDimensions, m_NeighborInfluenceBoost);
+        m_InfluenceMap.SetLayerSettings(InfluenceLayer::EnemyDanger, -1.f, 0.9f);
+        m_InfluenceMap.SetLayerSettings(InfluenceLayer::ItemAttraction, 0.6f, 0.95f);
+        m_InfluenceMap.SetLayerSettings(InfluenceLayer::HouseAttraction, 0.4f, 0.95f);
+        m_InfluenceMap.SetLayerSettings(InfluenceLayer::PurgeZoneRepulsion, -2.f, 0.8f);
+        m_Pathfinder.Initialize(m_CellDimensions);
 
         for (int row = 0; row < m_CellDimensions; ++row)
         {
             for (int column = 0; column < m_CellDimensions; ++column)
             {
-                auto pNewCell = std::make_unique<Cell>();
-                pNewCell->Position = m_GridStartPosition + Elite::Vector2{ column * m_CellSize, row * m_CellSize };
-                m_GridCells.emplace_back(std::move(pNewCell));                
+                m_CellPositions[row * m_CellDimensions + column] = m_GridStartPosition + Elite::Vector2{ column * m_CellSize, row * m_CellSize };
             }
         }
     }
 
-    void Grid::InitializeNeighbors()
+    int Grid::GetNeighbors(int cellIndex, int (&neighbors)[8]) const
     {
-        for (int row = 0; row < m_CellDimensions; ++row)
+        const int row = cellIndex / m_CellDimensions;
+        const int column = cellIndex % m_CellDimensions;
+
+        int count = 0;
+        for (int i = -1; i <= 1; ++i)
         {
-            for (int column = 0; column < m_CellDimensions; ++column)
+            for (int j = -1; j <= 1; ++j)
             {
-                Cell* currentCell = m_GridCells[row * m_CellDimensions + column].get();
-                for (int i = -1; i <= 1; ++i)
+                if (i == 0 && j == 0) continue; // Skip the current cell
+                int neighborRow = row + i;
+                int neighborColumn = column + j;
+                if (neighborRow >= 0 && neighborRow < m_CellDimensions && neighborColumn >= 0 && neighborColumn < m_CellDimensions) // grid boundaries
                 {
-                    for (int j = -1; j <= 1; ++j)
-                    {
-                        if (i == 0 && j == 0) continue; // Skip the current cell
-                        int neighborRow = row + i;
-                        int neighborColumn = column + j;
-                        if (neighborRow >= 0 && neighborRow < m_CellDimensions && neighborColumn >= 0 && neighborColumn < m_CellDimensions) // grid boundaries
-                        {
-                            Cell* neighborCell = m_GridCells[neighborRow * m_CellDimensions + neighborColumn].get();
-                            currentCell->pNeighbors.push_back(neighborCell);
-                        }
-                    }
+                    neighbors[count++] = neighborRow * m_CellDimensions + neighborColumn;
                 }
             }
         }
+        return count;
     }
 
     void Grid::UpdateCurrentAgentCell(AgentInfo* agent)
     {
+        // Outside grid bounds gives no cell
+        m_CurrentAgentCell = GetCellIndex(agent->Position);
+        if (m_CurrentAgentCell == InvalidCell)
+            return;
+
+        // Check if agent is close enough to the center of the cell to mark it as visited
+        const float distanceToCellCenter = Elite::Distance(agent->Position, m_CellPositions[m_CurrentAgentCell]);
+        if (distanceToCellCenter < m_VisitDistanceThreshold)
+        {
+            SetCellVisited(m_CurrentAgentCell);
+        }
+    }
 
-        // Convert agents position to grid coordinates
-        int row, column;
-        PositionToGridCoordinates(agent->Position, row, column);
+    void Grid::UpdateInfluenceMap()
+    {
+        m_InfluenceMap.ClearSources();
 
-        // grid boundary check
-        if (row >= 0 && row < m_CellDimensions && column >= 0 && column < m_CellDimensions)
+        const PerceptionFrame* pPerception = m_pBlackboard->GetData(BB::Perception);
+        if (pPerception)
         {
-            Cell* potentialAgentCell = m_GridCells[row * m_CellDimensions + column].get();
-
-            // Check if agent is close enough to the center of the cell to mark it as visited
-            Elite::Vector2 cellCenter = potentialAgentCell->Position;
-            float distanceToCellCenter = Elite::Distance(agent->Position, cellCenter);
+            for (const EnemyInfo& enemy : pPerception->GetEnemies())
+            {
+                m_InfluenceMap.AddSource(InfluenceLayer::EnemyDanger, GetCellIndex(enemy.Location), 1.f);
+            }
 
-            if (distanceToCellCenter < m_VisitDistanceThreshold)
+            for (const PurgeZoneInfo& purgeZone : pPerception->GetPurgeZones())
             {
-                m_pCurrentAgentCell = potentialAgentCell;
-                m_pCurrentAgentCell->IsVisited = true; // Mark as visited only if within threshold distance
+                int row, column;
+                PositionToGridCoordinates(purgeZone.Center, row, column);
+                const int radiusInCells = static_cast<int>(std::ceil(purgeZone.Radius / m_CellSize));
+                m_InfluenceMap.AddSource(InfluenceLayer::PurgeZoneRepulsion, row, column, 1.f, radiusInCells);
             }
-            else
+        }
+
+        // Only what is still worth a visit attracts the agent
+        HouseManager* pHouseManager = m_pBlackboard->GetData(BB::HouseManager);
+        if (pHouseManager)
+        {
+            for (const auto& pHouse : pHouseManager->GetStoredHouses())
             {
-                m_pCurrentAgentCell = potentialAgentCell; // Update current cell but don't mark as visited
+                if (!pHouse->IsVisited)
+                    m_InfluenceMap.AddSource(InfluenceLayer::HouseAttraction, GetCellIndex(pHouse->Center), 1.f);
             }
         }
-        else
+
+        const InventoryManager* pInventoryManager = m_pBlackboard->GetData(BB::InventoryManager);
+        if (pInventoryManager)
         {
-            m_pCurrentAgentCell = nullptr; // Outside grid bounds
+            for (const auto& pItem : pInventoryManager->GetStoredItems())
+            {
+                if (!pItem->IsVisited)
+                    m_InfluenceMap.AddSource(InfluenceLayer::ItemAttraction, GetCellIndex(pItem->itemInfo.Location), 1.f);
+            }
         }
+
+        m_InfluenceMap.Update();
+        m_Pathfinder.UpdateCosts(m_InfluenceMap);
+        // The flow field steps on the same costs, so exploration goes around danger as well
+        m_FlowField.UpdateCosts(m_Pathfinder.GetCellCosts());
     }
 
     void Grid::RenderGrid() const
@@ -116,27 +153,24 @@ Grid::Grid(Elite::Blackboard* pBlackboard, int cellDimension)
 
     void Grid::RenderVisitedCells(const Elite::Vector3& color) const
     {
-        for (const auto& cell : m_GridCells) {
-            if (cell && cell->IsVisited) {
-                RenderCell(*cell, color);
-            }
-        }
+        m_VisitedMap.ForEachVisited([this, &color](int cellIndex) { RenderCell(cellIndex, color); });
     }
 
     void Grid::RenderCurrentCell(const Elite::Vector3& color) const
     {
-        if (m_pCurrentAgentCell) 
+        if (m_CurrentAgentCell != InvalidCell) 
         {
-            RenderCell(*m_pCurrentAgentCell, color);
+            RenderCell(m_CurrentAgentCell, color);
         }
     }
 
-    void Grid::RenderCell(const Cell& cell, const Elite::Vector3& color) const
+    void Grid::RenderCell(int cellIndex, const Elite::Vector3& color) const
     {
-        Elite::Vector2 topLeft = cell.Position + Elite::Vector2{ -m_HalfCellSize, -m_HalfCellSize };
-        Elite::Vector2 topRight = cell.Position + Elite::Vector2{ m_HalfCellSize, -m_HalfCellSize };
-        Elite::Vector2 bottomLeft = cell.Position + Elite::Vector2{ -m_HalfCellSize, m_HalfCellSize };
-        Elite::Vector2 bottomRight = cell.Position + Elite::Vector2{ m_HalfCellSize, m_HalfCellSize };
+        const Elite::Vector2& position = m_CellPositions[cellIndex];
+        Elite::Vector2 topLeft = position + Elite::Vector2{ -m_HalfCellSize, -m_HalfCellSize };
+        Elite::Vector2 topRight = position + Elite::Vector2{ m_HalfCellSize, -m_HalfCellSize };
+        Elite::Vector2 bottomLeft = position + Elite::Vector2{ -m_HalfCellSize, m_HalfCellSize };
+        Elite::Vector2 bottomRight = position + Elite::Vector2{ m_HalfCellSize, m_HalfCellSize };
 
         m_pInterface->Draw_Segment(topLeft, bottomLeft, color);
         m_pInterface->Draw_Segment(bottomLeft, bottomRight, color);
@@ -146,36 +180,69 @@ Grid::Grid(Elite::Blackboard* pBlackboard, int cellDimension)
 
     void ZombieGame::Grid::SetCurrentCellVisited()
     {
-        for (auto& pCell : m_GridCells)
+        if (m_CurrentAgentCell != InvalidCell)
         {
-            if (m_pCurrentAgentCell == pCell.get())
-            {
-                pCell->IsVisited = true;
-            }
+            SetCellVisited(m_CurrentAgentCell);
+        }
+    }
+
 
+    void Grid::SetCellVisited(int cellIndex)
+    {
+        // The flow field only repairs the cells that flowed through a cell that changed
+        if (m_VisitedMap.SetVisited(cellIndex))
+        {
+            m_FlowField.SetVisited(cellIndex);
         }
     }
 
+    Cell Grid::GetExplorationCell(const AgentInfo* agent)
+    {
+        if (m_UseFlowField)
+            return GetFlowFieldTargetCell();
+
+        return GetExpandSquareSearchCell(agent);
+    }
+
+    Cell Grid::GetFlowFieldCell() const
+    {
+        if (m_CurrentAgentCell == InvalidCell)
+            return Cell{};
+
+        return GetCell(m_FlowField.GetNextCell(m_CurrentAgentCell));
+    }
+
+    Cell Grid::GetFlowFieldTargetCell() const
+    {
+        if (m_CurrentAgentCell == InvalidCell)
+            return Cell{};
+
+        return GetCell(m_FlowField.GetTargetCell(m_CurrentAgentCell));
+    }
+
 
     //https://en.wikipedia.org/wiki/Water_surface_searches#Expanding_square_search    
 
-    Cell* Grid::GetExpandSquareSearchCell(const AgentInfo* agent)
+    Cell Grid::GetExpandSquareSearchCell(const AgentInfo* agent)
     {
         // No lastVisitedCell = Start Expanding Square Search
-        if (m_pLastVisitedCell == nullptr)
+        if (m_LastVisitedCell == InvalidCell)
         {
-            m_pLastVisitedCell = m_pCurrentAgentCell;
+            m_LastVisitedCell = m_CurrentAgentCell;
+            if (m_LastVisitedCell == InvalidCell)
+                return Cell{};
+
             m_StepsTaken = 0; // steps = moved cells
             m_CurrentSideLength = 1; // smallest side length of 1 cell
             m_CurrentDirection = Direction::RIGHT; // Start moving to the right
             PlanLeg(); // Plan the first leg
-            return m_pLastVisitedCell;
+            return GetCell(m_LastVisitedCell);
         }
 
         // Cell has to be visited before going to the next cell
-        if (!m_pLastVisitedCell->IsVisited)
+        if (!IsCellVisited(m_LastVisitedCell))
         {
-            return m_pLastVisitedCell;
+            return GetCell(m_LastVisitedCell);
         }
 
         // If the current leg is finished, plan the next leg
@@ -186,18 +253,52 @@ Grid::Grid(Elite::Blackboard* pBlackboard, int cellDimension)
 
         while (!m_LegQueue.empty())
         {
-            Cell* nextCell = m_LegQueue.front();
+            const int nextCell = m_LegQueue.front();
             m_LegQueue.pop();
 
-            if (!nextCell->IsVisited)
+            if (!IsCellVisited(nextCell) && GetCellInfluence(nextCell) >= m_AvoidInfluence)
             {
-                m_pLastVisitedCell = nextCell; 
-                return nextCell;
+                m_LastVisitedCell = nextCell; 
+                return GetCell(nextCell);
             }
             
         }
 
-        return nullptr;
+        // Every cell of the leg was visited already, continue from the closest cell that was not
+        const int nearestCell = m_CurrentAgentCell != InvalidCell ? m_VisitedMap.GetNearestUnvisited(m_CurrentAgentCell) : InvalidCell;
+        if (nearestCell != InvalidCell)
+        {
+            m_LastVisitedCell = nearestCell;
+            return GetCell(nearestCell);
+        }
+
+        return Cell{};
+    }
+
+    int Grid::CountUnvisitedCells(const Elite::Vector2& center, int radiusInCells) const
+    {
+        int row, column;
+        PositionToGridCoordinates(center, row, column);
+        return m_VisitedMap.CountUnvisited(row - radiusInCells, column - radiusInCells, row + radiusInCells, column + radiusInCells);
+    }
+
+    Cell Grid::GetNearestUnvisitedCell(const Elite::Vector2& position) const
+    {
+        const int cellIndex = GetCellIndex(position);
+        if (cellIndex == InvalidCell)
+            return Cell{};
+
+        return GetCell(m_VisitedMap.GetNearestUnvisited(cellIndex));
+    }
+
+
+    Cell Grid::GetNextPathCell(int goalCell)
+    {
+        const std::vector<int>& path = m_Pathfinder.FindPath(m_CurrentAgentCell, goalCell);
+        if (path.size() < 2)
+            return GetCell(goalCell);
+
+        return GetCell(path[1]);
     }
 
 
@@ -223,11 +324,19 @@ Grid::Grid(Elite::Blackboard* pBlackboard, int cellDimension)
         row = (row + m_CellDimensions) % m_CellDimensions;
     }
 
-    Cell* ZombieGame::Grid::GetCellAtGridCoordinates(int row, int column) {
+    int ZombieGame::Grid::GetCellIndex(int row, int column) const
+    {
         if (row < 0 || row >= m_CellDimensions || column < 0 || column >= m_CellDimensions)
-            return nullptr;
+            return InvalidCell;
 
-        return m_GridCells[row * m_CellDimensions + column].get();
+        return row * m_CellDimensions + column;
+    }
+
+    int ZombieGame::Grid::GetCellIndex(const Elite::Vector2& position) const
+    {
+        int row, column;
+        PositionToGridCoordinates(position, row, column);
+        return GetCellIndex(row, column);
     }
 
 
@@ -237,43 +346,44 @@ Grid::Grid(Elite::Blackboard* pBlackboard, int cellDimension)
         row = static_cast<int>(std::floor((position.y - m_GridStartPosition.y + m_HalfCellSize) / m_CellSize));
     }
 
-    const std::vector<std::unique_ptr<Cell>>& Grid::GetGridCells() const
+    Cell Grid::GetCell(int cellIndex) const
     {
-        return m_GridCells;;
+        if (cellIndex < 0 || cellIndex >= GetCellCount())
+            return Cell{};
+
+        Cell cell{};
+        cell.Index = cellIndex;
+        cell.Position = m_CellPositions[cellIndex];
+        cell.IsVisited = IsCellVisited(cellIndex);
+        cell.Influence = m_InfluenceMap.GetInfluence(cellIndex);
+        return cell;
     }
 
-    Cell* Grid::GetCurrentAgentCell() const
+    Cell Grid::GetCurrentAgentCell() const
     {
-        return m_pCurrentAgentCell;
+        return GetCell(m_CurrentAgentCell);
     }
 
     void Grid::MarkCellVisited(const Elite::Vector2& position)
     {
-        // Convert the position to grid coordinates
-        int row, column;
-        PositionToGridCoordinates(position, row, column);
-
-        // Check if the calculated row and column are within the grid boundaries
-        if (row >= 0 && row < m_CellDimensions && column >= 0 && column < m_CellDimensions)
+        // Check if the position is within the grid boundaries
+        const int cellIndex = GetCellIndex(position);
+        if (cellIndex != InvalidCell)
         {
-            Cell* cell = m_GridCells[row * m_CellDimensions + column].get();
-            if (cell)
-            {
-                cell->IsVisited = true;
-            }
+            SetCellVisited(cellIndex);
         }
     }
 
     void Grid::PlanLeg()
     {
-        int row, column;
-        PositionToGridCoordinates(m_pLastVisitedCell->Position, row, column);
+        int row = m_LastVisitedCell / m_CellDimensions;
+        int column = m_LastVisitedCell % m_CellDimensions;
 
         for (int step = 0; step < m_CurrentSideLength; ++step)
         {
             UpdateCoordinatesForDirection(row, column);
-            Cell* nextCell = GetCellAtGridCoordinates(row, column);
-            if (nextCell)
+            const int nextCell = GetCellIndex(row, column);
+            if (nextCell != InvalidCell)
             {
                 m_LegQueue.push(nextCell);
             }
@@ -290,16 +400,16 @@ Grid::Grid(Elite::Blackboard* pBlackboard, int cellDimension)
     void Grid::StoreLastVisitedCell()
     {
         // Call before deviating from search: visiting houses, grabbing items...
-        m_pLastCellBeforeDeviation = m_pLastVisitedCell;
+        m_LastCellBeforeDeviation = m_LastVisitedCell;
     }
 
     void Grid::ResumeSearchFromLastVisitedCell()
     {
-        if (m_pLastCellBeforeDeviation != nullptr)
+        if (m_LastCellBeforeDeviation != InvalidCell)
         {
             // resume from the last visited cell
-            m_pLastVisitedCell = m_pLastCellBeforeDeviation;
-            m_pLastCellBeforeDeviation = nullptr;
+            m_LastVisitedCell = m_LastCellBeforeDeviation;
+            m_LastCellBeforeDeviation = InvalidCell;
             UpdateLegQueue(); // remove visited cells from que
             PlanLeg(); 
         }
@@ -307,16 +417,15 @@ Grid::Grid(Elite::Blackboard* pBlackboard, int cellDimension)
 
     void Grid::UpdateLegQueue()
     {
-        std::queue<Cell*> updatedQueue;
+        std::queue<int> updatedQueue;
         while (!m_LegQueue.empty())
         {
-            Cell* cell = m_LegQueue.front();
+            const int cell = m_LegQueue.front();
             m_LegQueue.pop();
-            if (!cell->IsVisited)
+            if (!IsCellVisited(cell))
             {
                 updatedQueue.push(cell);
             }
         }
         m_LegQueue = std::move(updatedQueue);
     }
-
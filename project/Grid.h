@@ -1,15 +1,23 @@
 #pragma once
 #include "EliteBehaviorTree/EDecisionMaking.h"
+#include "FlowField.h"
+#include "GridPathfinder.h"
+#include "InfluenceMap.h"
+#include "VisitedMap.h"
 
 #include <vector>
-#include <memory> // smartpointers
+#include <cstdint>
+#include <queue>
 
+// Read-only copy of one cell, the grid itself stores its cells as arrays
 struct Cell
 {
+	int Index{ -1 }; // row * cell dimensions + column, -1 when there is no cell
 	Elite::Vector2 Position{};
 	bool IsVisited{ false };
-    std::vector<Cell*> pNeighbors{}; // Cells are already owned
-    float Influence{};
+	float Influence{};
+
+	bool IsValid() const { return Index >= 0; }
 };
 
 class IExamInterface;
@@ -17,21 +25,58 @@ struct AgentInfo;
 
 namespace ZombieGame
 {
+    // Square grid over the world, stored as a structure of arrays indexed by row * m_CellDimensions + column.
+    // Neighbors are computed from the index, the grid does not allocate after its construction.
     class Grid final
     {
     public:
+        static constexpr int InvalidCell{ -1 };
+
         Grid(Elite::Blackboard* pBlackboard, int cellDimension);
         virtual ~Grid() = default;
 
         void RenderGrid() const;
         void UpdateCurrentAgentCell(AgentInfo* agent);
+        // Stamps what the agent knows into the influence layers and spreads them one step, call once per frame
+        void UpdateInfluenceMap();
 
         // Getters
-        Cell* Grid::GetExpandSquareSearchCell(const AgentInfo* agent);
-        const std::vector<std::unique_ptr<Cell>>& GetGridCells() const;
-        Cell* GetCurrentAgentCell() const;
+        // Unvisited cell to explore next, where the flow field ends or the next cell of the expanding square search.
+        // It can be far away, GetNextPathCell gives the way there.
+        Cell GetExplorationCell(const AgentInfo* agent);
+        Cell GetExpandSquareSearchCell(const AgentInfo* agent);
+        // Neighbor of the agent's cell on the cheapest way to an unvisited cell, the agent's cell when it is unvisited
+        Cell GetFlowFieldCell() const;
+        // Unvisited cell the flow from the agent's cell ends in
+        Cell GetFlowFieldTargetCell() const;
+        Cell GetCell(int cellIndex) const;
+        Cell GetCurrentAgentCell() const;
+        int GetCellCount() const { return m_CellDimensions * m_CellDimensions; }
+        int GetCellDimensions() const { return m_CellDimensions; }
+        float GetCellSize() const { return m_CellSize; }
+        int GetCellIndex(int row, int column) const;
+        int GetCellIndex(const Elite::Vector2& position) const;
+        const Elite::Vector2& GetCellPosition(int cellIndex) const { return m_CellPositions[cellIndex]; }
+        bool IsCellVisited(int cellIndex) const { return m_VisitedMap.IsVisited(cellIndex); }
+        // Positive attracts the agent, negative is danger
+        float GetCellInfluence(int cellIndex) const { return m_InfluenceMap.GetInfluence(cellIndex); }
+        const InfluenceMap& GetInfluenceMap() const { return m_InfluenceMap; }
+        const GridPathfinder& GetPathfinder() const { return m_Pathfinder; }
+        // Writes the up to 8 neighbors of the cell, returns how many there are
+        int GetNeighbors(int cellIndex, int (&neighbors)[8]) const;
+
+        // Exploration queries
+        float GetCoverage() const { return m_VisitedMap.GetCoverage(); }
+        int CountUnvisitedCells(const Elite::Vector2& center, int radiusInCells) const;
+        Cell GetNearestUnvisitedCell(const Elite::Vector2& position) const;
+        Elite::Vector2 GetFlowDirection(int cellIndex) const { return m_FlowField.GetDirection(cellIndex); }
+
+        // Next cell on the cheapest path from the agent's cell to goalCell, goalCell itself once the agent is in it
+        Cell GetNextPathCell(int goalCell);
 
         // Setters
+        // Explore with the flow field (default) or with the expanding square search
+        void SetUseFlowField(bool useFlowField) { m_UseFlowField = useFlowField; }
         void SetCurrentCellVisited();
         void MarkCellVisited(const Elite::Vector2& position);
         void StoreLastVisitedCell();
@@ -43,22 +88,31 @@ namespace ZombieGame
         IExamInterface* m_pInterface{};
         Elite::Blackboard* m_pBlackboard{};
 
-        std::vector<std::unique_ptr<Cell>> m_GridCells{};
-        std::vector<Cell*> m_VisitedCells{};
-        std::vector<Cell*> m_UnVisitedCells{};
+        // Cell data, one entry per cell
+        std::vector<Elite::Vector2> m_CellPositions{};
+        VisitedMap m_VisitedMap{};
+        FlowField m_FlowField{};
+        InfluenceMap m_InfluenceMap{};
+        GridPathfinder m_Pathfinder{};
 
         Elite::Vector2 m_GridStartPosition{};
 
         // Cell variables
-        Cell* m_pCurrentAgentCell{};
+        int m_CurrentAgentCell{ InvalidCell };
         float m_CellSize{};
         float m_HalfCellSize{};
         int m_CellDimensions{};
 
         // Neighbor variables
-        float m_NeighborInfluenceBoost{0.5f};
+        float m_NeighborInfluenceBoost{0.5f}; // Weight of a neighbor in the influence blur
         float m_VisitDistanceThreshold{ 10.f };
 
+        // Influence variables
+        float m_AvoidInfluence{ -0.05f }; // The search skips leg cells below this, they stay unvisited
+
+        // Exploration variables
+        bool m_UseFlowField{ true }; // Follow the flow field instead of the expanding square search
+
         // Expanding Square Search variables
         int m_CurrentSideLength{ 1 }; // Start with a side length of 1
         int m_StepsTaken{ 0 };
@@ -72,29 +126,27 @@ namespace ZombieGame
 
         Direction m_CurrentDirection{ Direction::RIGHT };
 
-        Cell* m_pLastVisitedCell{ nullptr };
-        Cell* m_pLastCellBeforeDeviation{ nullptr };
-        std::queue<Cell*> m_LegQueue; // Queue to store the path for the current leg
+        int m_LastVisitedCell{ InvalidCell };
+        int m_LastCellBeforeDeviation{ InvalidCell };
+        std::queue<int> m_LegQueue; // Queue to store the path for the current leg
 
     private:
 
         // Initialization functions
         void InitializeGrid();
-        void InitializeNeighbors();
 
         // Render functions
         void RenderVisitedCells(const Elite::Vector3& color) const;
         void RenderCurrentCell(const Elite::Vector3& color) const;
-        void RenderCell(const Cell& cell, const Elite::Vector3& color) const;
+        void RenderCell(int cellIndex, const Elite::Vector3& color) const;
 
         // Helper functions
-        void Grid::PositionToGridCoordinates(const Elite::Vector2& position, int& row, int& column) const;
+        void PositionToGridCoordinates(const Elite::Vector2& position, int& row, int& column) const;
         void UpdateCoordinatesForDirection(int& row, int& column);
-        Cell* GetCellAtGridCoordinates(int row, int column);
+        void SetCellVisited(int cellIndex);
         void PlanLeg(); // Method to plan the entire leg
         void ResumeSearchFromLastVisitedCell();
         void UpdateLegQueue();
     };
 
 }
-
@@ -0,0 +1,358 @@
+#include "stdafx.h"
+#include "GridPathfinder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+#include "InfluenceMap.h"
+
+constexpr int ZombieGame::GridPathfinder::NoCell;
+constexpr float ZombieGame::GridPathfinder::DangerCost;
+constexpr float ZombieGame::GridPathfinder::CostTolerance;
+constexpr unsigned int ZombieGame::GridPathfinder::CacheSize;
+
+namespace
+{
+    const float DiagonalStep{ 1.41421356f };
+}
+
+void ZombieGame::GridPathfinder::Initialize(int dimensions)
+{
+    m_Dimensions = dimensions;
+    const int cellCount = dimensions * dimensions;
+
+    m_Costs.assign(cellCount, 1.f);
+    m_CostVersions.assign(cellCount, 0);
+    m_CostVersion = 0;
+
+    m_Distances.assign(cellCount, 0.f);
+    m_Estimates.assign(cellCount, 0.f);
+    m_Parents.assign(cellCount, NoCell);
+    m_HeapPositions.assign(cellCount, -1);
+    m_SeenSearches.assign(cellCount, 0);
+    m_ClosedSearches.assign(cellCount, 0);
+    m_Heap.clear();
+    m_Heap.reserve(cellCount);
+    m_Search = 0;
+
+    // Room for a straight path across the grid, a detour around danger grows it once
+    for (CacheEntry& entry : m_Cache)
+    {
+        entry.Path.reserve(dimensions * 2);
+    }
+    Invalidate();
+}
+
+void ZombieGame::GridPathfinder::UpdateCosts(const InfluenceMap& influenceMap)
+{
+    const unsigned int version = m_CostVersion + 1;
+    bool hasChanged = false;
+
+    const std::vector<float>& influences = influenceMap.GetInfluences();
+    for (size_t cellIndex = 0; cellIndex < m_Costs.size(); ++cellIndex)
+    {
+        const float cost = 1.f + DangerCost * std::max(-influences[cellIndex], 0.f);
+        if (std::abs(cost - m_Costs[cellIndex]) > CostTolerance)
+        {
+            m_Costs[cellIndex] = cost;
+            m_CostVersions[cellIndex] = version;
+            hasChanged = true;
+        }
+    }
+
+    if (hasChanged)
+        m_CostVersion = version;
+}
+
+void ZombieGame::GridPathfinder::SetCellCost(int cellIndex, float cost)
+{
+    m_Costs[cellIndex] = std::max(cost, 1.f);
+    m_CostVersions[cellIndex] = ++m_CostVersion;
+}
+
+const std::vector<int>& ZombieGame::GridPathfinder::FindPath(int startCell, int goalCell)
+{
+    const int cellCount = static_cast<int>(m_Costs.size());
+    if (startCell < 0 || startCell >= cellCount || goalCell < 0 || goalCell >= cellCount)
+        return m_NoPath;
+
+    ++m_UseCount;
+
+    // Look for the path, remember the least recently used entry in case it has to be searched
+    CacheEntry* pLeastRecent = &m_Cache[0];
+    for (CacheEntry& entry : m_Cache)
+    {
+        if (entry.StartCell == startCell && entry.GoalCell == goalCell)
+        {
+            if (IsCurrent(entry))
+            {
+                ++m_Stats.CacheHits;
+                entry.LastUsed = m_UseCount;
+                return entry.Path;
+            }
+
+            ++m_Stats.Invalidations;
+            pLeastRecent = &entry;
+            break;
+        }
+
+        if (entry.LastUsed < pLeastRecent->LastUsed)
+            pLeastRecent = &entry;
+    }
+
+    CacheEntry& entry = *pLeastRecent;
+    entry.StartCell = startCell;
+    entry.GoalCell = goalCell;
+    entry.CostVersion = m_CostVersion;
+    entry.LastUsed = m_UseCount;
+    Search(startCell, goalCell, entry.Path);
+    return entry.Path;
+}
+
+void ZombieGame::GridPathfinder::Invalidate()
+{
+    for (CacheEntry& entry : m_Cache)
+    {
+        entry.StartCell = NoCell;
+        entry.GoalCell = NoCell;
+        entry.LastUsed = 0;
+        entry.Path.clear();
+    }
+}
+
+void ZombieGame::GridPathfinder::PrintReport() const
+{
+    const uint64_t requestCount = m_Stats.Searches + m_Stats.CacheHits;
+    printf("Grid pathfinder: %llu paths, %llu from the cache (%.1f%%), %llu searched again after a cost change, %.1f cells expanded per search\n",
+        static_cast<unsigned long long>(requestCount),
+        static_cast<unsigned long long>(m_Stats.CacheHits),
+        requestCount > 0 ? 100.0 * static_cast<double>(m_Stats.CacheHits) / static_cast<double>(requestCount) : 0.0,
+        static_cast<unsigned long long>(m_Stats.Invalidations),
+        m_Stats.Searches > 0 ? static_cast<double>(m_Stats.ExpandedCells) / static_cast<double>(m_Stats.Searches) : 0.0);
+}
+
+void ZombieGame::GridPathfinder::Benchmark(int dimensions, int pathCount)
+{
+    // A few danger spots, spread out the way they are in game
+    InfluenceMap influenceMap{};
+    influenceMap.Initialize(dimensions, 0.5f);
+    influenceMap.SetLayerSettings(InfluenceLayer::EnemyDanger, -1.f, 0.9f);
+
+    std::mt19937 random{ 1234 };
+    std::uniform_int_distribution<int> cellDistribution{ 0, dimensions * dimensions - 1 };
+    std::vector<int> dangerCells(std::max(dimensions / 4, 1));
+    for (int& cellIndex : dangerCells)
+    {
+        cellIndex = cellDistribution(random);
+    }
+
+    for (int update = 0; update < 30; ++update)
+    {
+        influenceMap.ClearSources();
+        for (int cellIndex : dangerCells)
+        {
+            influenceMap.AddSource(InfluenceLayer::EnemyDanger, cellIndex / dimensions, cellIndex % dimensions, 1.f, 2);
+        }
+        influenceMap.Update();
+    }
+
+    GridPathfinder pathfinder{};
+    pathfinder.Initialize(dimensions);
+    pathfinder.UpdateCosts(influenceMap);
+
+    std::vector<std::pair<int, int>> requests(pathCount);
+    for (auto& request : requests)
+    {
+        request = { cellDistribution(random), cellDistribution(random) };
+    }
+
+    // Every request is new, every one is searched
+    size_t pathLength = 0;
+    auto startTime = std::chrono::high_resolution_clock::now();
+    for (const auto& request : requests)
+    {
+        pathLength += pathfinder.FindPath(request.first, request.second).size();
+    }
+    const double searchSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+    // The same request every time, after the first one it comes from the cache
+    startTime = std::chrono::high_resolution_clock::now();
+    for (int request = 0; request < pathCount; ++request)
+    {
+        pathLength += pathfinder.FindPath(requests[0].first, requests[0].second).size();
+    }
+    const double cachedSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+    printf("Grid pathfinder benchmark %dx%d: %.0f searches per second, %.0f cached paths per second (%.1f cells per path)\n",
+        dimensions, dimensions,
+        searchSeconds > 0.0 ? pathCount / searchSeconds : 0.0,
+        cachedSeconds > 0.0 ? pathCount / cachedSeconds : 0.0,
+        static_cast<double>(pathLength) / (2.0 * pathCount));
+    pathfinder.PrintReport();
+}
+
+bool ZombieGame::GridPathfinder::IsCurrent(const CacheEntry& entry) const
+{
+    for (int cellIndex : entry.Path)
+    {
+        if (m_CostVersions[cellIndex] > entry.CostVersion)
+            return false;
+    }
+    return true;
+}
+
+void ZombieGame::GridPathfinder::Search(int startCell, int goalCell, std::vector<int>& path)
+{
+    ++m_Stats.Searches;
+    path.clear();
+
+    // Stamps of an earlier search would look current once the counter wraps around
+    if (++m_Search == 0)
+    {
+        std::fill(m_SeenSearches.begin(), m_SeenSearches.end(), 0);
+        std::fill(m_ClosedSearches.begin(), m_ClosedSearches.end(), 0);
+        m_Search = 1;
+    }
+
+    m_Heap.clear();
+    m_SeenSearches[startCell] = m_Search;
+    m_Distances[startCell] = 0.f;
+    m_Estimates[startCell] = GetHeuristic(startCell, goalCell);
+    m_Parents[startCell] = NoCell;
+    Push(startCell);
+
+    while (!m_Heap.empty())
+    {
+        const int cellIndex = Pop();
+        if (cellIndex == goalCell)
+        {
+            for (int pathCell = goalCell; pathCell != NoCell; pathCell = m_Parents[pathCell])
+            {
+                path.push_back(pathCell);
+            }
+            std::reverse(path.begin(), path.end());
+            return;
+        }
+
+        m_ClosedSearches[cellIndex] = m_Search;
+        ++m_Stats.ExpandedCells;
+
+        const int row = cellIndex / m_Dimensions;
+        const int column = cellIndex % m_Dimensions;
+        for (int rowOffset = -1; rowOffset <= 1; ++rowOffset)
+        {
+            const int neighborRow = row + rowOffset;
+            if (neighborRow < 0 || neighborRow >= m_Dimensions)
+                continue;
+
+            for (int columnOffset = -1; columnOffset <= 1; ++columnOffset)
+            {
+                const int neighborColumn = column + columnOffset;
+                if ((rowOffset == 0 && columnOffset == 0) || neighborColumn < 0 || neighborColumn >= m_Dimensions)
+                    continue;
+
+                const int neighbor = neighborRow * m_Dimensions + neighborColumn;
+                if (m_ClosedSearches[neighbor] == m_Search)
+                    continue;
+
+                const float step = (rowOffset != 0 && columnOffset != 0) ? DiagonalStep : 1.f;
+                const float distance = m_Distances[cellIndex] + step * m_Costs[neighbor];
+
+                if (m_SeenSearches[neighbor] != m_Search)
+                {
+                    m_SeenSearches[neighbor] = m_Search;
+                    m_Distances[neighbor] = distance;
+                    m_Estimates[neighbor] = distance + GetHeuristic(neighbor, goalCell);
+                    m_Parents[neighbor] = cellIndex;
+                    Push(neighbor);
+                }
+                else if (distance < m_Distances[neighbor])
+                {
+                    // Still open, the heuristic part of the estimate stays the same
+                    m_Estimates[neighbor] += distance - m_Distances[neighbor];
+                    m_Distances[neighbor] = distance;
+                    m_Parents[neighbor] = cellIndex;
+                    SiftUp(m_HeapPositions[neighbor]);
+                }
+            }
+        }
+    }
+}
+
+float ZombieGame::GridPathfinder::GetHeuristic(int cellIndex, int goalCell) const
+{
+    // Octile distance, exact on a grid where every cell costs 1
+    const int rowDistance = std::abs(cellIndex / m_Dimensions - goalCell / m_Dimensions);
+    const int columnDistance = std::abs(cellIndex % m_Dimensions - goalCell % m_Dimensions);
+    const int diagonalSteps = std::min(rowDistance, columnDistance);
+    return static_cast<float>(rowDistance + columnDistance - 2 * diagonalSteps) + DiagonalStep * diagonalSteps;
+}
+
+void ZombieGame::GridPathfinder::Push(int cellIndex)
+{
+    m_HeapPositions[cellIndex] = static_cast<int>(m_Heap.size());
+    m_Heap.push_back(cellIndex);
+    SiftUp(m_HeapPositions[cellIndex]);
+}
+
+int ZombieGame::GridPathfinder::Pop()
+{
+    const int cellIndex = m_Heap.front();
+    Swap(0, static_cast<int>(m_Heap.size()) - 1);
+    m_Heap.pop_back();
+    if (!m_Heap.empty())
+        SiftDown(0);
+    return cellIndex;
+}
+
+void ZombieGame::GridPathfinder::SiftUp(int heapPosition)
+{
+    while (heapPosition > 0)
+    {
+        const int parentPosition = (heapPosition - 1) / 2;
+        if (!IsBefore(m_Heap[heapPosition], m_Heap[parentPosition]))
+            return;
+
+        Swap(heapPosition, parentPosition);
+        heapPosition = parentPosition;
+    }
+}
+
+void ZombieGame::GridPathfinder::SiftDown(int heapPosition)
+{
+    const int heapSize = static_cast<int>(m_Heap.size());
+    while (true)
+    {
+        const int leftPosition = heapPosition * 2 + 1;
+        const int rightPosition = leftPosition + 1;
+        int smallestPosition = heapPosition;
+
+        if (leftPosition < heapSize && IsBefore(m_Heap[leftPosition], m_Heap[smallestPosition]))
+            smallestPosition = leftPosition;
+        if (rightPosition < heapSize && IsBefore(m_Heap[rightPosition], m_Heap[smallestPosition]))
+            smallestPosition = rightPosition;
+
+        if (smallestPosition == heapPosition)
+            return;
+
+        Swap(heapPosition, smallestPosition);
+        heapPosition = smallestPosition;
+    }
+}
+
+bool ZombieGame::GridPathfinder::IsBefore(int firstCell, int secondCell) const
+{
+    // On equal estimates the cell closer to the goal goes first, open grids have long runs of ties
+    if (m_Estimates[firstCell] != m_Estimates[secondCell])
+        return m_Estimates[firstCell] < m_Estimates[secondCell];
+    return m_Distances[firstCell] > m_Distances[secondCell];
+}
+
+void ZombieGame::GridPathfinder::Swap(int firstPosition, int secondPosition)
+{
+    std::swap(m_Heap[firstPosition], m_Heap[secondPosition]);
+    m_HeapPositions[m_Heap[firstPosition]] = firstPosition;
+    m_HeapPositions[m_Heap[secondPosition]] = secondPosition;
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace ZombieGame
+{
+	class InfluenceMap;
+
+	struct GridPathfinderStats
+	{
+		uint64_t Searches = 0;
+		uint64_t CacheHits = 0;
+		uint64_t Invalidations = 0; // Cached paths searched again because a cell on them got another cost
+		uint64_t ExpandedCells = 0;
+	};
+
+	// A* over the cells of a square grid, 8-connected with the octile distance as heuristic.
+	// Entering a cell costs the step length times the cost of the cell, which is 1 plus DangerCost for every unit of
+	// negative influence, so paths bend around danger. Costs never go below 1, which keeps the heuristic admissible.
+	//
+	// The open list is a binary heap with decrease-key and all search state lives in arrays of one entry per cell,
+	// stamped with the search that wrote it, so a search neither clears nor allocates.
+	// The last CacheSize paths are kept, a path is searched again once a cell on it got another cost.
+	class GridPathfinder final
+	{
+	public:
+		static constexpr int NoCell{ -1 };
+		static constexpr float DangerCost{ 20.f };
+		static constexpr float CostTolerance{ 0.05f }; // Smaller cost changes are ignored, they would drop every path each frame
+		static constexpr unsigned int CacheSize{ 16 };
+
+		GridPathfinder() = default;
+		~GridPathfinder() = default;
+
+		GridPathfinder(const GridPathfinder& other) = delete;
+		GridPathfinder& operator=(const GridPathfinder& other) = delete;
+		GridPathfinder(GridPathfinder&& other) = delete;
+		GridPathfinder& operator=(GridPathfinder&& other) = delete;
+
+		// Every cell starts with cost 1
+		void Initialize(int dimensions);
+		// Call after every influence update
+		void UpdateCosts(const InfluenceMap& influenceMap);
+		void SetCellCost(int cellIndex, float cost);
+		float GetCellCost(int cellIndex) const { return m_Costs[cellIndex]; }
+		const std::vector<float>& GetCellCosts() const { return m_Costs; }
+
+		// Cells from startCell to goalCell, both included. Empty when there is no path.
+		// The reference stays valid until the next FindPath.
+		const std::vector<int>& FindPath(int startCell, int goalCell);
+		// Drops every cached path
+		void Invalidate();
+
+		const GridPathfinderStats& GetStats() const { return m_Stats; }
+		void PrintReport() const;
+		// Times dimensions x dimensions searches between random cells around a few danger spots, with and without the cache
+		static void Benchmark(int dimensions, int pathCount);
+
+	private:
+		struct CacheEntry
+		{
+			int StartCell = NoCell;
+			int GoalCell = NoCell;
+			unsigned int CostVersion = 0;
+			uint64_t LastUsed = 0;
+			std::vector<int> Path{};
+		};
+
+		int m_Dimensions{ 0 };
+		std::vector<float> m_Costs{};
+		std::vector<unsigned int> m_CostVersions{}; // m_CostVersion of the update that last changed the cell
+		unsigned int m_CostVersion{ 0 };
+
+		// Search state, one entry per cell
+		std::vector<float> m_Distances{}; // From the start
+		std::vector<float> m_Estimates{}; // Distance plus heuristic
+		std::vector<int> m_Parents{};
+		std::vector<int> m_HeapPositions{};
+		std::vector<unsigned int> m_SeenSearches{};
+		std::vector<unsigned int> m_ClosedSearches{};
+		std::vector<int> m_Heap{};
+		unsigned int m_Search{ 0 };
+
+		std::array<CacheEntry, CacheSize> m_Cache{};
+		uint64_t m_UseCount{ 0 };
+		const std::vector<int> m_NoPath{};
+		GridPathfinderStats m_Stats{};
+
+		bool IsCurrent(const CacheEntry& entry) const;
+		void Search(int startCell, int goalCell, std::vector<int>& path);
+		float GetHeuristic(int cellIndex, int goalCell) const;
+
+		// Heap of cells ordered on m_Estimates, then on the largest m_Distances
+		void Push(int cellIndex);
+		int Pop();
+		void SiftUp(int heapPosition);
+		void SiftDown(int heapPosition);
+		bool IsBefore(int firstCell, int secondCell) const;
+		void Swap(int firstPosition, int secondPosition);
+	};
+}
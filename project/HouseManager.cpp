@@ -1,6 +1,7 @@
 #include "stdafx.h"
 #include "HouseManager.h"
 #include "EliteData/EBlackboard.h"
+#include "EliteLogging/ELogger.h"
 
 using namespace ZombieGame;
 
@@ -16,6 +17,11 @@ HouseManager::HouseManager(Elite::Blackboard* pBlackboard)
     if (!success || !m_pInterface)
         throw std::runtime_error("Interface isn't stored correctly in the HouseManager constructor.");
 
+    // get the perception of this frame from the blackboard
+    success = m_pBlackboard->GetData("Perception", m_pPerception);
+    if (!success || !m_pPerception)
+        throw std::runtime_error("Perception isn't stored correctly in the HouseManager constructor.");
+
     // Reserve space for storing houses, Exam slides said it was max 20 houses
     m_StoredHouses.reserve(20);
 }
@@ -23,26 +29,17 @@ HouseManager::HouseManager(Elite::Blackboard* pBlackboard)
 
 void ZombieGame::HouseManager::Update(float dt)
 {
-    // only update when in field of view
-    if (m_pInterface->FOV_GetStats().NumHouses > 0)
-    {
-        UpdateHousesInView();
-    }
+    UpdateHousesInView();
     ResetVisitedHouses(dt);
 }
 
 void ZombieGame::HouseManager::UpdateHousesInView()
 {
-    // Only update when in field of view
-    if (m_pInterface->FOV_GetStats().NumHouses > 0)
+    for (const auto& house : m_pPerception->GetHouses())
     {
-        auto vHousesInFOV = m_pInterface->GetHousesInFOV();
-        for (auto& house : vHousesInFOV)
+        if (!IsHouseStored(house))
         {
-            if (!IsHouseStored(house))
-            {
-                StoreNewHouse(house);
-            }
+            StoreNewHouse(house);
         }
     }
 }
@@ -55,7 +52,7 @@ bool HouseManager::IsHouseStored(const HouseInfo& house) const
 
 void HouseManager::StoreNewHouse(const HouseInfo& houseInfo)
 {
-    std::cout << "New house stored!\n";
+    ELITE_LOG_INFO("New house stored!");
 
     std::unique_ptr<House> pHouse = CreateHouse(houseInfo);
     CalculateCheckPoints(pHouse);
@@ -114,7 +111,7 @@ void HouseManager::AddCheckPointToHouse(std::unique_ptr<House>& pHouse, const El
     pCheckPoint->Position.y = startPosition.y + y * searchRange;
     pHouse->pCheckPoints.emplace_back(pCheckPoint);
 
-    std::cout << "New Check point\n";
+    ELITE_LOG_DEBUG("New Check point");
 }
 
 void HouseManager::ResetVisitedHouses(float dt)
@@ -151,8 +148,7 @@ void HouseManager::Render() const
 
 bool ZombieGame::HouseManager::CanVisitHouseInFOV()
 {
-    const auto& vHousesInFOV = m_pInterface->GetHousesInFOV();
-    for (const auto& fovHouse : vHousesInFOV)
+    for (const auto& fovHouse : m_pPerception->GetHouses())
     {
         for (const auto& storedHouse : m_StoredHouses)
         {
@@ -1,6 +1,7 @@
 #pragma once
 #include "EliteBehaviorTree/EDecisionMaking.h"
 #include "IExamInterface.h"
+#include "PerceptionFrame.h"
 
 namespace ZombieGame
 {
@@ -29,6 +30,7 @@ namespace ZombieGame
 
 	private:
 		IExamInterface* m_pInterface;
+		const PerceptionFrame* m_pPerception{};
 		Elite::Blackboard* m_pBlackboard;
 		std::vector<std::unique_ptr<House>> m_StoredHouses{};
 
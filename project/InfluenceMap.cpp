@@ -0,0 +1,331 @@
+#include "stdafx.h"
+#include "InfluenceMap.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "EliteThreading/EJobSystem.h"
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__)
+#define ZOMBIEGAME_INFLUENCE_SSE 1
+#include <xmmintrin.h>
+#else
+#define ZOMBIEGAME_INFLUENCE_SSE 0
+#endif
+
+constexpr int ZombieGame::InfluenceMap::LayerCount;
+constexpr float ZombieGame::InfluenceMap::SilentInfluence;
+
+void ZombieGame::InfluenceMap::Initialize(int dimensions, float neighborWeight)
+{
+    m_Dimensions = dimensions;
+    const int cellCount = dimensions * dimensions;
+
+    // Normalized [neighbor, 1, neighbor] kernel, a blur keeps the total influence
+    m_CenterWeight = 1.f / (1.f + 2.f * neighborWeight);
+    m_NeighborWeight = neighborWeight * m_CenterWeight;
+
+    for (Layer& layer : m_Layers)
+    {
+        layer.Sources.assign(cellCount, 0.f);
+        layer.Current.assign(cellCount, 0.f);
+        layer.Next.assign(cellCount, 0.f);
+        layer.Blurred.assign(cellCount, 0.f);
+        layer.HasSources = false;
+        layer.IsActive = false;
+        layer.SilentFrames = 0;
+    }
+    m_Influences.assign(cellCount, 0.f);
+
+    SetJobSystem(m_pJobSystem);
+}
+
+void ZombieGame::InfluenceMap::SetLayerSettings(InfluenceLayer layer, float weight, float decay)
+{
+    Layer& settings = m_Layers[static_cast<int>(layer)];
+    settings.Weight = weight;
+    settings.Decay = std::min(std::max(decay, 0.f), 0.999f);
+}
+
+void ZombieGame::InfluenceMap::SetJobSystem(Elite::JobSystem* pJobSystem)
+{
+    m_pJobSystem = pJobSystem;
+
+    // One band per worker and one for the calling thread, no band smaller than MinBandRows
+    const int MinBandRows{ 16 };
+    const int threadCount = m_pJobSystem ? static_cast<int>(m_pJobSystem->GetWorkerCount()) + 1 : 1;
+    const int bandCount = std::max(1, std::min(threadCount, m_Dimensions / MinBandRows));
+
+    m_Bands.resize(bandCount);
+    for (int bandIndex = 0; bandIndex < bandCount; ++bandIndex)
+    {
+        m_Bands[bandIndex].pMap = this;
+        m_Bands[bandIndex].FirstRow = m_Dimensions * bandIndex / bandCount;
+        m_Bands[bandIndex].EndRow = m_Dimensions * (bandIndex + 1) / bandCount;
+    }
+}
+
+void ZombieGame::InfluenceMap::ClearSources()
+{
+    for (Layer& layer : m_Layers)
+    {
+        if (layer.HasSources)
+        {
+            std::fill(layer.Sources.begin(), layer.Sources.end(), 0.f);
+            layer.HasSources = false;
+        }
+    }
+}
+
+void ZombieGame::InfluenceMap::AddSource(InfluenceLayer layer, int cellIndex, float strength)
+{
+    if (cellIndex < 0 || cellIndex >= static_cast<int>(m_Influences.size()))
+        return;
+
+    Layer& target = m_Layers[static_cast<int>(layer)];
+    target.Sources[cellIndex] += strength;
+    target.HasSources = true;
+}
+
+void ZombieGame::InfluenceMap::AddSource(InfluenceLayer layer, int row, int column, float strength, int radiusInCells)
+{
+    // Every cell within the radius gets the full strength
+    const int squaredRadius = radiusInCells * radiusInCells;
+    const int firstRow = std::max(row - radiusInCells, 0);
+    const int lastRow = std::min(row + radiusInCells, m_Dimensions - 1);
+    const int firstColumn = std::max(column - radiusInCells, 0);
+    const int lastColumn = std::min(column + radiusInCells, m_Dimensions - 1);
+
+    for (int currentRow = firstRow; currentRow <= lastRow; ++currentRow)
+    {
+        for (int currentColumn = firstColumn; currentColumn <= lastColumn; ++currentColumn)
+        {
+            const int rowOffset = currentRow - row;
+            const int columnOffset = currentColumn - column;
+            if (rowOffset * rowOffset + columnOffset * columnOffset <= squaredRadius)
+            {
+                AddSource(layer, currentRow * m_Dimensions + currentColumn, strength);
+            }
+        }
+    }
+}
+
+void ZombieGame::InfluenceMap::Update()
+{
+    const auto startTime = std::chrono::high_resolution_clock::now();
+
+    // A layer without sources is skipped once what is left of it is too small to matter
+    for (Layer& layer : m_Layers)
+    {
+        if (layer.HasSources)
+        {
+            layer.IsActive = true;
+            layer.SilentFrames = 0;
+        }
+        else if (layer.IsActive && ++layer.SilentFrames > GetSilentFrameLimit(layer.Decay))
+        {
+            layer.IsActive = false;
+            std::fill(layer.Current.begin(), layer.Current.end(), 0.f);
+        }
+    }
+
+    // The vertical pass reads the rows next to its band, so all horizontal rows have to be done first
+    RunBands(&BlurRowsHorizontal);
+    RunBands(&BlurRowsVertical);
+
+    for (Layer& layer : m_Layers)
+    {
+        if (layer.IsActive)
+        {
+            layer.Current.swap(layer.Next);
+        }
+    }
+
+    const auto endTime = std::chrono::high_resolution_clock::now();
+    m_LastUpdateMilliseconds = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+    m_TotalUpdateMilliseconds += m_LastUpdateMilliseconds;
+    m_MaxUpdateMilliseconds = std::max(m_MaxUpdateMilliseconds, m_LastUpdateMilliseconds);
+    ++m_UpdateCount;
+}
+
+void ZombieGame::InfluenceMap::PrintReport() const
+{
+    printf("Influence map: %dx%d cells, %u updates, %.4f ms average, %.4f ms worst, %d bands\n",
+        m_Dimensions, m_Dimensions, m_UpdateCount,
+        m_UpdateCount > 0 ? m_TotalUpdateMilliseconds / m_UpdateCount : 0.0,
+        m_MaxUpdateMilliseconds, static_cast<int>(m_Bands.size()));
+}
+
+void ZombieGame::InfluenceMap::Benchmark(int dimensions, int updateCount)
+{
+    Elite::JobSystem jobSystem{};
+    for (int run = 0; run < 2; ++run)
+    {
+        InfluenceMap map{};
+        map.Initialize(dimensions, 0.5f);
+        map.SetJobSystem(run == 0 ? nullptr : &jobSystem);
+        for (int layerIndex = 0; layerIndex < LayerCount; ++layerIndex)
+        {
+            map.SetLayerSettings(static_cast<InfluenceLayer>(layerIndex), 1.f, 0.9f);
+        }
+
+        for (int update = 0; update < updateCount; ++update)
+        {
+            // Moving sources, so no layer goes quiet
+            map.ClearSources();
+            for (int layerIndex = 0; layerIndex < LayerCount; ++layerIndex)
+            {
+                const int row = (update + layerIndex * dimensions / LayerCount) % dimensions;
+                map.AddSource(static_cast<InfluenceLayer>(layerIndex), row, row, 1.f, 2);
+            }
+            map.Update();
+        }
+
+        printf("%s: ", run == 0 ? "One thread" : "Row bands");
+        map.PrintReport();
+    }
+}
+
+void ZombieGame::InfluenceMap::RunBands(void(*fpBand)(void* pData))
+{
+    if (!m_pJobSystem || m_Bands.size() == 1)
+    {
+        for (Band& band : m_Bands)
+        {
+            fpBand(&band);
+        }
+        return;
+    }
+
+    // The calling thread takes the first band itself
+    Elite::JobCounter counter{};
+    for (size_t bandIndex = 1; bandIndex < m_Bands.size(); ++bandIndex)
+    {
+        m_pJobSystem->Run(fpBand, &m_Bands[bandIndex], counter);
+    }
+    fpBand(&m_Bands[0]);
+    m_pJobSystem->Wait(counter);
+}
+
+void ZombieGame::InfluenceMap::BlurRowsHorizontal(void* pData)
+{
+    const Band& band = *static_cast<const Band*>(pData);
+    InfluenceMap& map = *band.pMap;
+    const int dimensions = map.m_Dimensions;
+
+    // Every band only writes its own rows
+    for (Layer& layer : map.m_Layers)
+    {
+        if (!layer.IsActive)
+            continue;
+
+        for (int row = band.FirstRow; row < band.EndRow; ++row)
+        {
+            map.BlurRowHorizontal(layer.Current.data() + row * dimensions, layer.Blurred.data() + row * dimensions);
+        }
+    }
+}
+
+void ZombieGame::InfluenceMap::BlurRowsVertical(void* pData)
+{
+    const Band& band = *static_cast<const Band*>(pData);
+    InfluenceMap& map = *band.pMap;
+    const int dimensions = map.m_Dimensions;
+
+    for (int row = band.FirstRow; row < band.EndRow; ++row)
+    {
+        // The edge rows use themselves as the missing neighbor
+        const int upRow = std::max(row - 1, 0) * dimensions;
+        const int centerRow = row * dimensions;
+        const int downRow = std::min(row + 1, dimensions - 1) * dimensions;
+
+        float* pInfluences = map.m_Influences.data() + centerRow;
+        std::fill(pInfluences, pInfluences + dimensions, 0.f);
+
+        for (Layer& layer : map.m_Layers)
+        {
+            if (!layer.IsActive)
+                continue;
+
+            const float* pBlurred = layer.Blurred.data();
+            map.BlurRowVertical(pBlurred + upRow, pBlurred + centerRow, pBlurred + downRow, layer.Sources.data() + centerRow,
+                layer.Decay, layer.Weight, layer.Next.data() + centerRow, pInfluences);
+        }
+    }
+}
+
+void ZombieGame::InfluenceMap::BlurRowHorizontal(const float* pIn, float* pOut) const
+{
+    const int count = m_Dimensions;
+    if (count == 1)
+    {
+        pOut[0] = pIn[0];
+        return;
+    }
+
+    const float center = m_CenterWeight;
+    const float neighbor = m_NeighborWeight;
+
+    pOut[0] = center * pIn[0] + neighbor * (pIn[0] + pIn[1]);
+
+    int column = 1;
+#if ZOMBIEGAME_INFLUENCE_SSE
+    const __m128 centerWeights = _mm_set1_ps(center);
+    const __m128 neighborWeights = _mm_set1_ps(neighbor);
+    for (; column + 4 <= count - 1; column += 4)
+    {
+        const __m128 left = _mm_loadu_ps(pIn + column - 1);
+        const __m128 middle = _mm_loadu_ps(pIn + column);
+        const __m128 right = _mm_loadu_ps(pIn + column + 1);
+        const __m128 result = _mm_add_ps(_mm_mul_ps(centerWeights, middle), _mm_mul_ps(neighborWeights, _mm_add_ps(left, right)));
+        _mm_storeu_ps(pOut + column, result);
+    }
+#endif
+    for (; column < count - 1; ++column)
+    {
+        pOut[column] = center * pIn[column] + neighbor * (pIn[column - 1] + pIn[column + 1]);
+    }
+
+    pOut[count - 1] = center * pIn[count - 1] + neighbor * (pIn[count - 2] + pIn[count - 1]);
+}
+
+void ZombieGame::InfluenceMap::BlurRowVertical(const float* pUp, const float* pCenter, const float* pDown, const float* pSources,
+    float decay, float weight, float* pOut, float* pInfluences) const
+{
+    const int count = m_Dimensions;
+    const float center = m_CenterWeight * decay;
+    const float neighbor = m_NeighborWeight * decay;
+    const float source = 1.f - decay;
+
+    int column = 0;
+#if ZOMBIEGAME_INFLUENCE_SSE
+    const __m128 centerWeights = _mm_set1_ps(center);
+    const __m128 neighborWeights = _mm_set1_ps(neighbor);
+    const __m128 sourceWeights = _mm_set1_ps(source);
+    const __m128 layerWeights = _mm_set1_ps(weight);
+    for (; column + 4 <= count; column += 4)
+    {
+        const __m128 blurred = _mm_add_ps(_mm_mul_ps(centerWeights, _mm_loadu_ps(pCenter + column)),
+            _mm_mul_ps(neighborWeights, _mm_add_ps(_mm_loadu_ps(pUp + column), _mm_loadu_ps(pDown + column))));
+        const __m128 result = _mm_add_ps(blurred, _mm_mul_ps(sourceWeights, _mm_loadu_ps(pSources + column)));
+        _mm_storeu_ps(pOut + column, result);
+        _mm_storeu_ps(pInfluences + column, _mm_add_ps(_mm_loadu_ps(pInfluences + column), _mm_mul_ps(layerWeights, result)));
+    }
+#endif
+    for (; column < count; ++column)
+    {
+        const float result = center * pCenter[column] + neighbor * (pUp[column] + pDown[column]) + source * pSources[column];
+        pOut[column] = result;
+        pInfluences[column] += weight * result;
+    }
+}
+
+int ZombieGame::InfluenceMap::GetSilentFrameLimit(float decay) const
+{
+    // Frames until a value of 1 decayed below SilentInfluence
+    if (decay <= 0.f)
+        return 1;
+
+    return static_cast<int>(std::ceil(std::log(SilentInfluence) / std::log(decay)));
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include <vector>
+
+namespace Elite
+{
+	class JobSystem;
+}
+
+namespace ZombieGame
+{
+	enum class InfluenceLayer
+	{
+		EnemyDanger,
+		ItemAttraction,
+		HouseAttraction,
+		PurgeZoneRepulsion,
+		Count
+	};
+
+	// Influence of the world on a square grid, one layer per kind of source.
+	// Every Update spreads each layer one step with a separable 3x3 blur, lets it decay towards its sources
+	// (value = decay * blur(value) + (1 - decay) * source) and sums the weighted layers into one influence per cell.
+	// A layer keeps fading out for a while after its sources are gone, so the agent remembers where danger was.
+	//
+	// The layers are double buffered and the rows are processed four cells at a time with SSE when it is available.
+	// With a JobSystem the rows are split in bands that run on its workers.
+	class InfluenceMap final
+	{
+	public:
+		InfluenceMap() = default;
+		~InfluenceMap() = default;
+
+		InfluenceMap(const InfluenceMap& other) = delete;
+		InfluenceMap& operator=(const InfluenceMap& other) = delete;
+		InfluenceMap(InfluenceMap&& other) = delete;
+		InfluenceMap& operator=(InfluenceMap&& other) = delete;
+
+		// neighborWeight is the weight of a neighbor relative to the cell itself in the blur
+		void Initialize(int dimensions, float neighborWeight);
+		void SetLayerSettings(InfluenceLayer layer, float weight, float decay);
+		void SetJobSystem(Elite::JobSystem* pJobSystem);
+
+		// Sources are set again every frame, between ClearSources and Update
+		void ClearSources();
+		void AddSource(InfluenceLayer layer, int cellIndex, float strength);
+		void AddSource(InfluenceLayer layer, int row, int column, float strength, int radiusInCells);
+
+		void Update();
+
+		// Getters
+		float GetInfluence(int cellIndex) const { return m_Influences[cellIndex]; }
+		float GetLayerInfluence(InfluenceLayer layer, int cellIndex) const { return m_Layers[static_cast<int>(layer)].Current[cellIndex]; }
+		const std::vector<float>& GetInfluences() const { return m_Influences; }
+		double GetLastUpdateMilliseconds() const { return m_LastUpdateMilliseconds; }
+
+		void PrintReport() const;
+		// Times Update on a dimensions x dimensions map with a source in every layer, on one thread and in row bands
+		static void Benchmark(int dimensions, int updateCount);
+
+	private:
+		static constexpr int LayerCount{ static_cast<int>(InfluenceLayer::Count) };
+		static constexpr float SilentInfluence{ 1e-4f }; // A layer without sources is cleared once it decayed below this
+
+		struct Layer
+		{
+			std::vector<float> Sources{};
+			std::vector<float> Current{};
+			std::vector<float> Next{};
+			std::vector<float> Blurred{}; // Horizontal pass
+			float Weight{ 0.f };
+			float Decay{ 0.9f };
+			bool HasSources{ false };
+			bool IsActive{ false };
+			int SilentFrames{ 0 };
+		};
+
+		// Rows [FirstRow, EndRow) of one job
+		struct Band
+		{
+			InfluenceMap* pMap;
+			int FirstRow;
+			int EndRow;
+		};
+
+		int m_Dimensions{ 0 };
+		float m_CenterWeight{ 1.f };
+		float m_NeighborWeight{ 0.f };
+		Layer m_Layers[LayerCount]{};
+		std::vector<float> m_Influences{};
+
+		Elite::JobSystem* m_pJobSystem{ nullptr };
+		std::vector<Band> m_Bands{};
+		double m_LastUpdateMilliseconds{ 0.0 };
+		double m_TotalUpdateMilliseconds{ 0.0 };
+		double m_MaxUpdateMilliseconds{ 0.0 };
+		unsigned int m_UpdateCount{ 0 };
+
+		void RunBands(void(*fpBand)(void* pData));
+		static void BlurRowsHorizontal(void* pData);
+		static void BlurRowsVertical(void* pData);
+		void BlurRowHorizontal(const float* pIn, float* pOut) const;
+		void BlurRowVertical(const float* pUp, const float* pCenter, const float* pDown, const float* pSources, float decay, float weight, float* pOut, float* pInfluences) const;
+		int GetSilentFrameLimit(float decay) const;
+	};
+}
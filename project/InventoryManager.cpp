@@ -2,6 +2,7 @@
 #include "InventoryManager.h"
 
 #include "HouseManager.h"
+#include "EliteLogging/ELogger.h"
 
 ZombieGame::InventoryManager::InventoryManager(Elite::Blackboard* pBlackboard)
 {
@@ -14,6 +15,12 @@ ZombieGame::InventoryManager::InventoryManager(Elite::Blackboard* pBlackboard)
     if (!successInterface || !m_pInterface)
         throw std::runtime_error("Interface isn't stored correctly in Blackboard - InventoryManager.");
 
+    // Get Perception
+    bool successPerception = pBlackboard->GetData("Perception", m_pPerception);
+
+    if (!successPerception || !m_pPerception)
+        throw std::runtime_error("Perception isn't stored correctly in Blackboard - InventoryManager.");
+
     // Get HouseManager
     bool successHouseManager = pBlackboard->GetData("HouseManager", m_pHouseManager);
 
@@ -32,17 +39,8 @@ ZombieGame::InventoryManager::InventoryManager(Elite::Blackboard* pBlackboard)
 
 void ZombieGame::InventoryManager::Update(float dt)
 {
-    // Only update when item is in fov
-   if (m_pInterface->FOV_GetStats().NumItems > 0)
-    {
-       auto vItemsInFOV = m_pInterface->GetItemsInFOV();
-       for (auto& house : vItemsInFOV)
-       {
-           UpdateItemsInView();
-       }
-    }
-   ResetVisitedItems(dt);
-   
+    UpdateItemsInView();
+    ResetVisitedItems(dt);
 }
 
 const std::vector<std::unique_ptr<Item>>& ZombieGame::InventoryManager::GetStoredItems() const
@@ -52,8 +50,7 @@ const std::vector<std::unique_ptr<Item>>& ZombieGame::InventoryManager::GetStore
 
 bool ZombieGame::InventoryManager::CanVisitItemInFOV()
 {
-    const auto& vIntemsInFOV = m_pInterface->GetItemsInFOV();
-    for (const auto& fovItem : vIntemsInFOV)
+    for (const auto& fovItem : m_pPerception->GetItems())
     {
         for (const auto& storedItem : m_StoredItems)
         {
@@ -100,9 +97,7 @@ Item* ZombieGame::InventoryManager::GetClosestUnvisitedItem(const Elite::Vector2
 
 void ZombieGame::InventoryManager::UpdateItemsInView()
 {
-    auto itemsInView = m_pInterface->GetItemsInFOV();
-
-    for (const auto& itemInView : itemsInView)
+    for (const auto& itemInView : m_pPerception->GetItems())
     {
         auto compareItem = [&](const std::unique_ptr<Item>& pItemPtr) -> bool
             {
@@ -124,7 +119,7 @@ void ZombieGame::InventoryManager::UpdateItemsInView()
 
 void ZombieGame::InventoryManager::CheckAndUpdateNewItem(const ItemInfo& itemInView)
 {
-    std::cout << "New item\n";
+    ELITE_LOG_INFO("New item");
     auto newItem = std::make_unique<Item>();
     newItem->entityInfo.Type = eEntityType::ITEM;
     newItem->entityInfo.Location = itemInView.Location;
@@ -319,7 +314,7 @@ void ZombieGame::InventoryManager::UpdateInventorySlot(int slotIndex, const Item
     }
     else
     {
-        std::cout << "Invalid inventory slot index: " << slotIndex << std::endl;
+        ELITE_LOG_WARNING("Invalid inventory slot index: %d", slotIndex);
     }
 }
 
@@ -343,7 +338,7 @@ InventoryItemType ZombieGame::InventoryManager::GetInventoryItem(int slotIndex)
     }
     else
     {
-        std::cout << "Invalid inventory slot index: " << slotIndex << std::endl;
+        ELITE_LOG_WARNING("Invalid inventory slot index: %d", slotIndex);
         return InventoryItemType::Empty; // Return empty if invalid index
     }
 }
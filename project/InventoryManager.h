@@ -1,6 +1,7 @@
 #pragma once
 #include "EliteBehaviorTree/EDecisionMaking.h"
 #include "IExamInterface.h"
+#include "PerceptionFrame.h"
 
 namespace ZombieGame
 {
@@ -56,6 +57,7 @@ namespace ZombieGame
 
 	private:
 		IExamInterface* m_pInterface{nullptr};
+		const PerceptionFrame* m_pPerception{nullptr};
 		ZombieGame::HouseManager* m_pHouseManager{};
 
 		std::vector<std::pair<int, InventoryItemType>> m_Inventory{};
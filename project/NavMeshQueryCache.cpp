@@ -0,0 +1,106 @@
+#include "stdafx.h"
+#include "NavMeshQueryCache.h"
+
+#include "IExamInterface.h"
+
+constexpr float ZombieGame::NavMeshQueryCache::GoalCellSize;
+constexpr float ZombieGame::NavMeshQueryCache::AgentBucketSize;
+constexpr float ZombieGame::NavMeshQueryCache::ArrivalRadius;
+constexpr unsigned int ZombieGame::NavMeshQueryCache::MaxAgeFrames;
+constexpr unsigned int ZombieGame::NavMeshQueryCache::EntryCount;
+
+ZombieGame::NavMeshQueryCache::NavMeshQueryCache(IExamInterface* pInterface)
+    : m_pInterface(pInterface)
+{
+    if (!m_pInterface)
+        throw std::runtime_error("NavMeshQueryCache constructor received a null interface.");
+}
+
+void ZombieGame::NavMeshQueryCache::NewFrame(const Elite::Vector2& agentPosition)
+{
+    m_AgentPosition = agentPosition;
+    ++m_Frame;
+}
+
+Elite::Vector2 ZombieGame::NavMeshQueryCache::GetClosestPathPoint(const Elite::Vector2& goal)
+{
+    const int32_t goalX = Snap(goal.x, GoalCellSize);
+    const int32_t goalY = Snap(goal.y, GoalCellSize);
+    const int32_t agentX = Snap(m_AgentPosition.x, AgentBucketSize);
+    const int32_t agentY = Snap(m_AgentPosition.y, AgentBucketSize);
+
+    // Look for the goal, remember the oldest entry in case it has to be asked
+    Entry* pOldest = &m_Entries[0];
+    for (Entry& entry : m_Entries)
+    {
+        if (entry.IsValid && entry.GoalX == goalX && entry.GoalY == goalY && entry.AgentX == agentX && entry.AgentY == agentY)
+        {
+            if (IsUsable(entry))
+            {
+                ++m_Stats.Hits;
+                return entry.IsDirect ? goal : entry.PathPoint;
+            }
+
+            pOldest = &entry;
+            break;
+        }
+
+        if (!entry.IsValid || (pOldest->IsValid && entry.Frame < pOldest->Frame))
+            pOldest = &entry;
+    }
+
+    ++m_Stats.Misses;
+    const Elite::Vector2 pathPoint = m_pInterface->NavMesh_GetClosestPathPoint(goal);
+
+    Entry& entry = *pOldest;
+    entry.IsValid = true;
+    entry.GoalX = goalX;
+    entry.GoalY = goalY;
+    entry.AgentX = agentX;
+    entry.AgentY = agentY;
+    entry.Frame = m_Frame;
+    entry.IsDirect = pathPoint == goal;
+    entry.PathPoint = pathPoint;
+    return pathPoint;
+}
+
+void ZombieGame::NavMeshQueryCache::Invalidate()
+{
+    for (Entry& entry : m_Entries)
+    {
+        entry.IsValid = false;
+    }
+    ++m_Stats.Invalidations;
+}
+
+void ZombieGame::NavMeshQueryCache::Invalidate(const Elite::Vector2& goal)
+{
+    const int32_t goalX = Snap(goal.x, GoalCellSize);
+    const int32_t goalY = Snap(goal.y, GoalCellSize);
+    for (Entry& entry : m_Entries)
+    {
+        if (entry.GoalX == goalX && entry.GoalY == goalY)
+            entry.IsValid = false;
+    }
+    ++m_Stats.Invalidations;
+}
+
+void ZombieGame::NavMeshQueryCache::PrintReport() const
+{
+    const uint64_t queryCount = m_Stats.Hits + m_Stats.Misses;
+    printf("NavMesh query cache: %llu queries, %llu hits (%.1f%%), %llu asked the interface, %llu invalidations\n",
+        static_cast<unsigned long long>(queryCount),
+        static_cast<unsigned long long>(m_Stats.Hits),
+        queryCount > 0 ? 100.0 * static_cast<double>(m_Stats.Hits) / static_cast<double>(queryCount) : 0.0,
+        static_cast<unsigned long long>(m_Stats.Misses),
+        static_cast<unsigned long long>(m_Stats.Invalidations));
+}
+
+bool ZombieGame::NavMeshQueryCache::IsUsable(const Entry& entry) const
+{
+    if (m_Frame - entry.Frame > MaxAgeFrames)
+        return false;
+
+    // Once the agent is at the path point the host would send it further, unless it is the goal itself
+    return entry.IsDirect || entry.PathPoint.DistanceSquared(m_AgentPosition) > ArrivalRadius * ArrivalRadius;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include "EliteMath/EMath.h"
+
+#include <array>
+#include <cstdint>
+
+class IExamInterface;
+
+namespace ZombieGame
+{
+	struct NavMeshQueryCacheStats
+	{
+		uint64_t Hits = 0;
+		uint64_t Misses = 0;
+		uint64_t Invalidations = 0;
+	};
+
+	// Answers NavMesh_GetClosestPathPoint from the last results while the goal and the agent stay in the same place.
+	// A result is keyed on the goal snapped to GoalCellSize and on the agent position snapped to AgentBucketSize,
+	// it is asked again when it is older than MaxAgeFrames or when the agent reached the path point it returned.
+	// A goal the agent can walk to in a straight line is returned as it is, not as the goal of the cached query.
+	class NavMeshQueryCache final
+	{
+	public:
+		static constexpr float GoalCellSize{ 0.5f };
+		static constexpr float AgentBucketSize{ 4.f };
+		static constexpr float ArrivalRadius{ 2.f };
+		static constexpr unsigned int MaxAgeFrames{ 15 };
+
+		explicit NavMeshQueryCache(IExamInterface* pInterface);
+		~NavMeshQueryCache() = default;
+
+		NavMeshQueryCache(const NavMeshQueryCache& other) = delete;
+		NavMeshQueryCache& operator=(const NavMeshQueryCache& other) = delete;
+		NavMeshQueryCache(NavMeshQueryCache&& other) = delete;
+		NavMeshQueryCache& operator=(NavMeshQueryCache&& other) = delete;
+
+		// Called once at the start of UpdateSteering, the queries of this frame start from agentPosition
+		void NewFrame(const Elite::Vector2& agentPosition);
+
+		Elite::Vector2 GetClosestPathPoint(const Elite::Vector2& goal);
+
+		// Drops every result, for when the paths of the level change
+		void Invalidate();
+		// Drops the results for goals in the same cell as goal
+		void Invalidate(const Elite::Vector2& goal);
+
+		const NavMeshQueryCacheStats& GetStats() const { return m_Stats; }
+		void PrintReport() const;
+
+	private:
+		static constexpr unsigned int EntryCount{ 8 };
+
+		struct Entry
+		{
+			bool IsValid = false;
+			int32_t GoalX = 0;
+			int32_t GoalY = 0;
+			int32_t AgentX = 0;
+			int32_t AgentY = 0;
+			unsigned int Frame = 0;
+			bool IsDirect = false; // The host returned the goal itself
+			Elite::Vector2 PathPoint{};
+		};
+
+		IExamInterface* m_pInterface;
+		std::array<Entry, EntryCount> m_Entries{};
+		Elite::Vector2 m_AgentPosition{};
+		unsigned int m_Frame{ 0 };
+		NavMeshQueryCacheStats m_Stats{};
+
+		static int32_t Snap(float value, float cellSize) { return static_cast<int32_t>(std::floor(value / cellSize)); }
+		bool IsUsable(const Entry& entry) const;
+	};
+}
@@ -0,0 +1,29 @@
+#include "stdafx.h"
+#include "PerceptionFrame.h"
+
+#include "IExamInterface.h"
+
+void ZombieGame::PerceptionFrame::Capture(const IExamInterface* pInterface)
+{
+    const FOVStats& stats = pInterface->FOV_GetStats();
+
+    CaptureCategory(m_Houses, stats.NumHouses, &IExamInterface::GetHousesInFOV, pInterface);
+    CaptureCategory(m_Items, stats.NumItems, &IExamInterface::GetItemsInFOV, pInterface);
+    CaptureCategory(m_Enemies, stats.NumEnemies, &IExamInterface::GetEnemiesInFOV, pInterface);
+    CaptureCategory(m_PurgeZones, stats.NumPurgeZones, &IExamInterface::GetPurgeZonesInFOV, pInterface);
+
+    ++m_FrameCount;
+}
+
+template<typename T>
+void ZombieGame::PerceptionFrame::CaptureCategory(std::vector<T>& buffer, int count, std::vector<T>(IExamInterface::*fpGetInFOV)() const, const IExamInterface* pInterface)
+{
+    if (count <= 0)
+    {
+        buffer.clear();
+        return;
+    }
+
+    // The interface returns a new vector anyway, take it over instead of copying it
+    buffer = (pInterface->*fpGetInFOV)();
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "Exam_HelperStructs.h"
+
+#include <vector>
+
+class IExamInterface;
+
+namespace ZombieGame
+{
+	// Everything the agent sees this frame, captured once at the start of UpdateSteering.
+	// The managers and the behavior tree read the frame instead of asking the interface again,
+	// every Get...InFOV call builds a new vector on the host side.
+	// The references handed out stay valid until the next Capture.
+	class PerceptionFrame final
+	{
+	public:
+		PerceptionFrame() = default;
+		~PerceptionFrame() = default;
+
+		PerceptionFrame(const PerceptionFrame& other) = delete;
+		PerceptionFrame& operator=(const PerceptionFrame& other) = delete;
+		PerceptionFrame(PerceptionFrame&& other) = delete;
+		PerceptionFrame& operator=(PerceptionFrame&& other) = delete;
+
+		void Capture(const IExamInterface* pInterface);
+
+		// Getters
+		const std::vector<HouseInfo>& GetHouses() const { return m_Houses; }
+		const std::vector<ItemInfo>& GetItems() const { return m_Items; }
+		const std::vector<EnemyInfo>& GetEnemies() const { return m_Enemies; }
+		const std::vector<PurgeZoneInfo>& GetPurgeZones() const { return m_PurgeZones; }
+		unsigned int GetFrameCount() const { return m_FrameCount; }
+
+	private:
+		std::vector<HouseInfo> m_Houses{};
+		std::vector<ItemInfo> m_Items{};
+		std::vector<EnemyInfo> m_Enemies{};
+		std::vector<PurgeZoneInfo> m_PurgeZones{};
+		unsigned int m_FrameCount{ 0 };
+
+		// Only asks the interface when the FOV stats say there is something to see
+		template<typename T>
+		static void CaptureCategory(std::vector<T>& buffer, int count, std::vector<T>(IExamInterface::*fpGetInFOV)() const, const IExamInterface* pInterface);
+	};
+}
@@ -3,9 +3,257 @@
 
 #include "IExamInterface.h"
 #include "Behaviors.h"
+#include "BlackboardKeys.h"
+#include "EliteBehaviorTree/EBehaviorTreeBuilder.h"
+#include "EliteBehaviorTree/EBehaviorTreeMemo.h"
+#include "EliteBehaviorTree/EStaticBehaviorTree.h"
+#include "EliteLogging/ELogger.h"
 
 using namespace std;
 
+namespace
+{
+	// Branches of the behavior tree that run at a lower rate, in evaluations per second
+	constexpr unsigned int HousePlanningFrequency{ 10 };
+	constexpr unsigned int ExploreFrequency{ 5 };
+	// Minimum time between two re-targets that scan every stored house or item. A re-target that is held back
+	// fails, so the branch does not steer towards whatever another branch left in BB::Target
+	constexpr unsigned int RetargetPeriodMs{ 250 };
+
+	// What the behaviors read and write, the optimizer only moves a check when nothing in between can change its outcome.
+	// Conditions that are not declared here read every key, actions that are not declared write every key.
+	void DeclareBehaviorEffects(Elite::BehaviorTreeOptimizer& optimizer)
+	{
+		optimizer.DeclareCondition("HasItemTarget", BT_Conditions::HasItemTarget, { BB::TargetItem });
+		optimizer.DeclareCondition("HasNoItemTarget", BT_Conditions::HasNoItemTarget, { BB::TargetItem });
+		optimizer.DeclareCondition("HasNoHouseTarget", BT_Conditions::HasNoHouseTarget, { BB::TargetHouse });
+		optimizer.DeclareCondition("HasCheckpointTarget", BT_Conditions::HasCheckpointTarget, { BB::TargetCheckpoint });
+		optimizer.DeclareCondition("HasNoCheckpointTarget", BT_Conditions::HasNoCheckpointTarget, { BB::TargetCheckpoint });
+		optimizer.DeclareCondition("IsHouseInFOV", BT_Conditions::IsHouseInFOV, { BB::Perception });
+		optimizer.DeclareCondition("IsItemInFOV", BT_Conditions::IsItemInFOV, { BB::Perception });
+		optimizer.DeclareCondition("IsEnemyInFOV", BT_Conditions::IsEnemyInFOV, { BB::Perception });
+		optimizer.DeclareExclusive(BT_Conditions::HasItemTarget, BT_Conditions::HasNoItemTarget);
+		optimizer.DeclareExclusive(BT_Conditions::HasCheckpointTarget, BT_Conditions::HasNoCheckpointTarget);
+
+		// Steering
+		optimizer.DeclareAction("SetRunning", BT_Actions::SetRunning, { BB::ShouldRun }, false);
+		optimizer.DeclareAction("SeekTarget", BT_Actions::SeekTarget, { BB::CurrentSteeringBehavior }, false);
+		optimizer.DeclareAction("MoveToTarget", BT_Actions::MoveToTarget, { BB::CurrentSteeringBehavior }, false);
+		optimizer.DeclareAction("SeekAndFaceTarget", BT_Actions::SeekAndFaceTarget, { BB::CurrentSteeringBehavior }, false);
+		optimizer.DeclareAction("FleeAndFaceTarget", BT_Actions::FleeAndFaceTarget, { BB::CurrentSteeringBehavior }, false);
+		optimizer.DeclareAction("FaceTarget", BT_Actions::FaceTarget, { BB::CurrentSteeringBehavior }, false);
+
+		// Houses
+		optimizer.DeclareAction("Explore", BT_Actions::Explore, { BB::Target, BB::TargetHouse });
+		optimizer.DeclareAction("TargetHouseInFOV", BT_Actions::TargetHouseInFOV, { BB::TargetHouse, BB::Target });
+		optimizer.DeclareAction("TargetClosestUnvisitedHouse", BT_Actions::TargetClosestUnvisitedHouse, { BB::Grid, BB::Target, BB::TargetHouse });
+		optimizer.DeclareAction("MarkHouseAsVisited", BT_Actions::MarkHouseAsVisited, { BB::HouseManager, BB::Grid, BB::TargetHouse });
+		optimizer.DeclareAction("TargetClosestCheckpoint", BT_Actions::TargetClosestCheckpoint, { BB::TargetCheckpoint, BB::Target });
+		optimizer.DeclareAction("MarkCheckPointVisited", BT_Actions::MarkCheckPointVisited, { BB::TargetHouse, BB::TargetCheckpoint });
+
+		// Items
+		optimizer.DeclareAction("TargetItemInFOV", BT_Actions::TargetItemInFOV, { BB::TargetItem, BB::CanScan, BB::TargetCheckpoint, BB::Target });
+		optimizer.DeclareAction("SetClosestItemAsTarget", BT_Actions::SetClosestItemAsTarget, { BB::Grid, BB::TargetItem, BB::CanScan, BB::Target });
+		optimizer.DeclareAction("AddItemToInventory", BT_Actions::AddItemToInventory, { BB::Interface, BB::InventoryManager });
+		optimizer.DeclareAction("ReplaceItem", BT_Actions::ReplaceItem, { BB::Interface, BB::InventoryManager });
+		optimizer.DeclareAction("DestroyItem", BT_Actions::DestroyItem, { BB::Interface, BB::InventoryManager });
+		optimizer.DeclareAction("MarkItemAsVisited", BT_Actions::MarkItemAsVisited, { BB::InventoryManager, BB::TargetItem, BB::CanScan });
+		optimizer.DeclareAction("UseMedkit", BT_Actions::UseMedkit, { BB::InventoryManager });
+		optimizer.DeclareAction("UseFood", BT_Actions::UseFood, { BB::InventoryManager });
+
+		// Enemies and purge zones
+		optimizer.DeclareAction("targetClosestEnemyInFOV", BT_Actions::targetClosestEnemyInFOV,
+			{ BB::AlertedTime, BB::EntityManager, BB::TargetEnemy, BB::TargetHouse, BB::TargetItem, BB::Target });
+		optimizer.DeclareAction("Shoot", BT_Actions::Shoot, { BB::InventoryManager });
+		optimizer.DeclareAction("HandleAttackFromBehind", BT_Actions::HandleAttackFromBehind, { BB::AlertedTime, BB::Target });
+		optimizer.DeclareAction("TargetClosestOutPurgeZonePosition", BT_Actions::TargetClosestOutPurgeZonePosition,
+			{ BB::TargetHouse, BB::TargetCheckpoint, BB::TargetItem, BB::Target });
+	}
+
+	using namespace Elite::StaticBT;
+
+	// Interrupt guards of the root, one per branch with a higher priority than the house search
+	using RootGuards = Guards<
+		Sequence<
+			Condition<&BT_Conditions::IsMedkitNeeded>,
+			Condition<&BT_Conditions::HasMedkit>
+		>,
+		Sequence<
+			Condition<&BT_Conditions::IsFoodNeeded>,
+			Condition<&BT_Conditions::HasFood>
+		>,
+		Condition<&BT_Conditions::IsInPurgeZone>,
+		Condition<&BT_Conditions::IsEnemyInFOV>,
+		Condition<&BT_Conditions::IsUnderAttack>,
+		Selector<
+			CachedCondition<&BT_Conditions::HasItemTarget, BB::TargetItem.GetIndex()>,
+			Sequence<
+				Condition<&BT_Conditions::IsItemInFOV>,
+				Condition<&BT_Conditions::CanVisitItemInFOV>
+			>,
+			Condition<&BT_Conditions::CanVisitKnownItems>
+		>
+	>;
+
+	// Same tree as CreateBehaviorTree, composed at compile time
+	using StaticAgentTree = MemorySelector<RootGuards,
+		// Use Medkit or Food if necessary
+		UtilitySelector<
+			UtilityOption<&BT_Scores::MedkitUrgency, Action<&BT_Actions::UseMedkit>>,
+			UtilityOption<&BT_Scores::FoodUrgency, Action<&BT_Actions::UseFood>>
+		>,
+		//Enemy behavior
+		Selector<
+			//Purge Zones
+			Sequence<
+				Condition<&BT_Conditions::IsInPurgeZone>,
+				Action<&BT_Actions::TargetClosestOutPurgeZonePosition>,
+				Action<&BT_Actions::SetRunning>,
+				Action<&BT_Actions::SeekTarget>
+			>,
+			//Enemy in view
+			Sequence<
+				Condition<&BT_Conditions::IsEnemyInFOV>,
+				Action<&BT_Actions::targetClosestEnemyInFOV>,
+				Selector<
+					//Agent has no weapon
+					Sequence<
+						Condition<&BT_Conditions::HasNoWeapon>,
+						Action<&BT_Actions::SetRunning>,
+						Action<&BT_Actions::FleeAndFaceTarget>
+					>,
+					//Aiming finished
+					Sequence<
+						Condition<&BT_Conditions::IsAimingFinished>,
+						Action<&BT_Actions::Shoot>
+					>,
+					//Aim at the target
+					Action<&BT_Actions::FaceTarget>
+				>
+			>,
+
+			//Attack from behind
+			Sequence<
+				Action<&BT_Actions::HandleAttackFromBehind>,
+				Action<&BT_Actions::SetRunning>,
+				Action<&BT_Actions::FleeAndFaceTarget>
+			>
+		>,
+		// Item behaviors
+		Selector<
+			// Target Item in FOV and Move to Target
+			Sequence<
+				CachedCondition<&BT_Conditions::HasNoItemTarget, BB::TargetItem.GetIndex()>,
+				Condition<&BT_Conditions::IsItemInFOV>,
+				Condition<&BT_Conditions::CanVisitItemInFOV>,
+				Action<&BT_Actions::TargetItemInFOV>,
+				Action<&BT_Actions::SeekTarget>
+			>,
+			// Target closest unvisited Item and Move to Target
+			Sequence<
+				CachedCondition<&BT_Conditions::HasNoItemTarget, BB::TargetItem.GetIndex()>,
+				Condition<&BT_Conditions::CanVisitKnownItems>,
+				RateLimit<1, RetargetPeriodMs, Action<&BT_Actions::SetClosestItemAsTarget>>,
+				Action<&BT_Actions::SeekTarget>
+			>,
+			// Check if target item can be grabbed
+			Sequence<
+				CachedCondition<&BT_Conditions::HasItemTarget, BB::TargetItem.GetIndex()>,
+				Action<&BT_Actions::SeekAndFaceTarget>,
+				Condition<&BT_Conditions::IsItemInGrabRange>,
+				// Item handling
+				Selector<
+					// add item to inventory when there is an empty slot
+					Sequence<
+						Condition<&BT_Conditions::HasEmptySlot>,
+						Condition<&BT_Conditions::IsNotGarbage>,
+						Action<&BT_Actions::AddItemToInventory>,
+						Action<&BT_Actions::MarkItemAsVisited>
+					>,
+					// if all slots are full check if can replace Item
+					Sequence<
+						Condition<&BT_Conditions::IsNotGarbage>,
+						Condition<&BT_Conditions::ShouldItemBeReplaced>,
+						Action<&BT_Actions::ReplaceItem>,
+						Action<&BT_Actions::MarkItemAsVisited>
+					>,
+					// If slots are full AND can't be replaced destroy the item on the ground
+					Sequence<
+						Action<&BT_Actions::DestroyItem>,
+						Action<&BT_Actions::MarkItemAsVisited>
+					>
+				>
+			>
+		>,
+		// House behaviors
+		MemorySelector<Guards<>,
+			// House In FOV and Move to Target
+			Sequence<
+				CachedCondition<&BT_Conditions::HasNoItemTarget, BB::TargetItem.GetIndex()>,
+				CachedCondition<&BT_Conditions::HasNoHouseTarget, BB::TargetHouse.GetIndex()>,
+				Condition<&BT_Conditions::IsHouseInFOV>,
+				Condition<&BT_Conditions::CanVisitHouseInFOV>,
+				Action<&BT_Actions::TargetHouseInFOV>,
+				Action<&BT_Actions::SeekTarget>
+			>,
+			// No house In FOV (Target known unvisited houses) and Move to Target
+			Sequence<
+				CachedCondition<&BT_Conditions::HasNoItemTarget, BB::TargetItem.GetIndex()>,
+				CachedCondition<&BT_Conditions::HasNoHouseTarget, BB::TargetHouse.GetIndex()>,
+				Condition<&BT_Conditions::CanVisitKnownHouse>,
+				TickRate<HousePlanningFrequency, RateLimit<1, RetargetPeriodMs, Action<&BT_Actions::TargetClosestUnvisitedHouse>>,
+					BB::Target.GetIndex()>,
+				Action<&BT_Actions::SeekTarget>
+			>,
+			// Visit House
+			MemorySelector<Guards<>,
+				// Check if the agent is outside the target house
+				Sequence<
+					Condition<&BT_Conditions::IsAgentOutsideTargetHouse>,
+					CachedCondition<&BT_Conditions::HasNoItemTarget, BB::TargetItem.GetIndex()>,
+					Action<&BT_Actions::SeekTarget>
+				>,
+				// Search the house
+				MemorySequence<Guards<>,
+					MemorySelector<Guards<>,
+						// If no checkpoint target, set closest checkpoint as target
+						Sequence<
+							CachedCondition<&BT_Conditions::HasNoItemTarget, BB::TargetItem.GetIndex()>,
+							CachedCondition<&BT_Conditions::HasNoCheckpointTarget, BB::TargetCheckpoint.GetIndex()>,
+							Condition<&BT_Conditions::CanSearchHouse>,
+							Action<&BT_Actions::TargetClosestCheckpoint>,
+							Action<&BT_Actions::SeekTarget>
+						>,
+						// If checkpoint target exists, move towards it and mark it as visited once reached
+						MemorySequence<Guards<>,
+							CachedCondition<&BT_Conditions::HasNoItemTarget, BB::TargetItem.GetIndex()>,
+							CachedCondition<&BT_Conditions::HasCheckpointTarget, BB::TargetCheckpoint.GetIndex()>,
+							Action<&BT_Actions::MoveToTarget>,
+							Action<&BT_Actions::MarkCheckPointVisited>
+						>,
+						// If checkpoint reached, mark it as visited
+						Sequence<
+							CachedCondition<&BT_Conditions::HasCheckpointTarget, BB::TargetCheckpoint.GetIndex()>,
+							Condition<&BT_Conditions::HasReachedTarget>,
+							Action<&BT_Actions::MarkCheckPointVisited>
+						>
+					>,
+					// After all checkpoints visited, mark house as visited
+					Condition<&BT_Conditions::AreAlLCheckpointsVisited>,
+					Action<&BT_Actions::MarkHouseAsVisited>
+				>
+			>,
+			// Fallback Exploration
+			Sequence<
+				CachedCondition<&BT_Conditions::HasNoHouseTarget, BB::TargetHouse.GetIndex()>,
+				CachedCondition<&BT_Conditions::HasNoItemTarget, BB::TargetItem.GetIndex()>,
+				TickRate<ExploreFrequency, Action<&BT_Actions::Explore>, BB::Target.GetIndex()>,
+				Action<&BT_Actions::SeekTarget>
+			>
+		>
+	>;
+}
+
 void SurvivalAgentPlugin::Initialize(IBaseInterface* pInterface, PluginInfo& info)
 {
 	m_pInterface = static_cast<IExamInterface*>(pInterface);
@@ -42,6 +290,17 @@ void SurvivalAgentPlugin::Initialize(IBaseInterface* pInterface, PluginInfo& inf
 
 	//BehaviorTree
 	CreateBehaviorTree();
+	if (m_BenchmarkBehaviorTrees)
+	{
+		CreateStaticBehaviorTree();
+		m_pBehaviorTreeBenchmark = std::make_unique<Elite::BehaviorTreeBenchmark>();
+		m_pBehaviorTreeBenchmark->AddTree("Runtime (flat)", m_pBehaviourTree.get());
+		m_pBehaviorTreeBenchmark->AddTree("Static", m_pStaticBehaviourTree.get());
+	}
+#if ELITE_BT_PROFILING
+	// Trace of the first seconds, written to BehaviorTreeTrace.json on shutdown
+	Elite::BehaviorTreeProfiler::GetInstance().StartCapture(300);
+#endif
 
 
 }
@@ -49,12 +308,49 @@ void SurvivalAgentPlugin::Initialize(IBaseInterface* pInterface, PluginInfo& inf
 void SurvivalAgentPlugin::DllInit()
 {
 	//Called when the plugin is loaded
+	Elite::Logger::GetInstance().Start(m_WriteLogFile ? "AgentLog.txt" : nullptr);
 }
 
 
 void SurvivalAgentPlugin::DllShutdown()
 {
 	//Called when the plugin gets unloaded
+	Elite::Logger::GetInstance().Stop();
+	if (m_pBlackboardProfiler)
+		m_pBlackboardProfiler->PrintReport();
+	if (m_pBehaviorTreeBenchmark)
+		m_pBehaviorTreeBenchmark->PrintReport();
+	if (m_pBehaviourTree && m_pBehaviourTree->GetConditionMemo())
+		m_pBehaviourTree->GetConditionMemo()->PrintReport();
+	for (const Elite::BehaviorTickRate* pTickRate : m_TickRateDecorators)
+		pTickRate->PrintReport();
+	if (m_pNavMeshCache)
+		m_pNavMeshCache->PrintReport();
+	if (m_pGrid)
+	{
+		m_pGrid->GetInfluenceMap().PrintReport();
+		m_pGrid->GetPathfinder().PrintReport();
+	}
+	if (m_BenchmarkInfluenceMap)
+		ZombieGame::InfluenceMap::Benchmark(128, 1000);
+	if (m_BenchmarkPathfinder)
+	{
+		ZombieGame::GridPathfinder::Benchmark(64, 2000);
+		ZombieGame::GridPathfinder::Benchmark(256, 200);
+	}
+	if (m_pTraceRecorder)
+	{
+		m_pTraceRecorder->Save("BehaviorTreeRecording.bin");
+		printf("Behavior tree recording: %llu ticks, %llu bytes written\n",
+			static_cast<unsigned long long>(m_pTraceRecorder->GetRecordedTickCount()),
+			static_cast<unsigned long long>(m_pTraceRecorder->GetWrittenByteCount()));
+	}
+	if (m_pTreeOptimizer)
+		m_pTreeOptimizer->PrintReport();
+#if ELITE_BT_PROFILING
+	Elite::BehaviorTreeProfiler::GetInstance().PrintReport();
+	Elite::BehaviorTreeProfiler::GetInstance().ExportChromeTrace("BehaviorTreeTrace.json");
+#endif
 }
 
 // Only works in DEBUG Mode
@@ -88,19 +384,30 @@ SteeringPlugin_Output SurvivalAgentPlugin::UpdateSteering(float dt)
 	m_ShouldRun = false;
 	m_DeltaTime = dt;
 
+	// Everything in the FOV is read once, the managers and the behaviors use the captured frame
+	m_Perception.Capture(m_pInterface);
+	m_pBlackboard->NotifyChanged(BB::Perception);
+
 	// Update Managers
 	m_AgentInfo = m_pInterface->Agent_GetInfo();
+	m_pNavMeshCache->NewFrame(m_AgentInfo.Position);
 	m_pHouseManager->Update(dt);
 	m_pEntityManager->Update(dt);
 	m_pGrid->UpdateCurrentAgentCell(&m_AgentInfo);
 	m_pInventoryManager->Update(dt);
+	m_pGrid->UpdateInfluenceMap();
 	
 	//Behaviours
-	m_pBehaviourTree->Update(dt);
+	if (m_pBehaviorTreeBenchmark)
+		m_pBehaviorTreeBenchmark->Update(dt);
+	else
+		m_pBehaviourTree->Update(dt);
+	if (m_pOptimizedRoot && m_pTreeOptimizer->IsRecordingComplete())
+		SelectVerifiedTree();
 
 	//Calculate pSteering
-	ISteeringBehavior* pCurrentSteeringBehavior{};
-	if (m_pBlackboard->GetData("CurrentSteeringBehavior", pCurrentSteeringBehavior) && pCurrentSteeringBehavior)
+	ISteeringBehavior* pCurrentSteeringBehavior = m_pBlackboard->GetData(BB::CurrentSteeringBehavior);
+	if (pCurrentSteeringBehavior)
 	{
 		*m_pCurrentSteering = pCurrentSteeringBehavior->CalculateSteering(dt, m_AgentInfo);
 		m_pInterface->Draw_Direction(m_AgentInfo.Position, m_pCurrentSteering->LinearVelocity, 10.f, Elite::Vector3{ 1.f,1.f,1.f });
@@ -112,6 +419,14 @@ SteeringPlugin_Output SurvivalAgentPlugin::UpdateSteering(float dt)
 	//scanning environment
 	m_pCurrentSteering->AngularVelocity = m_AgentInfo.MaxAngularSpeed;	
 
+	if (m_PublishBlackboardSnapshots)
+		m_pBlackboard->PublishSnapshot();
+	if (m_pBlackboardProfiler)
+		m_pBlackboardProfiler->EndFrame();
+#if ELITE_BT_PROFILING
+	Elite::BehaviorTreeProfiler::GetInstance().EndFrame();
+#endif
+
 	return *m_pCurrentSteering;
 }
 
@@ -121,233 +436,377 @@ void SurvivalAgentPlugin::Render(float dt) const
 	m_pGrid->RenderGrid();
 	m_pHouseManager->Render();
 
+	// blackboard usage
+	if (m_pBlackboardProfiler)
+		m_pBlackboardProfiler->RenderImGui();
+#if ELITE_BT_PROFILING
+	Elite::BehaviorTreeProfiler::GetInstance().RenderImGui();
+#endif
+
+	// consumable scores
+	if (m_pConsumableSelector && ImGui::Begin("Utility"))
+	{
+		const char* const optionNames[]{ "Medkit", "Food" };
+		const std::vector<float>& scores = m_pConsumableSelector->GetScores();
+		for (size_t i = 0; i < scores.size(); ++i)
+		{
+			const bool isSelected = static_cast<int>(i) == m_pConsumableSelector->GetSelectedIndex();
+			ImGui::Text("%s%s: %.2f", isSelected ? "> " : "  ", optionNames[i], scores[i]);
+		}
+	}
+	if (m_pConsumableSelector)
+		ImGui::End();
+
 	// target position
 	Elite::Vector3 color = Elite::Vector3{ 1.f, 0.f, 1.f }; // purple
 	float size = 2.f;
-	m_pInterface->Draw_SolidCircle(m_pInterface->NavMesh_GetClosestPathPoint(m_Target), .7f, { 0,0 }, { 1, 0, 0 });
-	m_pInterface->Draw_Circle(m_pInterface->NavMesh_GetClosestPathPoint(m_Target), size, color);
+	const Elite::Vector2 targetPathPoint = m_pNavMeshCache->GetClosestPathPoint(m_Target);
+	m_pInterface->Draw_SolidCircle(targetPathPoint, .7f, { 0,0 }, { 1, 0, 0 });
+	m_pInterface->Draw_Circle(targetPathPoint, size, color);
 }
 
 void SurvivalAgentPlugin::InitializeBlackboard()
 {
+	m_pBlackboard->Reserve(BB::KeyCount);
+	if (m_ProfileBlackboard)
+	{
+		m_pBlackboardProfiler = std::make_unique<Elite::BlackboardProfiler>();
+		m_pBlackboard->SetProfiler(m_pBlackboardProfiler.get());
+	}
+
 	// Global Data
-	m_pBlackboard->AddData("Interface", m_pInterface);
+	m_pBlackboard->AddData(BB::Interface, m_pInterface);
+	m_pBlackboard->AddData(BB::Perception, &m_Perception);
+	m_pNavMeshCache = std::make_unique<ZombieGame::NavMeshQueryCache>(m_pInterface);
+	m_pBlackboard->AddData(BB::NavMeshCache, m_pNavMeshCache.get());
 
 	// Grid Data
 	m_pGrid = std::make_unique<ZombieGame::Grid>(m_pBlackboard.get(), 15);
-	m_pBlackboard->AddData("Grid", m_pGrid.get());
+	m_pGrid->SetUseFlowField(m_ExploreWithFlowField);
+	m_pBlackboard->AddData(BB::Grid, m_pGrid.get());
 
 	// Steering Data
-	m_pBlackboard->AddData("CurrentSteering", m_pCurrentSteering.get());
-	m_pBlackboard->AddData("CurrentSteeringBehavior", static_cast<ISteeringBehavior*>(nullptr));
-	m_pBlackboard->AddData("Seek", m_pSeekBehaviour.get());
-	m_pBlackboard->AddData("Face", m_pFaceBehaviour.get());
-	m_pBlackboard->AddData("Flee", m_pFleeBehaviour.get());
-	m_pBlackboard->AddData("Arrive", m_pArriveBehaviour.get());
-	m_pBlackboard->AddData("SeekAndFace", m_pSeekAndFaceBehaviour.get());
-	m_pBlackboard->AddData("FleeAndFace", m_pFleeAndFaceBehaviour.get());
+	m_pBlackboard->AddData(BB::CurrentSteering, m_pCurrentSteering.get());
+	m_pBlackboard->AddData(BB::CurrentSteeringBehavior, nullptr);
+	m_pBlackboard->AddData(BB::Seek, m_pSeekBehaviour.get());
+	m_pBlackboard->AddData(BB::Face, m_pFaceBehaviour.get());
+	m_pBlackboard->AddData(BB::Flee, m_pFleeBehaviour.get());
+	m_pBlackboard->AddData(BB::Arrive, m_pArriveBehaviour.get());
+	m_pBlackboard->AddData(BB::SeekAndFace, m_pSeekAndFaceBehaviour.get());
+	m_pBlackboard->AddData(BB::FleeAndFace, m_pFleeAndFaceBehaviour.get());
 
 	// Agent Data
-	m_pBlackboard->AddData("AgentInfo", &m_AgentInfo);
-	m_pBlackboard->AddData("RunTreshold", m_TresholdToRun);
-	m_pBlackboard->AddData("ShouldRun", &m_ShouldRun);
-	m_pBlackboard->AddData("CanScan", &m_CanScan);
-	m_pBlackboard->AddData("AlertedTime", &m_AlertedTime);
+	m_pBlackboard->AddData(BB::AgentInfo, &m_AgentInfo);
+	m_pBlackboard->AddData(BB::RunTreshold, m_TresholdToRun);
+	m_pBlackboard->AddData(BB::ShouldRun, &m_ShouldRun);
+	m_pBlackboard->AddData(BB::CanScan, &m_CanScan);
+	m_pBlackboard->AddData(BB::AlertedTime, &m_AlertedTime);
 
 	// Target Data
-	m_pBlackboard->AddData("Target", &m_Target);
-	m_pBlackboard->AddData("TargetHouse", static_cast<House*>(nullptr));
-	m_pBlackboard->AddData("TargetCheckpoint", static_cast<CheckPoint*>(nullptr));
-	m_pBlackboard->AddData("TargetItem", static_cast<Item*>(nullptr));
-	m_pBlackboard->AddData("TargetEnemy", static_cast<EnemyInfo*>(nullptr));
-	m_pBlackboard->AddData("TargetPurgeZone", static_cast<PurgeZone*>(nullptr));
+	m_pBlackboard->AddData(BB::Target, &m_Target);
+	m_pBlackboard->AddData(BB::TargetHouse, nullptr);
+	m_pBlackboard->AddData(BB::TargetCheckpoint, nullptr);
+	m_pBlackboard->AddData(BB::TargetItem, nullptr);
+	m_pBlackboard->AddData(BB::TargetEnemy, nullptr);
+	m_pBlackboard->AddData(BB::TargetPurgeZone, nullptr);
 
 	// House Data
-	m_pBlackboard->AddData("StoredHouses", &m_StoredHouses);
+	m_pBlackboard->AddData(BB::StoredHouses, &m_StoredHouses);
 	m_pHouseManager = std::make_unique<ZombieGame::HouseManager>(m_pBlackboard.get());
-	m_pBlackboard->AddData("HouseManager", m_pHouseManager.get());
+	m_pBlackboard->AddData(BB::HouseManager, m_pHouseManager.get());
 
 	// Inventory Data
 	m_pInventoryManager = std::make_unique<ZombieGame::InventoryManager>(m_pBlackboard.get());
-	m_pBlackboard->AddData("InventoryManager", m_pInventoryManager.get());
+	m_pBlackboard->AddData(BB::InventoryManager, m_pInventoryManager.get());
 
 	// Enemy Data
 	m_pEntityManager = std::make_unique<ZombieGame::EntityManager>(m_pBlackboard.get());
-	m_pBlackboard->AddData("EntityManager", m_pEntityManager.get());
+	m_pBlackboard->AddData(BB::EntityManager, m_pEntityManager.get());
 
 	// Timers
-	m_pBlackboard->AddData("DeltaTime", &m_DeltaTime);
-	m_pBlackboard->AddData("ExploreTime", &m_ExploreTime);
+	m_pBlackboard->AddData(BB::DeltaTime, &m_DeltaTime);
+	m_pBlackboard->AddData(BB::ExploreTime, &m_ExploreTime);
+
+	// A snapshot only copies the slots: the agent info, target and timers are stored as pointers to this plugin,
+	// so a reader off the main thread would still see them change. Off until such a reader exists.
+	if (m_PublishBlackboardSnapshots)
+	{
+		m_pBlackboard->EnableSnapshots();
+		m_pBlackboard->PublishSnapshot();
+	}
 }
 
 void SurvivalAgentPlugin::CreateBehaviorTree()
 {
-	m_pBehaviourTree = std::make_unique<Elite::BehaviorTree>(m_pBlackboard.get(),
-		new Elite::BehaviorSelector({
-			// Use Medkit if necessary
-			new Elite::BehaviorSequence({
-				new Elite::BehaviorConditional(BT_Conditions::IsMedkitNeeded),
-				new Elite::BehaviorConditional(BT_Conditions::HasMedkit),
-				new Elite::BehaviorAction(BT_Actions::UseMedkit)
-			}),
-			// Use Food if necessary
-			new Elite::BehaviorSequence({
-				new Elite::BehaviorConditional(BT_Conditions::IsFoodNeeded),
-				new Elite::BehaviorConditional(BT_Conditions::HasFood),
-				new Elite::BehaviorAction(BT_Actions::UseFood)
+	Elite::BehaviorTreeBuilder builder{};
+
+	// Re-planning the next house and the exploration target does not need to happen every frame,
+	// the conditions around them and the steering still run every frame. They re-plan right away when
+	// another branch moved BB::Target in the meantime, so SeekTarget never follows a target they did not pick.
+	Elite::BehaviorTickRate* pHousePlanning = builder.TickRate(
+		builder.RateLimit(builder.Action(BT_Actions::TargetClosestUnvisitedHouse), 1, RetargetPeriodMs / 1000.f),
+		HousePlanningFrequency, { BB::Target });
+	pHousePlanning->SetName("HousePlanning");
+	Elite::BehaviorTickRate* pExploration = builder.TickRate(builder.Action(BT_Actions::Explore), ExploreFrequency, { BB::Target });
+	pExploration->SetName("Exploration");
+	m_TickRateDecorators = { pHousePlanning, pExploration };
+
+	// Medkit and food are weighed against each other, the stat that is missing the most goes first
+	Elite::BehaviorUtilitySelector* pConsumables = builder.UtilitySelector({
+		{ builder.Action(BT_Actions::UseMedkit), BT_Scores::MedkitUrgency },
+		{ builder.Action(BT_Actions::UseFood), BT_Scores::FoodUrgency }
+	});
+	pConsumables->SetName("Consumables");
+	m_pConsumableSelector = pConsumables;
+
+	// Once the house search is running only the guards are checked, the higher priority branches
+	// are evaluated again as soon as one of them succeeds
+	Elite::IBehavior* pRoot = builder.MemorySelector({
+		// Use Medkit or Food if necessary
+		pConsumables,
+		//Enemy behavior
+		builder.Selector({
+			//Purge Zones
+			builder.Sequence(
+			{
+				builder.Conditional(BT_Conditions::IsInPurgeZone),
+				builder.Action(BT_Actions::TargetClosestOutPurgeZonePosition),
+				builder.Action(BT_Actions::SetRunning),
+				builder.Action(BT_Actions::SeekTarget)
 			}),
-			//Enemy behavior
-			new Elite::BehaviorSelector({
-				//Purge Zones
-				new Elite::BehaviorSequence(
-				{
-					new Elite::BehaviorConditional(BT_Conditions::IsInPurgeZone),
-					new Elite::BehaviorAction(BT_Actions::TargetClosestOutPurgeZonePosition),
-					new Elite::BehaviorAction(BT_Actions::SetRunning),
-					new Elite::BehaviorAction(BT_Actions::SeekTarget)
-				}),
-				//Enemy in view
-				new Elite::BehaviorSequence({
-					new Elite::BehaviorConditional(BT_Conditions::IsEnemyInFOV),
-					new Elite::BehaviorAction(BT_Actions::targetClosestEnemyInFOV),
-					new Elite::BehaviorSelector({
-						//Agent has no weapon
-						new Elite::BehaviorSequence({
-							new Elite::BehaviorConditional(BT_Conditions::HasNoWeapon),
-							new Elite::BehaviorAction(BT_Actions::SetRunning),
-							new Elite::BehaviorAction(BT_Actions::FleeAndFaceTarget)
-						}),
-						//Aiming finished
-						new Elite::BehaviorSequence({
-							new Elite::BehaviorConditional(BT_Conditions::IsAimingFinished),
-							new Elite::BehaviorAction(BT_Actions::Shoot)
-						}),
-						//Aim at the target
-						new Elite::BehaviorAction(BT_Actions::FaceTarget)
+			//Enemy in view
+			builder.Sequence({
+				builder.Conditional(BT_Conditions::IsEnemyInFOV),
+				builder.Action(BT_Actions::targetClosestEnemyInFOV),
+				builder.Selector({
+					//Agent has no weapon
+					builder.Sequence({
+						builder.Conditional(BT_Conditions::HasNoWeapon),
+						builder.Action(BT_Actions::SetRunning),
+						builder.Action(BT_Actions::FleeAndFaceTarget)
+					}),
+					//Aiming finished
+					builder.Sequence({
+						builder.Conditional(BT_Conditions::IsAimingFinished),
+						builder.Action(BT_Actions::Shoot)
 					}),
+					//Aim at the target
+					builder.Action(BT_Actions::FaceTarget)
 				}),
+			}),
 
-				//Attack from behind
-				new Elite::BehaviorSequence(
-				{
-					new Elite::BehaviorAction(BT_Actions::HandleAttackFromBehind),
-					new Elite::BehaviorAction(BT_Actions::SetRunning),
-					new Elite::BehaviorAction(BT_Actions::FleeAndFaceTarget)
+			//Attack from behind
+			builder.Sequence(
+			{
+				builder.Action(BT_Actions::HandleAttackFromBehind),
+				builder.Action(BT_Actions::SetRunning),
+				builder.Action(BT_Actions::FleeAndFaceTarget)
+			})
+		}),
+		// Item behaviors
+		builder.Selector({
+			// Target Item in FOV and Move to Target
+			builder.Sequence({
+				builder.Conditional(BT_Conditions::HasNoItemTarget, { BB::TargetItem }),
+				builder.Conditional(BT_Conditions::IsItemInFOV),
+				builder.Conditional(BT_Conditions::CanVisitItemInFOV),
+				builder.Action(BT_Actions::TargetItemInFOV),
+				builder.Action(BT_Actions::SeekTarget)
+			}),
+			// Target closest unvisited Item and Move to Target
+			builder.Sequence({
+				builder.Conditional(BT_Conditions::HasNoItemTarget, { BB::TargetItem }),
+				builder.Conditional(BT_Conditions::CanVisitKnownItems),
+				builder.RateLimit(builder.Action(BT_Actions::SetClosestItemAsTarget), 1, RetargetPeriodMs / 1000.f),
+				builder.Action(BT_Actions::SeekTarget)
+			}),
+			// Check if target item can be grabbed
+			builder.Sequence({
+				builder.Conditional(BT_Conditions::HasItemTarget, { BB::TargetItem }),
+				builder.Action(BT_Actions::SeekAndFaceTarget),
+				builder.Conditional(BT_Conditions::IsItemInGrabRange),
+				// Item handling
+				builder.Selector({
+					// add item to inventory when there is an empty slot
+					builder.Sequence({
+						builder.Conditional(BT_Conditions::HasEmptySlot),
+						builder.Conditional(BT_Conditions::IsNotGarbage),
+						builder.Action(BT_Actions::AddItemToInventory),
+						builder.Action(BT_Actions::MarkItemAsVisited)
+					}),
+					// if all slots are full check if can replace Item
+					builder.Sequence({
+						builder.Conditional(BT_Conditions::IsNotGarbage),
+						builder.Conditional(BT_Conditions::ShouldItemBeReplaced),
+						builder.Action(BT_Actions::ReplaceItem),
+						builder.Action(BT_Actions::MarkItemAsVisited)
+					}),
+					// If slots are full AND can't be replaced destroy the item on the ground
+					builder.Sequence({
+						builder.Action(BT_Actions::DestroyItem),
+						builder.Action(BT_Actions::MarkItemAsVisited)
+					})
 				})
+			})
+		}),
+		// House behaviors
+		builder.MemorySelector({
+			// House In FOV and Move to Target
+			builder.Sequence({
+				builder.Conditional(BT_Conditions::HasNoItemTarget, { BB::TargetItem }),
+				builder.Conditional(BT_Conditions::HasNoHouseTarget, { BB::TargetHouse }),
+				builder.Conditional(BT_Conditions::IsHouseInFOV),
+				builder.Conditional(BT_Conditions::CanVisitHouseInFOV),
+				builder.Action(BT_Actions::TargetHouseInFOV),
+				builder.Action(BT_Actions::SeekTarget)
 			}),
-			// Item behaviors
-			new Elite::BehaviorSelector({
-				// Target Item in FOV and Move to Target
-				new Elite::BehaviorSequence({
-					new Elite::BehaviorConditional(BT_Conditions::HasNoItemTarget),
-					new Elite::BehaviorConditional(BT_Conditions::IsItemInFOV),
-					new Elite::BehaviorConditional(BT_Conditions::CanVisitItemInFOV),
-					new Elite::BehaviorAction(BT_Actions::TargetItemInFOV),
-					new Elite::BehaviorAction(BT_Actions::SeekTarget)
-				}),
-				// Target closest unvisited Item and Move to Target
-				new Elite::BehaviorSequence({
-					new Elite::BehaviorConditional(BT_Conditions::HasNoItemTarget),
-					new Elite::BehaviorConditional(BT_Conditions::CanVisitKnownItems),
-					new Elite::BehaviorAction(BT_Actions::SetClosestItemAsTarget),
-					new Elite::BehaviorAction(BT_Actions::SeekTarget)
+			// No house In FOV (Target known unvisited houses) and Move to Target
+			builder.Sequence({
+				builder.Conditional(BT_Conditions::HasNoItemTarget, { BB::TargetItem }),
+				builder.Conditional(BT_Conditions::HasNoHouseTarget, { BB::TargetHouse }),
+				builder.Conditional(BT_Conditions::CanVisitKnownHouse),
+				pHousePlanning,
+				builder.Action(BT_Actions::SeekTarget)
+			}),
+			// Visit House
+			builder.MemorySelector({
+				// Check if the agent is outside the target house
+				builder.Sequence({
+					builder.Conditional(BT_Conditions::IsAgentOutsideTargetHouse),
+					builder.Conditional(BT_Conditions::HasNoItemTarget, { BB::TargetItem }),
+					builder.Action(BT_Actions::SeekTarget)
 				}),
-				// Check if target item can be grabbed
-				new Elite::BehaviorSequence({
-					new Elite::BehaviorConditional(BT_Conditions::HasItemTarget),
-					new Elite::BehaviorAction(BT_Actions::SeekAndFaceTarget),
-					new Elite::BehaviorConditional(BT_Conditions::IsItemInGrabRange),
-					// Item handling
-					new Elite::BehaviorSelector({
-						// add item to inventory when there is an empty slot
-						new Elite::BehaviorSequence({
-							new Elite::BehaviorConditional(BT_Conditions::HasEmptySlot),
-							new Elite::BehaviorConditional(BT_Conditions::IsNotGarbage),
-							new Elite::BehaviorAction(BT_Actions::AddItemToInventory),
-							new Elite::BehaviorAction(BT_Actions::MarkItemAsVisited)
+				// Search the house
+				builder.MemorySequence({
+					builder.MemorySelector({
+						// If no checkpoint target, set closest checkpoint as target
+						builder.Sequence({
+							builder.Conditional(BT_Conditions::HasNoItemTarget, { BB::TargetItem }),
+							builder.Conditional(BT_Conditions::HasNoCheckpointTarget, { BB::TargetCheckpoint }),
+							builder.Conditional(BT_Conditions::CanSearchHouse),
+							builder.Action(BT_Actions::TargetClosestCheckpoint),
+							builder.Action(BT_Actions::SeekTarget)
 						}),
-						// if all slots are full check if can replace Item
-						new Elite::BehaviorSequence({
-							new Elite::BehaviorConditional(BT_Conditions::IsNotGarbage),
-							new Elite::BehaviorConditional(BT_Conditions::ShouldItemBeReplaced),
-							new Elite::BehaviorAction(BT_Actions::ReplaceItem),
-							new Elite::BehaviorAction(BT_Actions::MarkItemAsVisited)
+						// If checkpoint target exists, move towards it and mark it as visited once reached
+						builder.MemorySequence({
+							builder.Conditional(BT_Conditions::HasNoItemTarget, { BB::TargetItem }),
+							builder.Conditional(BT_Conditions::HasCheckpointTarget, { BB::TargetCheckpoint }),
+							builder.Action(BT_Actions::MoveToTarget),
+							builder.Action(BT_Actions::MarkCheckPointVisited)
 						}),
-						// If slots are full AND can't be replaced destroy the item on the ground
-						new Elite::BehaviorSequence({
-							new Elite::BehaviorAction(BT_Actions::DestroyItem),
-							new Elite::BehaviorAction(BT_Actions::MarkItemAsVisited)
+						// If checkpoint reached, mark it as visited
+						builder.Sequence({
+							builder.Conditional(BT_Conditions::HasCheckpointTarget, { BB::TargetCheckpoint }),
+							builder.Conditional(BT_Conditions::HasReachedTarget),
+							builder.Action(BT_Actions::MarkCheckPointVisited)
 						})
-					})
+					}),
+					// After all checkpoints visited, mark house as visited
+					builder.Conditional(BT_Conditions::AreAlLCheckpointsVisited),
+					builder.Action(BT_Actions::MarkHouseAsVisited)
 				})
+		}),
+			// Fallback Exploration
+			builder.Sequence({
+				builder.Conditional(BT_Conditions::HasNoHouseTarget, { BB::TargetHouse }),
+				builder.Conditional(BT_Conditions::HasNoItemTarget, { BB::TargetItem }),
+				pExploration,
+				builder.Action(BT_Actions::SeekTarget)
+			})
+		})
+
+		},
+		// Interrupt guards, one per branch with a higher priority than the house search
+		{
+			builder.Sequence({
+				builder.Conditional(BT_Conditions::IsMedkitNeeded),
+				builder.Conditional(BT_Conditions::HasMedkit)
 			}),
-			// House behaviors
-			new Elite::BehaviorSelector({
-				// House In FOV and Move to Target
-				new Elite::BehaviorSequence({
-					new Elite::BehaviorConditional(BT_Conditions::HasNoItemTarget),
-					new Elite::BehaviorConditional(BT_Conditions::HasNoHouseTarget),
-					new Elite::BehaviorConditional(BT_Conditions::IsHouseInFOV),
-					new Elite::BehaviorConditional(BT_Conditions::CanVisitHouseInFOV),
-					new Elite::BehaviorAction(BT_Actions::TargetHouseInFOV),
-					new Elite::BehaviorAction(BT_Actions::SeekTarget)
-				}),
-				// No house In FOV (Target known unvisited houses) and Move to Target
-				new Elite::BehaviorSequence({
-					new Elite::BehaviorConditional(BT_Conditions::HasNoItemTarget),
-					new Elite::BehaviorConditional(BT_Conditions::HasNoHouseTarget),
-					new Elite::BehaviorConditional(BT_Conditions::CanVisitKnownHouse),
-					new Elite::BehaviorAction(BT_Actions::TargetClosestUnvisitedHouse),
-					new Elite::BehaviorAction(BT_Actions::SeekTarget)
-				}),
-				// Visit House
-				new Elite::BehaviorSelector({
-					// Check if the agent is outside the target house
-					new Elite::BehaviorSequence({
-						new Elite::BehaviorConditional(BT_Conditions::IsAgentOutsideTargetHouse),
-						new Elite::BehaviorConditional(BT_Conditions::HasNoItemTarget),
-						new Elite::BehaviorAction(BT_Actions::SeekTarget)
-					}),
-					// Search the house
-					new Elite::BehaviorSequence({
-						new Elite::BehaviorSelector({
-							// If no checkpoint target, set closest checkpoint as target
-							new Elite::BehaviorSequence({
-								new Elite::BehaviorConditional(BT_Conditions::HasNoItemTarget),
-								new Elite::BehaviorConditional(BT_Conditions::HasNoCheckpointTarget),
-								new Elite::BehaviorConditional(BT_Conditions::CanSearchHouse),
-								new Elite::BehaviorAction(BT_Actions::TargetClosestCheckpoint),
-								new Elite::BehaviorAction(BT_Actions::SeekTarget)
-							}),
-							// If checkpoint target exists and not reached, continue to move towards it
-							new Elite::BehaviorSequence({
-								new Elite::BehaviorConditional(BT_Conditions::HasNoItemTarget),
-								new Elite::BehaviorConditional(BT_Conditions::HasCheckpointTarget),
-								new Elite::BehaviorConditional(BT_Conditions::HasNotReachedTarget),
-								new Elite::BehaviorAction(BT_Actions::SeekTarget)
-							}),
-							// If checkpoint reached, mark it as visited
-							new Elite::BehaviorSequence({
-								new Elite::BehaviorConditional(BT_Conditions::HasCheckpointTarget),
-								new Elite::BehaviorConditional(BT_Conditions::HasReachedTarget),
-								new Elite::BehaviorAction(BT_Actions::MarkCheckPointVisited)
-							})
-						}),
-						// After all checkpoints visited, mark house as visited
-						new Elite::BehaviorConditional(BT_Conditions::AreAlLCheckpointsVisited),
-						new Elite::BehaviorAction(BT_Actions::MarkHouseAsVisited)
-					})
+			builder.Sequence({
+				builder.Conditional(BT_Conditions::IsFoodNeeded),
+				builder.Conditional(BT_Conditions::HasFood)
 			}),
-				// Fallback Exploration
-				new Elite::BehaviorSequence({
-					new Elite::BehaviorConditional(BT_Conditions::HasNoHouseTarget),
-					new Elite::BehaviorConditional(BT_Conditions::HasNoItemTarget),
-					new Elite::BehaviorAction(BT_Actions::Explore),
-					new Elite::BehaviorAction(BT_Actions::SeekTarget)
-				})
+			builder.Conditional(BT_Conditions::IsInPurgeZone),
+			builder.Conditional(BT_Conditions::IsEnemyInFOV),
+			builder.Conditional(BT_Conditions::IsUnderAttack),
+			builder.Selector({
+				builder.Conditional(BT_Conditions::HasItemTarget, { BB::TargetItem }),
+				builder.Sequence({
+					builder.Conditional(BT_Conditions::IsItemInFOV),
+					builder.Conditional(BT_Conditions::CanVisitItemInFOV)
+				}),
+				builder.Conditional(BT_Conditions::CanVisitKnownItems)
 			})
+		});
+
+	// Removes the checks that are repeated without anything in between changing their outcome. With verification
+	// the original tree runs first and records what it does, see SelectVerifiedTree.
+	m_pTreeOptimizer = std::make_unique<Elite::BehaviorTreeOptimizer>();
+	DeclareBehaviorEffects(*m_pTreeOptimizer);
+	if (m_VerifyOptimizedTree)
+		m_pTreeOptimizer->EnableVerification();
+	Elite::IBehavior* pOptimizedRoot = m_pTreeOptimizer->Optimize(pRoot, builder);
+	if (m_VerifyOptimizedTree)
+	{
+		m_pOriginalRoot = pRoot;
+		m_pOptimizedRoot = pOptimizedRoot;
+		pRoot = m_pTreeOptimizer->GetRecordingRoot();
+	}
+	else
+	{
+		pRoot = pOptimizedRoot;
+	}
+
+	m_pBehaviourTree = builder.Build(m_pBlackboard.get(), pRoot);
 
-			}));
+	// Run the flattened version of the tree, the arena of the tree stays the owner of the nodes
+	m_pBehaviourTree->Compile();
+	// Conditions like HasNoItemTarget and IsItemInFOV show up in several branches, evaluate them once per tick
+	m_pBehaviourTree->EnableConditionMemo();
+
+	// The last ticks before the agent dies are written to BehaviorTreeRecording.bin on shutdown, see BehaviorTraceReplay
+	if (m_RecordBehaviorTrace)
+	{
+		m_pTraceRecorder = std::make_unique<Elite::BehaviorTraceRecorder>();
+		m_pTraceRecorder->WatchValue("Health", &m_AgentInfo.Health);
+		m_pTraceRecorder->WatchValue("Energy", &m_AgentInfo.Energy);
+		m_pTraceRecorder->WatchValue("Position.x", &m_AgentInfo.Position.x);
+		m_pTraceRecorder->WatchValue("Position.y", &m_AgentInfo.Position.y);
+		m_pTraceRecorder->WatchValue("Target.x", &m_Target.x);
+		m_pTraceRecorder->WatchValue("Target.y", &m_Target.y);
+		m_pTraceRecorder->WatchValue("AlertedTime", &m_AlertedTime);
+		m_pTraceRecorder->WatchValue("CanScan", &m_CanScan);
+		m_pTraceRecorder->WatchValue("ShouldRun", &m_ShouldRun);
+		// A recording can only hold one tree, so it starts once the tree is final
+		if (!m_pOptimizedRoot)
+			m_pBehaviourTree->SetTraceRecorder(m_pTraceRecorder.get());
+	}
+}
+
+void SurvivalAgentPlugin::SelectVerifiedTree()
+{
+	// The optimized tree only replaces the original when it runs the same actions on every recorded tick
+	if (m_pTreeOptimizer->VerifyEquivalence())
+	{
+		ELITE_LOG_INFO("The optimized behavior tree is equivalent on the recorded ticks, switching to it");
+		m_pBehaviourTree->SetRootBehavior(m_pOptimizedRoot);
+	}
+	else
+	{
+		ELITE_LOG_WARNING("The optimized behavior tree differs from the original, keeping the original");
+		m_pBehaviourTree->SetRootBehavior(m_pOriginalRoot);
+	}
+	m_pOriginalRoot = nullptr;
+	m_pOptimizedRoot = nullptr;
+
+	if (m_pTraceRecorder)
+		m_pBehaviourTree->SetTraceRecorder(m_pTraceRecorder.get());
+}
+
+void SurvivalAgentPlugin::CreateStaticBehaviorTree()
+{
+	m_pStaticBehaviourTree = std::make_unique<Elite::BehaviorTree>(m_pBlackboard.get(),
+		new Elite::StaticBT::StaticBehavior<StaticAgentTree>());
 }
 
 
@@ -3,6 +3,9 @@
 #include "Exam_HelperStructs.h"
 
 #include "EliteBehaviorTree/EDecisionMaking.h"
+#include "EliteBehaviorTree/EBehaviorTreeBenchmark.h"
+#include "EliteBehaviorTree/EBehaviorTreeOptimizer.h"
+#include "EliteBehaviorTree/EBehaviorTreeTrace.h"
 #include "Steeringbehaviors/SteeringBehaviors.h"
 #include "Steeringbehaviors/CombinedSteeringBehaviors.h"
 #include "EliteData/EBlackboard.h"
@@ -12,6 +15,8 @@
 #include "HouseManager.h"
 #include "InventoryManager.h"
 #include "EntityManager.h"
+#include "PerceptionFrame.h"
+#include "NavMeshQueryCache.h"
 
 #include <memory>
 
@@ -38,15 +43,24 @@ private:
 
 	// Main variables
 	IExamInterface* m_pInterface = nullptr;
+	const bool m_WriteLogFile{ false }; // The log also goes to AgentLog.txt
+	ZombieGame::PerceptionFrame m_Perception{};
+	std::unique_ptr<ZombieGame::NavMeshQueryCache> m_pNavMeshCache{};
 
 	// Managers
 	std::unique_ptr<ZombieGame::Grid> m_pGrid{};
+	const bool m_ExploreWithFlowField{ true }; // Otherwise the expanding square search
+	const bool m_BenchmarkInfluenceMap{ false }; // Times a 128x128 influence map on shutdown
+	const bool m_BenchmarkPathfinder{ false }; // Times grid paths on 64x64 and 256x256 on shutdown
 	std::unique_ptr<ZombieGame::HouseManager> m_pHouseManager{};
 	std::unique_ptr<ZombieGame::InventoryManager> m_pInventoryManager{};
 	std::unique_ptr<ZombieGame::EntityManager> m_pEntityManager{};
 
 	// Blackboard
 	std::unique_ptr<Elite::Blackboard> m_pBlackboard{};
+	std::unique_ptr<Elite::BlackboardProfiler> m_pBlackboardProfiler{};
+	const bool m_ProfileBlackboard{ false };
+	const bool m_PublishBlackboardSnapshots{ false }; // No off-thread reader yet, every publish copies the slab
 
 	// SteeringBehaviors
 
@@ -65,7 +79,18 @@ private:
 	std::unique_ptr<BlendedSteering> m_pFleeAndFaceBehaviour;
 	
 	// Behavior Tree
+	std::unique_ptr<Elite::BehaviorTreeOptimizer> m_pTreeOptimizer{}; // Outlives the tree, its probes record into it
+	std::unique_ptr<Elite::BehaviorTraceRecorder> m_pTraceRecorder{}; // Outlives the tree, which records into it
 	std::unique_ptr<Elite::BehaviorTree> m_pBehaviourTree{};
+	std::unique_ptr<Elite::BehaviorTree> m_pStaticBehaviourTree{};
+	std::vector<const Elite::BehaviorTickRate*> m_TickRateDecorators{}; // Owned by the tree
+	const Elite::BehaviorUtilitySelector* m_pConsumableSelector{ nullptr }; // Owned by the tree
+	Elite::IBehavior* m_pOriginalRoot{ nullptr }; // Owned by the tree, set while the optimized tree is not verified yet
+	Elite::IBehavior* m_pOptimizedRoot{ nullptr }; // Owned by the tree, set while the optimized tree is not verified yet
+	std::unique_ptr<Elite::BehaviorTreeBenchmark> m_pBehaviorTreeBenchmark{};
+	const bool m_BenchmarkBehaviorTrees{ false };
+	const bool m_VerifyOptimizedTree{ true }; // Otherwise the optimized tree runs without being checked against the original
+	const bool m_RecordBehaviorTrace{ false }; // Writes BehaviorTreeRecording.bin on shutdown
 
 	// Agent Data
 	AgentInfo m_AgentInfo{};
@@ -93,6 +118,9 @@ private:
 	void InitializeBlackboard();
 	// Behavior Tree
 	void CreateBehaviorTree();
+	void SelectVerifiedTree();
+	// Same tree composed at compile time, only used to benchmark against the runtime tree
+	void CreateStaticBehaviorTree();
 
 };
 
@@ -0,0 +1,217 @@
+#include "stdafx.h"
+#include "VisitedMap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+
+constexpr int ZombieGame::VisitedMap::NoCell;
+constexpr int ZombieGame::VisitedMap::Unreachable;
+
+void ZombieGame::VisitedMap::Initialize(int dimensions)
+{
+    m_Dimensions = dimensions;
+    const int cellCount = dimensions * dimensions;
+
+    m_Words.assign((cellCount + 63) / 64, 0);
+
+    // Every cell is its own closest unvisited cell
+    m_NearestUnvisited.resize(cellCount);
+    for (int cellIndex = 0; cellIndex < cellCount; ++cellIndex)
+    {
+        m_NearestUnvisited[cellIndex] = cellIndex;
+    }
+    m_SquaredDistances.assign(cellCount, 0);
+    m_ToRaise.assign(cellCount, 0);
+
+    m_Open.clear();
+    m_Open.reserve(cellCount);
+}
+
+bool ZombieGame::VisitedMap::SetVisited(int cellIndex)
+{
+    if (IsVisited(cellIndex))
+        return false;
+
+    m_Words[cellIndex >> 6] |= uint64_t{ 1 } << (cellIndex & 63);
+
+    // The cell stops being a source, everything that pointed at it looks for another one
+    m_NearestUnvisited[cellIndex] = NoCell;
+    m_SquaredDistances[cellIndex] = Unreachable;
+    m_ToRaise[cellIndex] = 1;
+    Push(0, cellIndex);
+    Propagate();
+    return true;
+}
+
+bool ZombieGame::VisitedMap::SetUnvisited(int cellIndex)
+{
+    if (!IsVisited(cellIndex))
+        return false;
+
+    m_Words[cellIndex >> 6] &= ~(uint64_t{ 1 } << (cellIndex & 63));
+
+    // The cell becomes a source again and takes over the cells that are closer to it
+    m_NearestUnvisited[cellIndex] = cellIndex;
+    m_SquaredDistances[cellIndex] = 0;
+    m_ToRaise[cellIndex] = 0;
+    Push(0, cellIndex);
+    Propagate();
+    return true;
+}
+
+int ZombieGame::VisitedMap::GetVisitedCount() const
+{
+    int count = 0;
+    for (const uint64_t word : m_Words)
+    {
+        count += CountBits(word);
+    }
+    return count;
+}
+
+float ZombieGame::VisitedMap::GetCoverage() const
+{
+    const int cellCount = m_Dimensions * m_Dimensions;
+    return cellCount > 0 ? static_cast<float>(GetVisitedCount()) / static_cast<float>(cellCount) : 0.f;
+}
+
+int ZombieGame::VisitedMap::CountUnvisited(int firstRow, int firstColumn, int lastRow, int lastColumn) const
+{
+    firstRow = std::max(firstRow, 0);
+    firstColumn = std::max(firstColumn, 0);
+    lastRow = std::min(lastRow, m_Dimensions - 1);
+    lastColumn = std::min(lastColumn, m_Dimensions - 1);
+    if (firstRow > lastRow || firstColumn > lastColumn)
+        return 0;
+
+    // Each row of the rectangle is one run of bits
+    int visitedCount = 0;
+    for (int row = firstRow; row <= lastRow; ++row)
+    {
+        visitedCount += CountVisitedInRange(row * m_Dimensions + firstColumn, row * m_Dimensions + lastColumn + 1);
+    }
+
+    const int cellCount = (lastRow - firstRow + 1) * (lastColumn - firstColumn + 1);
+    return cellCount - visitedCount;
+}
+
+float ZombieGame::VisitedMap::GetDistanceToUnvisited(int cellIndex) const
+{
+    const int squaredDistance = m_SquaredDistances[cellIndex];
+    if (squaredDistance == Unreachable)
+        return std::numeric_limits<float>::infinity();
+
+    return std::sqrt(static_cast<float>(squaredDistance));
+}
+
+int ZombieGame::VisitedMap::CountVisitedInRange(int beginIndex, int endIndex) const
+{
+    if (beginIndex >= endIndex)
+        return 0;
+
+    const int firstWord = beginIndex >> 6;
+    const int lastWord = (endIndex - 1) >> 6;
+    const uint64_t firstMask = ~uint64_t{ 0 } << (beginIndex & 63);
+    const uint64_t lastMask = ~uint64_t{ 0 } >> (63 - ((endIndex - 1) & 63));
+
+    if (firstWord == lastWord)
+        return CountBits(m_Words[firstWord] & firstMask & lastMask);
+
+    int count = CountBits(m_Words[firstWord] & firstMask);
+    for (int wordIndex = firstWord + 1; wordIndex < lastWord; ++wordIndex)
+    {
+        count += CountBits(m_Words[wordIndex]);
+    }
+    count += CountBits(m_Words[lastWord] & lastMask);
+    return count;
+}
+
+int ZombieGame::VisitedMap::GetSquaredDistance(int fromCell, int toCell) const
+{
+    const int rowDistance = fromCell / m_Dimensions - toCell / m_Dimensions;
+    const int columnDistance = fromCell % m_Dimensions - toCell % m_Dimensions;
+    return rowDistance * rowDistance + columnDistance * columnDistance;
+}
+
+void ZombieGame::VisitedMap::Push(int squaredDistance, int cellIndex)
+{
+    m_Open.emplace_back(squaredDistance, cellIndex);
+    std::push_heap(m_Open.begin(), m_Open.end(), std::greater<std::pair<int, int>>{});
+}
+
+void ZombieGame::VisitedMap::Propagate()
+{
+    while (!m_Open.empty())
+    {
+        std::pop_heap(m_Open.begin(), m_Open.end(), std::greater<std::pair<int, int>>{});
+        const std::pair<int, int> entry = m_Open.back();
+        m_Open.pop_back();
+
+        const int cellIndex = entry.second;
+        if (m_ToRaise[cellIndex])
+        {
+            Raise(cellIndex);
+            continue;
+        }
+
+        // A cell that got a closer source after it was queued was already lowered with it
+        const int nearest = m_NearestUnvisited[cellIndex];
+        if (nearest != NoCell && !IsVisited(nearest) && entry.first <= m_SquaredDistances[cellIndex])
+            Lower(cellIndex);
+    }
+}
+
+void ZombieGame::VisitedMap::Raise(int cellIndex)
+{
+    const int row = cellIndex / m_Dimensions;
+    const int column = cellIndex % m_Dimensions;
+
+    for (int neighborRow = std::max(row - 1, 0); neighborRow <= std::min(row + 1, m_Dimensions - 1); ++neighborRow)
+    {
+        for (int neighborColumn = std::max(column - 1, 0); neighborColumn <= std::min(column + 1, m_Dimensions - 1); ++neighborColumn)
+        {
+            const int neighbor = neighborRow * m_Dimensions + neighborColumn;
+            if (neighbor == cellIndex || m_ToRaise[neighbor] || m_NearestUnvisited[neighbor] == NoCell)
+                continue;
+
+            // Neighbors with a source that is still unvisited lower the cleared cells again,
+            // neighbors that lost their source are cleared as well
+            Push(m_SquaredDistances[neighbor], neighbor);
+            if (IsVisited(m_NearestUnvisited[neighbor]))
+            {
+                m_NearestUnvisited[neighbor] = NoCell;
+                m_SquaredDistances[neighbor] = Unreachable;
+                m_ToRaise[neighbor] = 1;
+            }
+        }
+    }
+
+    m_ToRaise[cellIndex] = 0;
+}
+
+void ZombieGame::VisitedMap::Lower(int cellIndex)
+{
+    const int row = cellIndex / m_Dimensions;
+    const int column = cellIndex % m_Dimensions;
+    const int source = m_NearestUnvisited[cellIndex];
+
+    for (int neighborRow = std::max(row - 1, 0); neighborRow <= std::min(row + 1, m_Dimensions - 1); ++neighborRow)
+    {
+        for (int neighborColumn = std::max(column - 1, 0); neighborColumn <= std::min(column + 1, m_Dimensions - 1); ++neighborColumn)
+        {
+            const int neighbor = neighborRow * m_Dimensions + neighborColumn;
+            if (neighbor == cellIndex || m_ToRaise[neighbor])
+                continue;
+
+            const int squaredDistance = GetSquaredDistance(source, neighbor);
+            if (squaredDistance < m_SquaredDistances[neighbor])
+            {
+                m_SquaredDistances[neighbor] = squaredDistance;
+                m_NearestUnvisited[neighbor] = source;
+                Push(squaredDistance, neighbor);
+            }
+        }
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace ZombieGame
+{
+	// Which cells of a square grid the agent visited, one bit per cell in row-major order.
+	// Counting works on whole 64-bit words. Next to the bits it keeps, for every cell, the closest cell that is not
+	// visited yet: a distance transform with the unvisited cells as sources. Visiting a cell only repairs the part of
+	// the transform that pointed at it (the dynamic brushfire of Lau et al.), so lookups are O(1) at any grid size.
+	class VisitedMap final
+	{
+	public:
+		static constexpr int NoCell{ -1 };
+
+		VisitedMap() = default;
+		~VisitedMap() = default;
+
+		VisitedMap(const VisitedMap& other) = delete;
+		VisitedMap& operator=(const VisitedMap& other) = delete;
+		VisitedMap(VisitedMap&& other) = delete;
+		VisitedMap& operator=(VisitedMap&& other) = delete;
+
+		// Every cell starts unvisited
+		void Initialize(int dimensions);
+
+		bool IsVisited(int cellIndex) const { return (m_Words[cellIndex >> 6] >> (cellIndex & 63)) & 1; }
+		// Both return false when the cell already had that state
+		bool SetVisited(int cellIndex);
+		bool SetUnvisited(int cellIndex);
+
+		int GetVisitedCount() const;
+		float GetCoverage() const;
+		// Unvisited cells in the rectangle, the rows and columns are inclusive and clamped to the grid
+		int CountUnvisited(int firstRow, int firstColumn, int lastRow, int lastColumn) const;
+
+		// NoCell when every cell is visited
+		int GetNearestUnvisited(int cellIndex) const { return m_NearestUnvisited[cellIndex]; }
+		// In cells, 0 for an unvisited cell
+		float GetDistanceToUnvisited(int cellIndex) const;
+
+		// Calls function(cellIndex) for every visited cell, only walks the set bits
+		template<typename Function>
+		void ForEachVisited(Function function) const;
+
+		static int CountBits(uint64_t word)
+		{
+			word = word - ((word >> 1) & 0x5555555555555555ull);
+			word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+			word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+			return static_cast<int>((word * 0x0101010101010101ull) >> 56);
+		}
+
+	private:
+		static constexpr int Unreachable{ INT32_MAX };
+
+		int m_Dimensions{ 0 };
+		std::vector<uint64_t> m_Words{};
+
+		// Distance transform, distances are squared and in cells
+		std::vector<int> m_NearestUnvisited{};
+		std::vector<int> m_SquaredDistances{};
+		std::vector<uint8_t> m_ToRaise{};
+		std::vector<std::pair<int, int>> m_Open{}; // Min-heap of (squared distance, cell)
+
+		int CountVisitedInRange(int beginIndex, int endIndex) const;
+		int GetSquaredDistance(int fromCell, int toCell) const;
+		void Push(int squaredDistance, int cellIndex);
+		void Propagate();
+		void Raise(int cellIndex);
+		void Lower(int cellIndex);
+	};
+
+	template<typename Function>
+	void VisitedMap::ForEachVisited(Function function) const
+	{
+		for (size_t wordIndex = 0; wordIndex < m_Words.size(); ++wordIndex)
+		{
+			uint64_t word = m_Words[wordIndex];
+			while (word != 0)
+			{
+				const int bit = CountBits((word & (~word + 1)) - 1); // Index of the lowest set bit
+				word &= word - 1;
+				function(static_cast<int>(wordIndex * 64) + bit);
+			}
+		}
+	}
+}